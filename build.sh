@@ -94,8 +94,6 @@ get_required_kitsune_lib_repo "libKitsunemimiCommon" "develop" 8
 
 get_required_kitsune_lib_repo "libKitsunemimiJson" "develop" 1
 
-get_required_kitsune_lib_repo "libKitsunemimiSqlite" "develop" 8 
-
 #-----------------------------------------------------------------------------------------------------------------
 
 if [ $1 = "test" ]; then
@@ -0,0 +1,91 @@
+/**
+ * @file       change_feed.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_CHANGE_FEED_H
+#define KITSUNEMIMI_SAKURA_DATABASE_CHANGE_FEED_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+struct ChangeEvent
+{
+    enum ChangeType
+    {
+        INSERT_CHANGE = 0,
+        UPDATE_CHANGE = 1,
+        DELETE_CHANGE = 2
+    };
+
+    ChangeType type = INSERT_CHANGE;
+    std::string primaryKey = "";
+};
+
+/**
+ * Collects change-events of a table and delivers them in batches with an own thread to all
+ * subscribers, so the thread, which has written into the table, is not blocked by the
+ * subscribers.
+ */
+class ChangeFeed
+{
+public:
+    typedef std::function<void(const std::vector<ChangeEvent> &events)> ChangeCallback;
+
+    ChangeFeed(const uint64_t maxBatchSize = 1000);
+    ~ChangeFeed();
+
+    uint64_t addSubscriber(ChangeCallback callback);
+    bool removeSubscriber(const uint64_t subscriberId);
+    bool hasSubscriber();
+
+    void addEvents(const ChangeEvent::ChangeType type,
+                   const std::vector<std::string> &primaryKeys);
+    void flush();
+
+private:
+    uint64_t m_maxBatchSize = 1000;
+    std::mutex m_lock;
+    std::condition_variable m_newEvents;
+    std::condition_variable m_delivered;
+    std::vector<ChangeEvent> m_queue;
+    std::map<uint64_t, ChangeCallback> m_subscribers;
+    uint64_t m_nextSubscriberId = 1;
+    bool m_isDelivering = false;
+    bool m_abort = false;
+    std::thread m_thread;
+
+    void run();
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_CHANGE_FEED_H
@@ -0,0 +1,84 @@
+/**
+ * @file       database_executor.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_DATABASE_EXECUTOR_H
+#define KITSUNEMIMI_SAKURA_DATABASE_DATABASE_EXECUTOR_H
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <condition_variable>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * Executor for asynchronous database-requests with a fixed number of threads. Reading tasks are
+ * processed by multiple reader-threads and writing tasks by a single writer-thread in the order
+ * of their submission, because sqlite allows only one writer at the same time. So the number of
+ * requests in flight is not limited by the number of threads of the caller.
+ */
+class DatabaseExecutor
+{
+public:
+    typedef std::function<void()> Task;
+
+    enum TaskType
+    {
+        READ_TASK = 0,
+        WRITE_TASK = 1
+    };
+
+    DatabaseExecutor(const uint32_t numberOfReaders = 2);
+    ~DatabaseExecutor();
+
+    bool post(const TaskType type,
+              Task task);
+    uint64_t getNumberOfPendingTasks();
+    void waitUntilIdle();
+
+private:
+    struct TaskQueue
+    {
+        std::deque<Task> tasks;
+        std::condition_variable newTask;
+    };
+
+    std::mutex m_lock;
+    std::condition_variable m_idle;
+    TaskQueue m_readQueue;
+    TaskQueue m_writeQueue;
+    uint64_t m_numberOfActiveTasks = 0;
+    bool m_abort = false;
+    std::vector<std::thread> m_threads;
+
+    void run(TaskQueue* queue);
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_DATABASE_EXECUTOR_H
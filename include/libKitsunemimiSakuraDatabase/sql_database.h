@@ -24,35 +24,361 @@
 #define KITSUNEMIMI_SAKURA_DATABASE_SQL_DATABASE_H
 
 #include <mutex>
-#include <libKitsunemimiSqlite/sqlite.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+
+#include <libKitsunemimiCommon/items/table_item.h>
+#include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiSakuraDatabase/database_executor.h>
+
+struct sqlite3;
+struct sqlite3_stmt;
+struct sqlite3_backup;
+struct sqlite3_blob;
 
 namespace Kitsunemimi
 {
-class Sqlite;
 namespace Sakura
 {
+class SqlResult;
+class TraceHook;
+class TraceScope;
 
 class SqlDatabase
 {
 public:
+    typedef std::function<void(const int remainingPages, const int totalPages)> BackupCallback;
+    typedef std::function<bool(const uint8_t* data, const uint64_t size)> BlobReadCallback;
+    typedef std::function<long(uint8_t* buffer, const uint64_t size)> BlobWriteCallback;
+
+    enum PlanCheckMode
+    {
+        NO_PLAN_CHECK = 0,
+        RECORD_PLANS = 1,
+        WARN_ON_SCAN = 2,
+        FAIL_ON_SCAN = 3
+    };
+
+    struct QueryPlan
+    {
+        std::string statement = "";
+        std::vector<std::string> details;
+        bool hasFullScan = false;
+        bool hasTempBTree = false;
+        bool isFiltered = false;
+        bool scanReported = false;
+        uint64_t numberOfCalls = 0;
+    };
+
+    struct MaintenanceStats
+    {
+        uint64_t pageSize = 0;
+        uint64_t pageCount = 0;
+        uint64_t freelistCount = 0;
+        // share of unused pages within the database-file between 0.0 and 1.0
+        double fragmentation = 0.0;
+        // false, if the database was created without incremental auto-vacuum
+        bool incrementalVacuum = false;
+        // pages within the write-ahead-log after the last checkpoint, -1 if not in wal-mode
+        long walPages = -1;
+        uint64_t numberOfRuns = 0;
+        uint64_t vacuumedPages = 0;
+    };
+
+    struct ResultLimit
+    {
+        // maximum number of rows of one result, 0 for no limit
+        uint64_t maxRows = 0;
+        // maximum size of the values of one result in bytes, 0 for no limit
+        uint64_t maxBytes = 0;
+    };
+
+    struct ResultBudget
+    {
+        ResultLimit limit;
+        // true to stop reading and keep the rows read so far, false to let the request fail
+        bool truncate = false;
+        uint64_t numberOfRows = 0;
+        uint64_t numberOfBytes = 0;
+        bool isTruncated = false;
+        // number of columns at the end of the statement, which are not added to the result, but
+        // only kept for the last added row, so the result can be continued after this row
+        uint32_t numberOfKeyColumns = 0;
+        std::vector<std::string> lastKey;
+    };
+
     SqlDatabase();
     ~SqlDatabase();
 
     bool initDatabase(const std::string &path,
-                      Kitsunemimi::ErrorContainer &error);
+                      Kitsunemimi::ErrorContainer &error,
+                      const uint32_t numberOfReaders = 0,
+                      const bool incrementalVacuum = false);
+    bool initMemoryDatabase(Kitsunemimi::ErrorContainer &error,
+                            const std::string &sharedName = "");
+    bool initTemporaryDatabase(Kitsunemimi::ErrorContainer &error);
+    bool loadDatabaseIntoMemory(const std::string &path,
+                                Kitsunemimi::ErrorContainer &error,
+                                const bool checkpointOnClose = true);
+    bool checkpointToFile(Kitsunemimi::ErrorContainer &error);
     bool closeDatabase();
 
 
     bool execSqlCommand(TableItem* resultTable,
                         const std::string &command,
-                        ErrorContainer &error);
+                        ErrorContainer &error,
+                        ResultBudget* budget = nullptr);
+    bool execSqlCommand(SqlResult &resultTable,
+                        const std::string &command,
+                        ErrorContainer &error,
+                        ResultBudget* budget = nullptr);
+    bool execPreparedCommand(SqlResult* resultTable,
+                             const std::string &statement,
+                             const SqlResult &parameters,
+                             ErrorContainer &error);
+    bool insertRows(const std::string &statement,
+                    const SqlResult &rows,
+                    ErrorContainer &error,
+                    std::vector<int64_t>* rowIds = nullptr);
+    bool writeRows(const std::vector<std::string> &statements,
+                   const std::vector<const SqlResult*> &rows,
+                   ErrorContainer &error);
+    uint32_t getMaxNumberOfParameters();
+
+    bool backupDatabase(const std::string &targetPath,
+                        ErrorContainer &error,
+                        const int pagesPerStep = 100,
+                        const uint32_t pauseBetweenSteps = 0,
+                        BackupCallback progressCallback = nullptr);
+    bool backupDatabase(SqlDatabase &target,
+                        ErrorContainer &error,
+                        const int pagesPerStep = 100,
+                        const uint32_t pauseBetweenSteps = 0,
+                        BackupCallback progressCallback = nullptr);
+
+    long getBlobSize(const std::string &tableName,
+                     const std::string &columnName,
+                     const int64_t rowId,
+                     ErrorContainer &error);
+    bool readBlob(const std::string &tableName,
+                  const std::string &columnName,
+                  const int64_t rowId,
+                  BlobReadCallback readCallback,
+                  ErrorContainer &error,
+                  const uint64_t chunkSize = 65536);
+    bool writeBlob(const std::string &tableName,
+                   const std::string &columnName,
+                   const int64_t rowId,
+                   const uint64_t blobSize,
+                   BlobWriteCallback writeCallback,
+                   ErrorContainer &error,
+                   const uint64_t chunkSize = 65536);
+
+    bool startExecutor(const uint32_t numberOfReaders = 2);
+    void stopExecutor();
+    bool postTask(const DatabaseExecutor::TaskType type,
+                  DatabaseExecutor::Task task);
+
+    bool publishSnapshot(const std::string &directory,
+                         ErrorContainer &error);
+    bool startPublishing(const std::string &directory,
+                         const uint32_t interval = 1000);
+    bool initReplica(const std::string &directory,
+                     const std::string &path,
+                     ErrorContainer &error,
+                     const uint32_t refreshInterval = 1000,
+                     const uint32_t numberOfReaders = 0);
+    bool refreshReplica(ErrorContainer &error);
+    long getReplicaStaleness();
+    void stopReplication();
+
+    bool startMaintenance(const uint32_t interval = 60000,
+                          const uint32_t idleTime = 1000,
+                          const uint32_t maxDuration = 100,
+                          const uint32_t pagesPerStep = 100);
+    void stopMaintenance();
+    bool runMaintenance(ErrorContainer &error,
+                        const uint32_t maxDuration = 100,
+                        const uint32_t pagesPerStep = 100);
+    bool getMaintenanceStats(MaintenanceStats &stats,
+                             ErrorContainer &error);
+
+    void setResultLimit(const ResultLimit &limit);
+    const ResultLimit getResultLimit();
+
+    void setTraceHook(TraceHook* hook);
+    TraceHook* getTraceHook();
+
+    void setPlanCheck(const PlanCheckMode mode,
+                      const uint64_t hotQueryThreshold = 100);
+    const std::vector<QueryPlan> getQueryPlans();
+    void clearQueryPlans();
+    bool explainQuery(const std::string &statement,
+                      QueryPlan &plan,
+                      ErrorContainer &error);
 
 private:
     std::mutex m_lock;
     bool m_isOpen = false;
     std::string m_path = "";
+    std::string m_checkpointPath = "";
+    bool m_checkpointOnClose = false;
+
+    sqlite3* m_db = nullptr;
+
+    // read-only connections, which allow reads in parallel to each other and to the writer
+    std::mutex m_readerLock;
+    std::condition_variable m_readerReleased;
+    std::vector<sqlite3*> m_readers;
+    std::vector<sqlite3*> m_freeReaders;
+    // true while a transaction of a caller is open on the writer, so reads have to see its rows.
+    // Only written while m_lock is held.
+    std::atomic<bool> m_writerInTransaction;
+    // limit of sqlite for the number of parameters of one statement
+    std::atomic<uint32_t> m_maxNumberOfParameters;
+
+    std::mutex m_executorLock;
+    DatabaseExecutor* m_executor = nullptr;
 
-    Kitsunemimi::Sqlite m_db;
+    std::mutex m_planLock;
+    // checked without the lock, so statements don't wait for the lock, if the check is disabled
+    std::atomic<PlanCheckMode> m_planCheckMode;
+    uint64_t m_hotQueryThreshold = 100;
+    std::map<std::string, QueryPlan> m_queryPlans;
+
+    std::mutex m_resultLimitLock;
+    ResultLimit m_resultLimit;
+
+    // hook for tracing of requests, which is only read with one atomic load per request
+    std::atomic<TraceHook*> m_traceHook;
+
+    // background-thread for optimize, incremental vacuum and checkpoints
+    std::thread m_maintenance;
+    std::mutex m_maintenanceLock;
+    std::condition_variable m_maintenanceWakeup;
+    bool m_maintenanceAbort = false;
+    uint64_t m_numberOfMaintenanceRuns = 0;
+    uint64_t m_vacuumedPages = 0;
+    long m_walPages = -1;
+    std::atomic<int64_t> m_lastRequest;
+
+    // publishing of snapshots for replicas, or refreshing of this database as replica
+    std::thread m_replication;
+    std::mutex m_replicationLock;
+    std::condition_variable m_replicationWakeup;
+    bool m_replicationAbort = false;
+    std::mutex m_publishLock;
+    // lock-file, which ensures, that only one database publishes into the directory
+    std::string m_publishDirectory = "";
+    int m_publishLockFd = -1;
+    std::string m_publishedSnapshot = "";
+    // state of the database at the last snapshot to detect changes of own rows, changes of
+    // other connections and changes of the schema
+    int64_t m_publishedChanges = 0;
+    int64_t m_publishedDataVersion = 0;
+    int64_t m_publishedSchemaVersion = 0;
+    std::string m_replicaDirectory = "";
+    std::string m_replicaSnapshot = "";
+    std::atomic<int64_t> m_replicaPublishTime;
+
+    bool openDatabase(const std::string &path,
+                      const int flags,
+                      ErrorContainer &error);
+    bool openReaders(const uint32_t numberOfReaders,
+                     ErrorContainer &error);
+    void closeReaders();
+    sqlite3* acquireReader();
+    void releaseReader(sqlite3* reader);
+    bool isReadCommand(const std::string &command);
+    bool execCommand(const std::string &command,
+                     TableItem* tableResult,
+                     SqlResult* arenaResult,
+                     ErrorContainer &error,
+                     ResultBudget* budget);
+    uint64_t getNumberOfResultRows(TableItem* tableResult,
+                                   SqlResult* arenaResult);
+    bool prepareReadCommand(sqlite3* reader,
+                            const std::string &command,
+                            std::vector<sqlite3_stmt*> &statements);
+    bool runReadCommand(const std::string &command,
+                        TableItem* tableResult,
+                        SqlResult* arenaResult,
+                        ErrorContainer &error,
+                        bool &isDone,
+                        TraceScope* trace = nullptr,
+                        ResultBudget* budget = nullptr);
+    bool runCommand(const std::string &command,
+                    TableItem* tableResult,
+                    SqlResult* arenaResult,
+                    ErrorContainer &error,
+                    TraceScope* trace = nullptr,
+                    ResultBudget* budget = nullptr);
+    bool runStatement(sqlite3_stmt* stmt,
+                      TableItem* tableResult,
+                      SqlResult* arenaResult,
+                      ErrorContainer &error,
+                      TraceScope* trace = nullptr,
+                      ResultBudget* budget = nullptr);
+    bool consumeBudget(ResultBudget &budget,
+                       sqlite3_stmt* stmt);
+    void appendToTable(TableItem &resultTable,
+                       sqlite3_stmt* stmt,
+                       const int numberOfColumns);
+    bool appendToResult(SqlResult &resultTable,
+                        sqlite3_stmt* stmt,
+                        const int numberOfColumns,
+                        ErrorContainer &error);
+    bool runBackup(sqlite3* targetDb,
+                   std::mutex* targetLock,
+                   ErrorContainer &error,
+                   const int pagesPerStep,
+                   const uint32_t pauseBetweenSteps,
+                   BackupCallback progressCallback);
+    bool beginSavepoint(ErrorContainer &error);
+    bool releaseSavepoint(ErrorContainer &error);
+    void rollbackSavepoint();
+    bool runRows(const std::string &statement,
+                 const SqlResult &rows,
+                 ErrorContainer &error,
+                 std::vector<int64_t>* rowIds,
+                 TraceScope &trace);
+    bool bindRow(sqlite3_stmt* stmt,
+                 const SqlResult &rows,
+                 const uint64_t row);
+    bool checkQueryPlan(sqlite3_stmt* stmt,
+                        ErrorContainer &error);
+    void runMaintenanceLoop(const uint32_t interval,
+                            const uint32_t idleTime,
+                            const uint32_t maxDuration,
+                            const uint32_t pagesPerStep);
+    void runReplicationLoop(const std::string directory,
+                            const uint32_t interval,
+                            const bool isReplica);
+    bool startReplication(const std::string &directory,
+                          const uint32_t interval,
+                          const bool isReplica);
+    bool lockPublishDirectory(const std::string &directory,
+                              ErrorContainer &error);
+    void unlockPublishDirectory();
+    bool readPragma(const std::string &name,
+                    int64_t &value,
+                    ErrorContainer &error);
+    void updateLastRequest();
+    bool runExplain(sqlite3* connection,
+                    const std::string &statement,
+                    QueryPlan &plan,
+                    ErrorContainer &error);
+    const std::string createStatementShape(const std::string &statement);
+    sqlite3_blob* openBlob(const std::string &tableName,
+                           const std::string &columnName,
+                           const int64_t rowId,
+                           const bool writable,
+                           ErrorContainer &error);
 };
 
 } // namespace Sakura
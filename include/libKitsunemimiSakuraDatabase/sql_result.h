@@ -0,0 +1,131 @@
+/**
+ * @file       sql_result.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_SQL_RESULT_H
+#define KITSUNEMIMI_SAKURA_DATABASE_SQL_RESULT_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/items/data_items.h>
+#include <libKitsunemimiCommon/items/table_item.h>
+
+namespace Kitsunemimi
+{
+class JsonItem;
+
+namespace Sakura
+{
+
+/**
+ * Result-container for sql-requests, which stores all cells of a result within one arena instead
+ * of a tree of single allocated data-items. Cells have a fixed size and strings are stored within
+ * one contiguous buffer, so the whole result can be freed at once. Conversion into table- or
+ * json-items is only done, when explicitly requested.
+ */
+class SqlResult
+{
+public:
+    enum ValueType
+    {
+        NULL_VALUE = 0,
+        STRING_VALUE = 1,
+        INT_VALUE = 2,
+        BOOL_VALUE = 3,
+        FLOAT_VALUE = 4
+    };
+
+    SqlResult();
+    ~SqlResult();
+
+    void clear();
+    void clearRows();
+
+    // columns
+    bool addColumn(const std::string &name,
+                   const ValueType type = NULL_VALUE,
+                   const bool hide = false);
+    uint64_t getNumberOfColumns() const;
+    const std::string getColumnName(const uint64_t column) const;
+    ValueType getColumnType(const uint64_t column) const;
+    long getColumnId(const std::string &name) const;
+    bool isHidden(const uint64_t column) const;
+
+    // rows
+    uint64_t getNumberOfRows() const;
+    void reserve(const uint64_t numberOfRows,
+                 const uint64_t numberOfStringBytes = 0);
+
+    // append values to the current row
+    void appendNull();
+    void appendString(const char* value, const uint64_t size);
+    void appendInt(const int64_t value);
+    void appendBool(const bool value);
+    void appendFloat(const double value);
+    bool appendRow(const SqlResult &source, const uint64_t row);
+
+    // cell-access
+    ValueType getType(const uint64_t row, const uint64_t column) const;
+    bool isNull(const uint64_t row, const uint64_t column) const;
+    std::string_view getString(const uint64_t row, const uint64_t column) const;
+    int64_t getInt(const uint64_t row, const uint64_t column) const;
+    bool getBool(const uint64_t row, const uint64_t column) const;
+    double getFloat(const uint64_t row, const uint64_t column) const;
+
+    // conversion
+    DataItem* toDataItem(const uint64_t row, const uint64_t column) const;
+    bool toTableItem(TableItem &result) const;
+    bool toJsonItem(JsonItem &result, const uint64_t row) const;
+
+private:
+    struct ColumnInfo
+    {
+        std::string name = "";
+        ValueType type = NULL_VALUE;
+        bool hide = false;
+    };
+
+    struct Cell
+    {
+        union
+        {
+            int64_t intValue;
+            double floatValue;
+            uint64_t stringPos;
+        };
+        uint32_t stringSize;
+        uint8_t type;
+    };
+
+    std::vector<ColumnInfo> m_columns;
+    std::vector<Cell> m_cells;
+    std::string m_stringBuffer;
+
+    const Cell* getCell(const uint64_t row, const uint64_t column) const;
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_SQL_RESULT_H
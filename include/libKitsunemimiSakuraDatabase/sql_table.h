@@ -25,10 +25,17 @@
 
 #include <vector>
 #include <string>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <thread>
 #include <uuid/uuid.h>
 
 #include <libKitsunemimiCommon/items/data_items.h>
 #include <libKitsunemimiCommon/logger.h>
+#include <libKitsunemimiSakuraDatabase/change_feed.h>
+#include <libKitsunemimiSakuraDatabase/sql_database.h>
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
 
 namespace Kitsunemimi
 {
@@ -36,23 +43,61 @@ class JsonItem;
 
 namespace Sakura
 {
-class SqlDatabase;
+class WriteBackCache;
+struct RowField;
 
 class SqlTable
 {
 public:
+    typedef std::function<void(const bool success,
+                               ErrorContainer &error)> AsyncCallback;
+    typedef std::function<void(const bool success,
+                               JsonItem &result,
+                               ErrorContainer &error)> AsyncJsonCallback;
+    typedef std::function<void(const bool success,
+                               SqlResult &result,
+                               ErrorContainer &error)> AsyncResultCallback;
+
     SqlTable(SqlDatabase* db);
     virtual ~SqlTable();
 
     bool initTable(ErrorContainer &error);
 
+    uint64_t subscribeChanges(ChangeFeed::ChangeCallback callback);
+    bool unsubscribeChanges(const uint64_t subscriberId);
+    void flushChanges();
+
+    bool startExpirySweeper(const uint32_t sweepInterval = 1000,
+                            const uint64_t batchSize = 100,
+                            const uint32_t pauseBetweenBatches = 10);
+    void stopExpirySweeper();
+    long deleteExpiredRows(ErrorContainer &error,
+                           const uint64_t batchSize = 100);
+
+    bool enableWriteBack(ErrorContainer &error,
+                         const uint32_t flushInterval = 1000,
+                         const uint64_t maxDirtyRows = 1000);
+    bool disableWriteBack(ErrorContainer &error);
+    bool flushWriteBack(ErrorContainer &error);
+
+    void setReadReplica(SqlDatabase* replica,
+                        const uint32_t maxStaleness = 1000);
+    void setResultLimit(const SqlDatabase::ResultLimit &limit);
+
 protected:
     enum DbVataValueTypes
     {
         STRING_TYPE = 0,
         INT_TYPE = 1,
         BOOL_TYPE = 2,
-        FLOAT_TYPE = 3
+        FLOAT_TYPE = 3,
+        BLOB_TYPE = 4
+    };
+
+    enum ImportFormat
+    {
+        CSV_IMPORT = 0,
+        JSON_LINES_IMPORT = 1
     };
 
     struct DbHeaderEntry
@@ -63,6 +108,20 @@ protected:
         bool isPrimary = false;
         bool allowNull = false;
         bool hide = false;
+        // time in seconds until a new row expires. If greater than 0, the column has to be an
+        // int-column and contains the unix-time in seconds, when the row expires.
+        uint64_t timeToLive = 0;
+        // string-column, which is added to the full-text search-index of the table
+        bool isSearchable = false;
+        // create an index for the column, so filtering and ordering by the column can use it
+        bool isIndexed = false;
+        // store long values of a string-column compressed. Compressed columns can not be primary
+        // key or searchable and can not be used within conditions, to sort or group rows, for
+        // min and max or as key of a join.
+        bool isCompressed = false;
+        // version of the row, which is set to 1 for new rows and incremented by each update.
+        // Only one int-column, which is not the primary key, can be the version-column.
+        bool isVersion = false;
     };
 
     struct RequestCondition
@@ -78,6 +137,72 @@ protected:
         }
     };
 
+    struct OrderBy
+    {
+        std::string colName = "";
+        bool descending = false;
+
+        OrderBy(const std::string &colName,
+                const bool descending = false)
+        {
+            this->colName = colName;
+            this->descending = descending;
+        }
+    };
+
+    enum AggregateFunction
+    {
+        COUNT_AGGREGATE = 0,
+        SUM_AGGREGATE = 1,
+        AVG_AGGREGATE = 2,
+        MIN_AGGREGATE = 3,
+        MAX_AGGREGATE = 4
+    };
+
+    struct Aggregate
+    {
+        AggregateFunction function = COUNT_AGGREGATE;
+        // empty to count all rows, only allowed for COUNT_AGGREGATE
+        std::string colName = "";
+        // name of the column in the result. If empty, a name is created out of function and column
+        std::string resultName = "";
+
+        Aggregate(const AggregateFunction function,
+                  const std::string &colName = "",
+                  const std::string &resultName = "")
+        {
+            this->function = function;
+            this->colName = colName;
+            this->resultName = resultName;
+        }
+    };
+
+    struct Join
+    {
+        // table to join, which has to be within the same database
+        SqlTable* otherTable = nullptr;
+        // columns of both tables, which have to be equal for joined rows
+        std::string colName = "";
+        std::string otherColName = "";
+        // conditions to filter the rows of the other table
+        std::vector<RequestCondition> otherConditions;
+        // columns of the result. If empty, all not hidden columns of the table are used.
+        // Columns of the other table are named '<other table>_<column>' in the result.
+        std::vector<std::string> columns;
+        std::vector<std::string> otherColumns;
+        // keep rows without matching row in the other table and set its columns to null
+        bool keepUnmatched = false;
+
+        Join(SqlTable* otherTable,
+             const std::string &colName,
+             const std::string &otherColName)
+        {
+            this->otherTable = otherTable;
+            this->colName = colName;
+            this->otherColName = otherColName;
+        }
+    };
+
     std::vector<DbHeaderEntry> m_tableHeader;
     std::string m_tableName = "";
 
@@ -86,42 +211,307 @@ protected:
     bool updateInDb(const std::vector<RequestCondition> &conditions,
                     const JsonItem &updates,
                     ErrorContainer &error);
+    long updateInDbIfVersion(const std::vector<RequestCondition> &conditions,
+                             const JsonItem &updates,
+                             const int64_t expectedVersion,
+                             ErrorContainer &error);
     bool getAllFromDb(TableItem &resultTable,
                       ErrorContainer &error,
                       const bool showHiddenValues = false,
                       const uint64_t positionOffset = 0,
-                      const uint64_t numberOfRows = 0);
+                      const uint64_t numberOfRows = 0,
+                      const std::vector<OrderBy> &orderBy = {});
+    bool getAllFromDb(SqlResult &resultTable,
+                      ErrorContainer &error,
+                      const bool showHiddenValues = false,
+                      const uint64_t positionOffset = 0,
+                      const uint64_t numberOfRows = 0,
+                      const std::vector<OrderBy> &orderBy = {});
+    bool getAllFromDb(TableItem &resultTable,
+                      std::string &continuationToken,
+                      ErrorContainer &error,
+                      const bool showHiddenValues = false,
+                      const std::vector<OrderBy> &orderBy = {});
+    bool getAllFromDb(SqlResult &resultTable,
+                      std::string &continuationToken,
+                      ErrorContainer &error,
+                      const bool showHiddenValues = false,
+                      const std::vector<OrderBy> &orderBy = {});
     bool getFromDb(TableItem &resultTable,
                    const std::vector<RequestCondition> &conditions,
                    ErrorContainer &error,
                    const bool showHiddenValues = false,
                    const uint64_t positionOffset = 0,
-                   const uint64_t numberOfRows = 0);
+                   const uint64_t numberOfRows = 0,
+                   const std::vector<OrderBy> &orderBy = {});
+    bool getFromDb(SqlResult &resultTable,
+                   const std::vector<RequestCondition> &conditions,
+                   ErrorContainer &error,
+                   const bool showHiddenValues = false,
+                   const uint64_t positionOffset = 0,
+                   const uint64_t numberOfRows = 0,
+                   const std::vector<OrderBy> &orderBy = {});
     bool getFromDb(JsonItem &result,
                    const std::vector<RequestCondition> &conditions,
                    ErrorContainer &error,
                    const bool showHiddenValues = false,
                    const uint64_t positionOffset = 0,
                    const uint64_t numberOfRows = 0);
+    bool getManyFromDb(SqlResult &result,
+                       const std::vector<std::string> &primaryKeys,
+                       std::vector<std::string> &missingKeys,
+                       ErrorContainer &error,
+                       const bool showHiddenValues = false,
+                       const uint32_t chunkSize = 500);
     long getNumberOfRows(ErrorContainer &error);
+    bool aggregateFromDb(SqlResult &result,
+                         const std::vector<RequestCondition> &conditions,
+                         const std::vector<std::string> &groupBy,
+                         const std::vector<Aggregate> &aggregates,
+                         ErrorContainer &error);
+    bool searchInDb(SqlResult &result,
+                    const std::string &searchText,
+                    ErrorContainer &error,
+                    const bool showHiddenValues = false,
+                    const uint64_t positionOffset = 0,
+                    const uint64_t numberOfRows = 0);
+    bool joinFromDb(SqlResult &result,
+                    const std::vector<RequestCondition> &conditions,
+                    const Join &join,
+                    ErrorContainer &error,
+                    const uint64_t positionOffset = 0,
+                    const uint64_t numberOfRows = 0);
+    bool explainGetFromDb(const std::vector<RequestCondition> &conditions,
+                          SqlDatabase::QueryPlan &plan,
+                          ErrorContainer &error,
+                          const std::vector<OrderBy> &orderBy = {});
     bool deleteAllFromDb(ErrorContainer &error);
     bool deleteFromDb(const std::vector<RequestCondition> &conditions,
                       ErrorContainer &error);
+    bool exportSnapshot(const std::string &filePath,
+                        ErrorContainer &error,
+                        const bool showHiddenValues = false,
+                        const uint64_t rowsPerStep = 10000);
+    long importFromFile(const int fd,
+                        const ImportFormat format,
+                        ErrorContainer &error,
+                        const uint64_t rowsPerTransaction = 10000);
+
+    bool insertToDbAsync(const JsonItem &values,
+                         AsyncCallback callback);
+    bool updateInDbAsync(const std::vector<RequestCondition> &conditions,
+                         const JsonItem &updates,
+                         AsyncCallback callback);
+    bool getFromDbAsync(const std::vector<RequestCondition> &conditions,
+                        AsyncJsonCallback callback,
+                        const bool showHiddenValues = false);
+    bool getAllFromDbAsync(AsyncResultCallback callback,
+                           const bool showHiddenValues = false,
+                           const uint64_t positionOffset = 0,
+                           const uint64_t numberOfRows = 0);
+    bool deleteFromDbAsync(const std::vector<RequestCondition> &conditions,
+                           AsyncCallback callback);
+
+    long getBlobSize(const std::vector<RequestCondition> &conditions,
+                     const std::string &columnName,
+                     ErrorContainer &error);
+    bool readBlob(const std::vector<RequestCondition> &conditions,
+                  const std::string &columnName,
+                  SqlDatabase::BlobReadCallback readCallback,
+                  ErrorContainer &error,
+                  const uint64_t chunkSize = 65536);
+    bool writeBlob(const std::vector<RequestCondition> &conditions,
+                   const std::string &columnName,
+                   const uint64_t blobSize,
+                   SqlDatabase::BlobWriteCallback writeCallback,
+                   ErrorContainer &error,
+                   const uint64_t chunkSize = 65536);
 private:
     SqlDatabase* m_db = nullptr;
+    SqlDatabase* m_readReplica = nullptr;
+    uint32_t m_maxStaleness = 1000;
+    std::mutex m_readReplicaLock;
+    SqlDatabase::ResultLimit m_resultLimit;
+    std::mutex m_resultLimitLock;
+    ChangeFeed* m_changeFeed = nullptr;
+    std::mutex m_changeFeedLock;
+    std::mutex m_asyncLock;
+    std::condition_variable m_asyncFinished;
+    uint64_t m_numberOfAsyncRequests = 0;
+
+    std::thread m_sweeper;
+    std::mutex m_sweeperLock;
+    std::condition_variable m_sweeperWakeup;
+    bool m_sweeperAbort = false;
+
+    WriteBackCache* m_writeBackCache = nullptr;
+    std::shared_mutex m_writeBackLock;
+    std::mutex m_flushLock;
+    std::thread m_flusher;
+    std::mutex m_flusherLock;
+    std::condition_variable m_flusherWakeup;
+    bool m_flusherAbort = false;
+    bool m_flushRequested = false;
+    uint32_t m_flushInterval = 1000;
+    uint64_t m_maxDirtyRows = 1000;
+
+    std::once_flag m_queryFragmentsInit;
+    std::string m_columnList = "";
+    std::string m_selectPrefix = "";
+    std::string m_insertPrefix = "";
+    std::string m_updatePrefix = "";
+    std::string m_deletePrefix = "";
 
     const std::string createTableCreateQuery();
-    const std::string createSelectQuery(const std::vector<RequestCondition> &conditions,
+    void createSelectQuery(std::string &command,
+                           const std::vector<RequestCondition> &conditions,
+                           const uint64_t positionOffset,
+                           const uint64_t numberOfRows,
+                           const std::vector<OrderBy> &orderBy = {});
+    void appendOrderBy(std::string &command,
+                       const std::vector<OrderBy> &orderBy);
+    void createContinuationQuery(std::string &command,
+                                 const std::vector<OrderBy> &orderBy,
+                                 const std::vector<std::string> &lastKey,
+                                 const uint64_t numberOfRows);
+    void createUpdateQuery(std::string &command,
+                           const std::vector<RequestCondition> &conditions,
+                           const JsonItem &updates);
+    void createInsertQuery(std::string &command,
+                           const JsonItem &values);
+    const std::string createPreparedInsertQuery(const bool updateExisting = false);
+    const std::string createPreparedDeleteQuery();
+    void createDeleteQuery(std::string &command,
+                           const std::vector<RequestCondition> &conditions);
+    void createCountQuery(std::string &command);
+    void createManyQuery(std::string &command,
+                         const uint64_t numberOfKeys);
+    const std::string createAggregateQuery(const std::vector<RequestCondition> &conditions,
+                                           const std::vector<std::string> &groupBy,
+                                           const std::vector<Aggregate> &aggregates);
+    void appendFilter(std::string &filter,
+                      const std::vector<RequestCondition> &conditions);
+    const std::string createSearchIndexQuery();
+    const std::string createSearchQuery(const std::string &searchText,
                                         const uint64_t positionOffset,
                                         const uint64_t numberOfRows);
-    const std::string createUpdateQuery(const std::vector<RequestCondition> &conditions,
-                                        const JsonItem &updates);
-    const std::string createInsertQuery(const std::vector<std::string> &values);
-    const std::string createDeleteQuery(const std::vector<RequestCondition> &conditions);
-    const std::string createCountQuery();
+    void createJoinQuery(std::string &command,
+                         const std::vector<RequestCondition> &conditions,
+                         const Join &join,
+                         const std::vector<const DbHeaderEntry*> &columns,
+                         const std::vector<const DbHeaderEntry*> &otherColumns,
+                         const uint64_t positionOffset,
+                         const uint64_t numberOfRows);
+    const std::string createSnapshotQuery(const int64_t lastRowId,
+                                          const uint64_t numberOfRows);
+    void initQueryFragments();
+    const std::string createColumnList();
+    const std::string createColumnExpression(const DbHeaderEntry &entry,
+                                             const std::string &tablePrefix = "");
+    void appendValue(std::string &command,
+                     const DbHeaderEntry* entry,
+                     const std::string &value);
+    void appendValue(std::string &command,
+                     const DbHeaderEntry* entry,
+                     const DataItem* value);
+    const std::string createExpiryFilter(const std::string &tablePrefix = "");
+    const std::string createExpiryIndexQuery();
+    const std::string createColumnIndexQuery();
+    const std::string createDeleteExpiredQuery(const uint64_t batchSize);
+    const std::string createRowIdQuery(const std::vector<RequestCondition> &conditions);
 
     bool processGetResult(JsonItem &result,
                           TableItem &tableContent);
+    bool readFromDb(TableItem &resultTable,
+                    const std::vector<RequestCondition> &conditions,
+                    ErrorContainer &error,
+                    const bool showHiddenValues,
+                    const uint64_t positionOffset,
+                    const uint64_t numberOfRows,
+                    const std::vector<OrderBy> &orderBy,
+                    SqlDatabase::ResultBudget* budget);
+    bool readFromDb(SqlResult &resultTable,
+                    const std::vector<RequestCondition> &conditions,
+                    ErrorContainer &error,
+                    const bool showHiddenValues,
+                    const uint64_t positionOffset,
+                    const uint64_t numberOfRows,
+                    const std::vector<OrderBy> &orderBy,
+                    SqlDatabase::ResultBudget* budget);
+    bool readPartFromDb(TableItem* tableResult,
+                        SqlResult* arenaResult,
+                        std::string &continuationToken,
+                        ErrorContainer &error,
+                        const bool showHiddenValues,
+                        const std::vector<OrderBy> &orderBy);
+    void finishTableResult(TableItem &resultTable,
+                           const bool showHiddenValues);
+    const SqlDatabase::ResultLimit getResultLimit();
+    const std::string createContinuationToken(const std::vector<std::string> &lastKey);
+    bool parseContinuationToken(const std::string &continuationToken,
+                                const uint64_t numberOfKeyColumns,
+                                std::vector<std::string> &lastKey,
+                                ErrorContainer &error);
+    void initResultColumns(SqlResult &resultTable,
+                           const bool showHiddenValues);
+    bool initSearchIndex(ErrorContainer &error);
+    bool checkColumns(ErrorContainer &error);
+    SqlResult::ValueType getResultType(const DbVataValueTypes type);
+    bool getJoinColumns(const std::vector<std::string> &names,
+                        std::vector<const DbHeaderEntry*> &columns,
+                        ErrorContainer &error);
+    bool checkConditions(const std::vector<RequestCondition> &conditions,
+                         ErrorContainer &error);
+    bool checkOrderBy(const std::vector<OrderBy> &orderBy,
+                      ErrorContainer &error);
+    bool initAggregateColumns(SqlResult &result,
+                              const std::vector<std::string> &groupBy,
+                              const std::vector<Aggregate> &aggregates,
+                              ErrorContainer &error);
+    bool runMutation(std::string &command,
+                     const ChangeEvent::ChangeType changeType,
+                     ErrorContainer &error,
+                     uint64_t* numberOfChangedRows = nullptr);
+    bool hasChangeSubscriber();
+    void publishChanges(const ChangeEvent::ChangeType changeType,
+                        const std::vector<std::string> &primaryKeys);
+    long getPrimaryKeyId();
+    SqlDatabase* getReadDatabase();
+    bool flushImportRows(const std::string &insertQuery,
+                         const SqlResult &rows,
+                         const long primaryKeyId,
+                         ErrorContainer &error);
+    bool appendImportRow(SqlResult &rows,
+                         const std::vector<RowField> &fields,
+                         ErrorContainer &error);
+    long getExpiryColumnId();
+    long getVersionColumnId();
+    void runExpirySweeper(const uint32_t sweepInterval,
+                          const uint64_t batchSize,
+                          const uint32_t pauseBetweenBatches);
+    long getColumnId(const std::string &columnName);
+    void startWriteBackFlusher();
+    void stopWriteBackFlusher();
+    void runWriteBackFlusher();
+    void requestFlushIfNeeded();
+    bool flushWriteBackCache(ErrorContainer &error);
+    bool convertConditions(const std::vector<RequestCondition> &conditions,
+                           std::vector<std::pair<uint64_t, std::string>> &cacheConditions,
+                           ErrorContainer &error);
+    bool getFromCache(TableItem &resultTable,
+                      const std::vector<RequestCondition> &conditions,
+                      ErrorContainer &error);
+    void appendCachedValue(SqlResult &result,
+                           const DbHeaderEntry &entry,
+                           const std::string &value,
+                           const bool isNull);
+    bool runAsync(const DatabaseExecutor::TaskType type,
+                  DatabaseExecutor::Task task);
+    bool getBlobRow(const std::vector<RequestCondition> &conditions,
+                    const std::string &columnName,
+                    int64_t &rowId,
+                    std::string &primaryKey,
+                    ErrorContainer &error);
 };
 
 } // namespace Sakura
@@ -0,0 +1,128 @@
+/**
+ * @file       table_snapshot.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_TABLE_SNAPSHOT_H
+#define KITSUNEMIMI_SAKURA_DATABASE_TABLE_SNAPSHOT_H
+
+#include <string>
+#include <string_view>
+#include <stdint.h>
+
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
+#include <libKitsunemimiCommon/logger.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * Read-only view on a memory-mapped column of a snapshot.
+ */
+template<typename T>
+struct ColumnSpan
+{
+    const T* data = nullptr;
+    uint64_t size = 0;
+
+    const T& operator[](const uint64_t pos) const { return data[pos]; }
+    const T* begin() const { return data; }
+    const T* end() const { return data + size; }
+};
+
+/**
+ * Columnar binary snapshot of a table. Each column is stored as one contiguous array of fixed
+ * size values (int64, double, uint8 for bools, uint32 dictionary-ids for strings) together
+ * with an uint8-array of null-markers. All strings of the snapshot are stored once within a
+ * dictionary at the end of the file.
+ *
+ * The reader maps the file into memory, so the columns can be used without copying them.
+ */
+class TableSnapshot
+{
+public:
+    TableSnapshot();
+    ~TableSnapshot();
+
+    static bool writeSnapshot(const std::string &filePath,
+                              const SqlResult &content,
+                              ErrorContainer &error);
+
+    bool openSnapshot(const std::string &filePath,
+                      ErrorContainer &error);
+    void closeSnapshot();
+
+    uint64_t getNumberOfRows() const;
+    uint64_t getNumberOfColumns() const;
+    const std::string getColumnName(const uint64_t column) const;
+    SqlResult::ValueType getColumnType(const uint64_t column) const;
+    long getColumnId(const std::string &name) const;
+
+    ColumnSpan<int64_t> getIntColumn(const uint64_t column) const;
+    ColumnSpan<double> getFloatColumn(const uint64_t column) const;
+    ColumnSpan<uint8_t> getBoolColumn(const uint64_t column) const;
+    ColumnSpan<uint32_t> getStringColumn(const uint64_t column) const;
+    ColumnSpan<uint8_t> getNullColumn(const uint64_t column) const;
+
+    uint64_t getNumberOfDictionaryEntries() const;
+    std::string_view getDictionaryEntry(const uint64_t id) const;
+    std::string_view getString(const uint64_t row, const uint64_t column) const;
+
+private:
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32_t version = 0;
+        uint32_t numberOfColumns = 0;
+        uint64_t numberOfRows = 0;
+        uint64_t numberOfStrings = 0;
+        uint64_t dictOffsetsPos = 0;
+        uint64_t dictDataPos = 0;
+        uint64_t dictDataSize = 0;
+        uint8_t padding[8];
+    };
+    static_assert(sizeof(SnapshotHeader) == 64);
+
+    struct SnapshotColumn
+    {
+        char name[40];
+        uint32_t type = 0;
+        uint32_t padding = 0;
+        uint64_t dataPos = 0;
+        uint64_t nullPos = 0;
+    };
+    static_assert(sizeof(SnapshotColumn) == 64);
+
+    uint8_t* m_data = nullptr;
+    uint64_t m_size = 0;
+    const SnapshotHeader* m_header = nullptr;
+    const SnapshotColumn* m_columns = nullptr;
+
+    const SnapshotColumn* getColumn(const uint64_t column,
+                                    const SqlResult::ValueType type) const;
+    bool checkSnapshot(ErrorContainer &error) const;
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_TABLE_SNAPSHOT_H
@@ -0,0 +1,110 @@
+/**
+ * @file       trace_hook.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_TRACE_HOOK_H
+#define KITSUNEMIMI_SAKURA_DATABASE_TRACE_HOOK_H
+
+#include <string>
+#include <mutex>
+#include <fstream>
+#include <stdint.h>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+struct TraceSpan
+{
+    enum SpanType
+    {
+        // single request to the database, like execSqlCommand
+        QUERY_SPAN = 0,
+        // operation of a table, which contains the query-spans of its requests
+        OPERATION_SPAN = 1
+    };
+
+    SpanType type = QUERY_SPAN;
+    // name of the table, or empty, if the query was not requested by a table
+    std::string tableName = "";
+    std::string operation = "";
+    // shape of the statement, where all literals are replaced by '?'. Empty for operations.
+    std::string statement = "";
+    uint64_t rowsAffected = 0;
+    uint64_t rowsReturned = 0;
+    // small id of the thread, which is unique within the process
+    uint64_t threadId = 0;
+    // all times in microseconds. The start-time is based on a monotonic clock.
+    int64_t startTime = 0;
+    uint64_t duration = 0;
+    uint64_t lockWaitDuration = 0;
+    uint64_t executeDuration = 0;
+    bool success = true;
+};
+
+/**
+ * Interface for hooks, which are called at the start and the end of each request of a database
+ * and each operation of its tables. The hooks are called within the thread of the request, so
+ * they have to be thread-safe and should be fast.
+ */
+class TraceHook
+{
+public:
+    virtual ~TraceHook() {}
+
+    virtual void spanStarted(const TraceSpan &span);
+    virtual void spanFinished(const TraceSpan &span) = 0;
+};
+
+/**
+ * Trace-hook, which writes all finished spans as complete-events in the trace-event-format of
+ * chrome into a json-file, which can be loaded for example into chrome://tracing or perfetto.
+ */
+class ChromeTraceWriter
+        : public TraceHook
+{
+public:
+    ChromeTraceWriter();
+    ~ChromeTraceWriter();
+
+    bool openFile(const std::string &filePath,
+                  ErrorContainer &error);
+    bool closeFile(ErrorContainer &error);
+    uint64_t getNumberOfEvents();
+
+    void spanFinished(const TraceSpan &span);
+
+private:
+    std::mutex m_lock;
+    std::ofstream m_file;
+    std::string m_buffer = "";
+    uint64_t m_numberOfEvents = 0;
+
+    void flushBuffer();
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_TRACE_HOOK_H
@@ -0,0 +1,551 @@
+/**
+ * @file       typed_table.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_TYPED_TABLE_H
+#define KITSUNEMIMI_SAKURA_DATABASE_TYPED_TABLE_H
+
+#include <vector>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <stdint.h>
+
+#include <libKitsunemimiSakuraDatabase/sql_database.h>
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+enum TableColumnFlags
+{
+    NO_FLAGS = 0,
+    PRIMARY_KEY = 1,
+    ALLOW_NULL = 2
+};
+
+/**
+ * Mapping of c++-types to the types of the database. Only the types, which are specialized here,
+ * can be used for columns, so other types result in a compile-error.
+ */
+template<typename T, typename Enable = void>
+struct SqlColumnTraits;
+
+template<>
+struct SqlColumnTraits<std::string>
+{
+    static constexpr SqlResult::ValueType valueType = SqlResult::STRING_VALUE;
+
+    static const std::string sqlType(const int maxLength)
+    {
+        if(maxLength > 0) {
+            return "varchar(" + std::to_string(maxLength) + ")";
+        }
+        return "text";
+    }
+    static void append(SqlResult &result, const std::string &value)
+    {
+        result.appendString(value.c_str(), value.size());
+    }
+    static void read(const SqlResult &result,
+                     const uint64_t row,
+                     const uint64_t column,
+                     std::string &value)
+    {
+        value = std::string(result.getString(row, column));
+    }
+};
+
+template<>
+struct SqlColumnTraits<bool>
+{
+    static constexpr SqlResult::ValueType valueType = SqlResult::BOOL_VALUE;
+
+    static const std::string sqlType(const int) { return "bool"; }
+    static void append(SqlResult &result, const bool value) { result.appendBool(value); }
+    static void read(const SqlResult &result,
+                     const uint64_t row,
+                     const uint64_t column,
+                     bool &value)
+    {
+        value = result.getBool(row, column);
+    }
+};
+
+template<typename T>
+struct SqlColumnTraits<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+{
+    static constexpr SqlResult::ValueType valueType = SqlResult::INT_VALUE;
+
+    static const std::string sqlType(const int) { return "int"; }
+    static void append(SqlResult &result, const T value) { result.appendInt(value); }
+    static void read(const SqlResult &result,
+                     const uint64_t row,
+                     const uint64_t column,
+                     T &value)
+    {
+        value = static_cast<T>(result.getInt(row, column));
+    }
+};
+
+template<typename T>
+struct SqlColumnTraits<T, std::enable_if_t<std::is_floating_point_v<T>>>
+{
+    static constexpr SqlResult::ValueType valueType = SqlResult::FLOAT_VALUE;
+
+    static const std::string sqlType(const int) { return "real"; }
+    static void append(SqlResult &result, const T value) { result.appendFloat(value); }
+    static void read(const SqlResult &result,
+                     const uint64_t row,
+                     const uint64_t column,
+                     T &value)
+    {
+        value = static_cast<T>(result.getFloat(row, column));
+    }
+};
+
+/**
+ * Compile-time description of a single column, which is bound to a member of the row-struct.
+ */
+template<typename RowT, typename MemberT>
+struct TableColumn
+{
+    typedef MemberT MemberType;
+
+    const char* name;
+    MemberT RowT::* member;
+    int maxLength;
+    uint32_t flags;
+
+    constexpr bool isPrimary() const { return (flags & PRIMARY_KEY) != 0; }
+    constexpr bool allowNull() const { return (flags & ALLOW_NULL) != 0; }
+};
+
+/**
+ * @brief create the description of a column
+ *
+ * @param name name of the column within the database
+ * @param member pointer to the member of the row-struct
+ * @param maxLength maximum length for string-columns, or -1 for unlimited
+ * @param flags combination of TableColumnFlags
+ *
+ * @return column-description
+ */
+template<typename RowT, typename MemberT>
+constexpr TableColumn<RowT, MemberT>
+tableColumn(const char* name,
+            MemberT RowT::* member,
+            const int maxLength = -1,
+            const uint32_t flags = NO_FLAGS)
+{
+    static_assert(sizeof(SqlColumnTraits<MemberT>) > 0, "type of column is not supported");
+    return TableColumn<RowT, MemberT>{name, member, maxLength, flags};
+}
+
+/**
+ * @brief search the primary key within the columns of a schema
+ *
+ * @return -1 if there is no primary key, else index of the column
+ */
+template<typename ColumnsT, size_t... I>
+constexpr long
+findPrimaryKeyColumn(const ColumnsT &columns,
+                     std::index_sequence<I...>)
+{
+    const bool isPrimary[] = {false, std::get<I>(columns).isPrimary()...};
+    for(uint64_t i = 1; i < sizeof(isPrimary) / sizeof(bool); i++)
+    {
+        if(isPrimary[i]) {
+            return static_cast<long>(i) - 1;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * Table with a schema, which is defined at compile-time. The schema is a struct with:
+ *
+ *     typedef MyRow Row;
+ *     static constexpr const char* tableName = "my_table";
+ *     static constexpr auto columns = std::make_tuple(tableColumn("id", &MyRow::id, 36, PRIMARY_KEY),
+ *                                                     tableColumn("value", &MyRow::value));
+ *
+ * The sql-statements are generated only once per schema, columns are accessed by their position
+ * instead of their name and all values are transfered with prepared statements. Types, which
+ * doesn't match the row-struct, result in compile-errors.
+ */
+template<typename Schema>
+class TypedTable
+{
+public:
+    typedef typename Schema::Row Row;
+    typedef std::remove_const_t<decltype(Schema::columns)> Columns;
+    static constexpr uint64_t numberOfColumns = std::tuple_size_v<Columns>;
+    static constexpr long primaryKeyId =
+            findPrimaryKeyColumn(Schema::columns, std::make_index_sequence<numberOfColumns>());
+
+    template<long I>
+    using KeyType = typename std::tuple_element_t<(I < 0 ? 0 : I), Columns>::MemberType;
+
+    /**
+     * @brief constructor
+     *
+     * @param db pointer to database
+     */
+    TypedTable(SqlDatabase* db)
+    {
+        m_db = db;
+    }
+
+    /**
+     * @brief initalize table
+     *
+     * @param error reference for error-output
+     *
+     * @return true, if successfuly or table already exist, else false
+     */
+    bool
+    initTable(ErrorContainer &error)
+    {
+        return m_db->execSqlCommand(nullptr, getStatements().createQuery, error);
+    }
+
+    /**
+     * @brief insert a row into the table
+     *
+     * @param row row to insert
+     * @param error reference for error-output
+     *
+     * @return true, if successful, else false
+     */
+    bool
+    insertToDb(const Row &row,
+               ErrorContainer &error)
+    {
+        SqlResult parameters;
+        appendRow(parameters, row, false);
+        return m_db->execPreparedCommand(nullptr, getStatements().insertQuery, parameters, error);
+    }
+
+    /**
+     * @brief get a row by its primary key
+     *
+     * @param row reference for the output
+     * @param key primary key of the requested row
+     * @param error reference for error-output
+     *
+     * @return false, if not found or request failed, else true
+     */
+    template<long I = primaryKeyId>
+    bool
+    getFromDb(Row &row,
+              const KeyType<I> &key,
+              ErrorContainer &error)
+    {
+        static_assert(I >= 0, "schema has no primary key");
+
+        SqlResult parameters;
+        parameters.addColumn("key", SqlColumnTraits<KeyType<I>>::valueType);
+        SqlColumnTraits<KeyType<I>>::append(parameters, key);
+
+        SqlResult result;
+        initResult(result);
+        if(m_db->execPreparedCommand(&result,
+                                     getStatements().selectByKeyQuery,
+                                     parameters,
+                                     error) == false)
+        {
+            return false;
+        }
+
+        if(result.getNumberOfRows() == 0)
+        {
+            error.addMeesage("no entry found in database-table '"
+                             + std::string(Schema::tableName) + "'.");
+            return false;
+        }
+
+        readRow(result, 0, row);
+        return true;
+    }
+
+    /**
+     * @brief get all rows of the table
+     *
+     * @param rows reference for the output. New rows are appended.
+     * @param error reference for error-output
+     * @param positionOffset offset of the rows to return
+     * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+     *
+     * @return true, if successful, else false
+     */
+    bool
+    getAllFromDb(std::vector<Row> &rows,
+                 ErrorContainer &error,
+                 const uint64_t positionOffset = 0,
+                 const uint64_t numberOfRows = 0)
+    {
+        SqlResult parameters;
+        std::string query = getStatements().selectAllQuery;
+        if(numberOfRows > 0)
+        {
+            query = getStatements().selectAllLimitedQuery;
+            parameters.addColumn("limit", SqlResult::INT_VALUE);
+            parameters.addColumn("offset", SqlResult::INT_VALUE);
+            parameters.appendInt(static_cast<int64_t>(numberOfRows));
+            parameters.appendInt(static_cast<int64_t>(positionOffset));
+        }
+
+        SqlResult result;
+        initResult(result);
+        if(m_db->execPreparedCommand(&result, query, parameters, error) == false) {
+            return false;
+        }
+
+        const uint64_t oldSize = rows.size();
+        rows.resize(oldSize + result.getNumberOfRows());
+        for(uint64_t i = 0; i < result.getNumberOfRows(); i++) {
+            readRow(result, i, rows[oldSize + i]);
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief update all values of a row, which is identified by the primary key of the input
+     *
+     * @param row row with the new values
+     * @param error reference for error-output
+     *
+     * @return true, if successful, else false
+     */
+    template<long I = primaryKeyId>
+    bool
+    updateInDb(const Row &row,
+               ErrorContainer &error)
+    {
+        static_assert(I >= 0, "schema has no primary key");
+
+        // values in order of the columns and primary key for the where-clause at the end
+        SqlResult parameters;
+        appendRow(parameters, row, true);
+        return m_db->execPreparedCommand(nullptr, getStatements().updateQuery, parameters, error);
+    }
+
+    /**
+     * @brief delete a row by its primary key
+     *
+     * @param key primary key of the row to delete
+     * @param error reference for error-output
+     *
+     * @return true, if successful, else false
+     */
+    template<long I = primaryKeyId>
+    bool
+    deleteFromDb(const KeyType<I> &key,
+                 ErrorContainer &error)
+    {
+        static_assert(I >= 0, "schema has no primary key");
+
+        SqlResult parameters;
+        parameters.addColumn("key", SqlColumnTraits<KeyType<I>>::valueType);
+        SqlColumnTraits<KeyType<I>>::append(parameters, key);
+        return m_db->execPreparedCommand(nullptr, getStatements().deleteByKeyQuery, parameters, error);
+    }
+
+private:
+    struct Statements
+    {
+        std::string createQuery = "";
+        std::string insertQuery = "";
+        std::string selectAllQuery = "";
+        std::string selectAllLimitedQuery = "";
+        std::string selectByKeyQuery = "";
+        std::string updateQuery = "";
+        std::string deleteByKeyQuery = "";
+    };
+
+    SqlDatabase* m_db = nullptr;
+
+    /**
+     * @brief get the sql-statements of the schema, which are only created once
+     */
+    static const Statements&
+    getStatements()
+    {
+        static const Statements statements = createStatements();
+        return statements;
+    }
+
+    /**
+     * @brief create all sql-statements of the schema
+     */
+    static Statements
+    createStatements()
+    {
+        std::string columnList = "";
+        std::string columnDefinitions = "";
+        std::string placeholder = "";
+        std::string updateList = "";
+        std::string primaryKeyName = "";
+
+        std::apply([&](const auto&... column) {
+            (appendColumn(column,
+                          columnList,
+                          columnDefinitions,
+                          placeholder,
+                          updateList,
+                          primaryKeyName), ...);
+        }, Schema::columns);
+
+        const std::string tableName = Schema::tableName;
+        Statements statements;
+        statements.createQuery = "CREATE TABLE IF NOT EXISTS " + tableName
+                                 + " (" + columnDefinitions + ");";
+        statements.insertQuery = "INSERT INTO " + tableName
+                                 + "(" + columnList + ") VALUES (" + placeholder + ");";
+        statements.selectAllQuery = "SELECT " + columnList + " FROM " + tableName + ";";
+        statements.selectAllLimitedQuery = "SELECT " + columnList + " FROM " + tableName
+                                           + " LIMIT ? OFFSET ?;";
+        if(primaryKeyName != "")
+        {
+            statements.selectByKeyQuery = "SELECT " + columnList + " FROM " + tableName
+                                          + " WHERE " + primaryKeyName + "=?;";
+            statements.updateQuery = "UPDATE " + tableName + " SET " + updateList
+                                     + " WHERE " + primaryKeyName + "=?;";
+            statements.deleteByKeyQuery = "DELETE FROM " + tableName
+                                          + " WHERE " + primaryKeyName + "=?;";
+        }
+
+        return statements;
+    }
+
+    /**
+     * @brief add a single column to the parts of the sql-statements
+     */
+    template<typename ColumnT>
+    static void
+    appendColumn(const ColumnT &column,
+                 std::string &columnList,
+                 std::string &columnDefinitions,
+                 std::string &placeholder,
+                 std::string &updateList,
+                 std::string &primaryKeyName)
+    {
+        typedef SqlColumnTraits<typename ColumnT::MemberType> Traits;
+
+        if(columnList != "")
+        {
+            columnList.append(" , ");
+            columnDefinitions.append(" , ");
+            placeholder.append(" , ");
+            updateList.append(" , ");
+        }
+
+        columnList.append(column.name);
+        placeholder.append("?");
+        updateList.append(std::string(column.name) + "=?");
+
+        columnDefinitions.append(std::string(column.name) + "  ");
+        columnDefinitions.append(Traits::sqlType(column.maxLength) + " ");
+        if(column.isPrimary())
+        {
+            columnDefinitions.append("PRIMARY KEY ");
+            primaryKeyName = column.name;
+        }
+        if(column.allowNull() == false) {
+            columnDefinitions.append("NOT NULL ");
+        }
+    }
+
+    /**
+     * @brief add one column per schema-column with the matching type to a result
+     */
+    static void
+    initResult(SqlResult &result)
+    {
+        std::apply([&](const auto&... column) {
+            (result.addColumn(column.name,
+                              SqlColumnTraits<typename std::decay_t<decltype(column)>::MemberType>
+                                  ::valueType), ...);
+        }, Schema::columns);
+    }
+
+    /**
+     * @brief convert a row-struct into parameters for a prepared statement
+     *
+     * @param parameters reference for the output
+     * @param row row to convert
+     * @param withKey true to add the primary key again at the end for the where-clause of updates
+     */
+    static void
+    appendRow(SqlResult &parameters,
+              const Row &row,
+              const bool withKey)
+    {
+        initResult(parameters);
+        if constexpr(primaryKeyId >= 0)
+        {
+            if(withKey) {
+                parameters.addColumn("key", SqlColumnTraits<KeyType<primaryKeyId>>::valueType);
+            }
+        }
+
+        std::apply([&](const auto&... column) {
+            (SqlColumnTraits<typename std::decay_t<decltype(column)>::MemberType>
+                ::append(parameters, row.*(column.member)), ...);
+        }, Schema::columns);
+
+        if constexpr(primaryKeyId >= 0)
+        {
+            if(withKey)
+            {
+                const auto &keyColumn = std::get<primaryKeyId>(Schema::columns);
+                SqlColumnTraits<KeyType<primaryKeyId>>::append(parameters,
+                                                               row.*(keyColumn.member));
+            }
+        }
+    }
+
+    /**
+     * @brief read a row of a result into a row-struct
+     */
+    static void
+    readRow(const SqlResult &result,
+            const uint64_t rowId,
+            Row &row)
+    {
+        uint64_t column = 0;
+        std::apply([&](const auto&... col) {
+            (SqlColumnTraits<typename std::decay_t<decltype(col)>::MemberType>
+                ::read(result, rowId, column++, row.*(col.member)), ...);
+        }, Schema::columns);
+    }
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_TYPED_TABLE_H
@@ -0,0 +1,188 @@
+/**
+ * @file       change_feed.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiSakuraDatabase/change_feed.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * @brief constructor, which starts the delivery-thread
+ *
+ * @param maxBatchSize maximum number of events, which are delivered with one callback
+ */
+ChangeFeed::ChangeFeed(const uint64_t maxBatchSize)
+{
+    m_maxBatchSize = maxBatchSize;
+    if(m_maxBatchSize == 0) {
+        m_maxBatchSize = 1;
+    }
+
+    m_thread = std::thread(&ChangeFeed::run, this);
+}
+
+/**
+ * @brief destructor, which delivers all remaining events and stops the delivery-thread
+ */
+ChangeFeed::~ChangeFeed()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_abort = true;
+    }
+    m_newEvents.notify_all();
+    m_thread.join();
+}
+
+/**
+ * @brief register a new subscriber
+ *
+ * @param callback callback, which is called within the delivery-thread for each batch of events
+ *
+ * @return id of the subscriber
+ */
+uint64_t
+ChangeFeed::addSubscriber(ChangeCallback callback)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    const uint64_t id = m_nextSubscriberId;
+    m_nextSubscriberId++;
+    m_subscribers.emplace(id, callback);
+
+    return id;
+}
+
+/**
+ * @brief remove a subscriber. A batch, which is already in delivery, can still reach the
+ *        subscriber, so call flush afterwards to be sure, that the callback is not used anymore.
+ *
+ * @param subscriberId id of the subscriber
+ *
+ * @return false, if id was not found, else true
+ */
+bool
+ChangeFeed::removeSubscriber(const uint64_t subscriberId)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_subscribers.erase(subscriberId) > 0;
+}
+
+/**
+ * @brief check if there is at least one subscriber
+ *
+ * @return true, if there are subscribers, else false
+ */
+bool
+ChangeFeed::hasSubscriber()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_subscribers.size() > 0;
+}
+
+/**
+ * @brief add events to the queue for the next delivery
+ *
+ * @param type type of the change
+ * @param primaryKeys primary-keys of all changed rows
+ */
+void
+ChangeFeed::addEvents(const ChangeEvent::ChangeType type,
+                      const std::vector<std::string> &primaryKeys)
+{
+    if(primaryKeys.size() == 0) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        for(const std::string &key : primaryKeys)
+        {
+            ChangeEvent event;
+            event.type = type;
+            event.primaryKey = key;
+            m_queue.push_back(event);
+        }
+    }
+    m_newEvents.notify_one();
+}
+
+/**
+ * @brief block until all queued events are delivered
+ */
+void
+ChangeFeed::flush()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_delivered.wait(guard, [this] { return m_queue.empty() && m_isDelivering == false; });
+}
+
+/**
+ * @brief loop of the delivery-thread
+ */
+void
+ChangeFeed::run()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+
+    while(true)
+    {
+        m_newEvents.wait(guard, [this] { return m_abort || m_queue.empty() == false; });
+        if(m_queue.empty()
+                && m_abort)
+        {
+            break;
+        }
+
+        // take next batch out of the queue
+        std::vector<ChangeEvent> batch;
+        if(m_queue.size() <= m_maxBatchSize)
+        {
+            batch.swap(m_queue);
+        }
+        else
+        {
+            batch.assign(m_queue.begin(), m_queue.begin() + m_maxBatchSize);
+            m_queue.erase(m_queue.begin(), m_queue.begin() + m_maxBatchSize);
+        }
+
+        // call subscribers without holding the lock, so new events can be added in the meantime
+        const std::map<uint64_t, ChangeCallback> subscribers = m_subscribers;
+        m_isDelivering = true;
+        guard.unlock();
+
+        for(const auto &subscriber : subscribers) {
+            subscriber.second(batch);
+        }
+
+        guard.lock();
+        m_isDelivering = false;
+        m_delivered.notify_all();
+    }
+
+    m_delivered.notify_all();
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
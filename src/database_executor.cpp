@@ -0,0 +1,144 @@
+/**
+ * @file       database_executor.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiSakuraDatabase/database_executor.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * @brief constructor, which starts the reader-threads and the writer-thread
+ *
+ * @param numberOfReaders number of threads for reading tasks
+ */
+DatabaseExecutor::DatabaseExecutor(const uint32_t numberOfReaders)
+{
+    const uint32_t readers = numberOfReaders == 0 ? 1 : numberOfReaders;
+    for(uint32_t i = 0; i < readers; i++) {
+        m_threads.emplace_back(&DatabaseExecutor::run, this, &m_readQueue);
+    }
+    m_threads.emplace_back(&DatabaseExecutor::run, this, &m_writeQueue);
+}
+
+/**
+ * @brief destructor, which processes all remaining tasks and stops the threads
+ */
+DatabaseExecutor::~DatabaseExecutor()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_abort = true;
+    }
+    m_readQueue.newTask.notify_all();
+    m_writeQueue.newTask.notify_all();
+
+    for(std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief add a new task to the executor
+ *
+ * @param type READ_TASK for tasks, which only read, WRITE_TASK for all other tasks
+ * @param task task to execute
+ *
+ * @return false, if the executor is already shutting down, else true
+ */
+bool
+DatabaseExecutor::post(const TaskType type,
+                       Task task)
+{
+    TaskQueue* queue = type == WRITE_TASK ? &m_writeQueue : &m_readQueue;
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if(m_abort) {
+            return false;
+        }
+        queue->tasks.push_back(task);
+    }
+    queue->newTask.notify_one();
+
+    return true;
+}
+
+/**
+ * @brief get number of queued and currently running tasks
+ */
+uint64_t
+DatabaseExecutor::getNumberOfPendingTasks()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_readQueue.tasks.size() + m_writeQueue.tasks.size() + m_numberOfActiveTasks;
+}
+
+/**
+ * @brief block until all queued tasks are finished
+ */
+void
+DatabaseExecutor::waitUntilIdle()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_idle.wait(guard, [this] {
+        return m_readQueue.tasks.empty()
+               && m_writeQueue.tasks.empty()
+               && m_numberOfActiveTasks == 0;
+    });
+}
+
+/**
+ * @brief loop of a worker-thread
+ *
+ * @param queue queue, which is processed by the thread
+ */
+void
+DatabaseExecutor::run(TaskQueue* queue)
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+
+    while(true)
+    {
+        queue->newTask.wait(guard, [&] { return m_abort || queue->tasks.empty() == false; });
+        if(queue->tasks.empty()
+                && m_abort)
+        {
+            break;
+        }
+
+        const Task task = queue->tasks.front();
+        queue->tasks.pop_front();
+        m_numberOfActiveTasks++;
+        guard.unlock();
+
+        task();
+
+        guard.lock();
+        m_numberOfActiveTasks--;
+        m_idle.notify_all();
+    }
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
@@ -0,0 +1,574 @@
+/**
+ * @file       row_parser.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <row_parser.h>
+
+#include <algorithm>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * @brief check if a character is a whitespace within json
+ */
+inline bool
+isJsonWhitespace(const char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/**
+ * @brief append a unicode code-point as utf8 to a string
+ */
+inline void
+appendUtf8(std::string &output,
+           const uint32_t codePoint)
+{
+    if(codePoint < 0x80)
+    {
+        output.push_back(static_cast<char>(codePoint));
+    }
+    else if(codePoint < 0x800)
+    {
+        output.push_back(static_cast<char>(0xC0 | (codePoint >> 6)));
+        output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else if(codePoint < 0x10000)
+    {
+        output.push_back(static_cast<char>(0xE0 | (codePoint >> 12)));
+        output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+    else
+    {
+        output.push_back(static_cast<char>(0xF0 | (codePoint >> 18)));
+        output.push_back(static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F)));
+        output.push_back(static_cast<char>(0x80 | (codePoint & 0x3F)));
+    }
+}
+
+/**
+ * @brief constructor
+ *
+ * @param format format of the input
+ * @param columnNames names of the target-columns
+ */
+RowParser::RowParser(const Format format,
+                     const std::vector<std::string> &columnNames)
+{
+    m_format = format;
+    m_columnNames = columnNames;
+}
+
+/**
+ * @brief search the end of the next record. Line-breaks within quoted csv-fields don't end
+ *        the record.
+ *
+ * @param input input-data, which begins with the record
+ *
+ * @return position of the line-break at the end of the record, or -1 if the record is incomplete
+ */
+long
+RowParser::findRecordEnd(const std::string_view input) const
+{
+    bool inQuotes = false;
+    for(uint64_t i = 0; i < input.size(); i++)
+    {
+        const char c = input[i];
+        if(c == '"' && m_format == CSV_FORMAT) {
+            inQuotes = !inQuotes;
+        } else if(c == '\n' && inQuotes == false) {
+            return static_cast<long>(i);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief check if the next record has to be the header-line
+ *
+ * @return true, if input is csv and header was not parsed yet, else false
+ */
+bool
+RowParser::needHeader() const
+{
+    return m_format == CSV_FORMAT && m_headerParsed == false;
+}
+
+/**
+ * @brief parse the header-line of a csv-input and map its fields to the target-columns
+ *
+ * @param record header-line without line-break
+ * @param error reference for error-output
+ *
+ * @return false, if header is invalid or contains unknown columns, else true
+ */
+bool
+RowParser::parseHeader(const std::string_view record,
+                       ErrorContainer &error)
+{
+    std::vector<RowField> names;
+    if(splitCsv(record, names, error) == false) {
+        return false;
+    }
+
+    m_csvMapping.clear();
+    for(const RowField &name : names)
+    {
+        const long columnId = getColumnId(name.value);
+        if(columnId == -1)
+        {
+            error.addMeesage("column '" + name.value + "' of the csv-header doesn't exist in table");
+            return false;
+        }
+        m_csvMapping.push_back(columnId);
+    }
+
+    m_headerParsed = true;
+    return true;
+}
+
+/**
+ * @brief parse a record and map its values to the target-columns
+ *
+ * @param record record without line-break
+ * @param fields reference for the output. Has one entry per target-column afterwards.
+ * @param error reference for error-output
+ *
+ * @return false, if record is invalid, else true
+ */
+bool
+RowParser::parseRecord(const std::string_view record,
+                       std::vector<RowField> &fields,
+                       ErrorContainer &error)
+{
+    fields.resize(m_columnNames.size());
+    for(RowField &field : fields)
+    {
+        field.value.clear();
+        field.isSet = false;
+        field.isNull = true;
+    }
+
+    if(m_format == CSV_FORMAT) {
+        return parseCsvRecord(record, fields, error);
+    }
+
+    return parseJsonRecord(record, fields, error);
+}
+
+/**
+ * @brief get index of a target-column
+ *
+ * @param name name of the column
+ *
+ * @return -1 if not found, else index of the column
+ */
+long
+RowParser::getColumnId(const std::string &name) const
+{
+    for(uint64_t i = 0; i < m_columnNames.size(); i++)
+    {
+        if(m_columnNames.at(i) == name) {
+            return static_cast<long>(i);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief split a csv-record into its fields. Empty unquoted fields are null.
+ *
+ * @param record record without line-break
+ * @param values reference for the resulting fields
+ * @param error reference for error-output
+ *
+ * @return false, if quotes are invalid, else true
+ */
+bool
+RowParser::splitCsv(const std::string_view record,
+                    std::vector<RowField> &values,
+                    ErrorContainer &error) const
+{
+    uint64_t pos = 0;
+    while(true)
+    {
+        RowField field;
+        field.isSet = true;
+
+        if(pos < record.size()
+                && record[pos] == '"')
+        {
+            // quoted field, where double quotes are an escaped quote
+            pos++;
+            while(true)
+            {
+                if(pos >= record.size())
+                {
+                    error.addMeesage("unterminated quote in csv-record");
+                    return false;
+                }
+
+                if(record[pos] == '"')
+                {
+                    if(pos + 1 < record.size()
+                            && record[pos + 1] == '"')
+                    {
+                        field.value.push_back('"');
+                        pos += 2;
+                        continue;
+                    }
+                    pos++;
+                    break;
+                }
+
+                field.value.push_back(record[pos]);
+                pos++;
+            }
+
+            if(pos < record.size()
+                    && record[pos] != ',')
+            {
+                error.addMeesage("unexpected character after quoted field in csv-record");
+                return false;
+            }
+            field.isNull = false;
+        }
+        else
+        {
+            const uint64_t end = std::min(record.find(',', pos), record.size());
+            field.value = std::string(record.substr(pos, end - pos));
+            field.isNull = field.value.empty();
+            pos = end;
+        }
+
+        values.push_back(field);
+
+        if(pos >= record.size()) {
+            return true;
+        }
+
+        // skip separator
+        pos++;
+    }
+}
+
+/**
+ * @brief parse a csv-record based on the mapping of the header
+ *
+ * @param record record without line-break
+ * @param fields reference for the output
+ * @param error reference for error-output
+ *
+ * @return false, if record is invalid, else true
+ */
+bool
+RowParser::parseCsvRecord(const std::string_view record,
+                          std::vector<RowField> &fields,
+                          ErrorContainer &error)
+{
+    std::vector<RowField> values;
+    if(splitCsv(record, values, error) == false) {
+        return false;
+    }
+
+    if(values.size() != m_csvMapping.size())
+    {
+        error.addMeesage("csv-record has "
+                         + std::to_string(values.size())
+                         + " fields, but the header has "
+                         + std::to_string(m_csvMapping.size()));
+        return false;
+    }
+
+    for(uint64_t i = 0; i < values.size(); i++) {
+        fields[m_csvMapping.at(i)] = std::move(values[i]);
+    }
+
+    return true;
+}
+
+/**
+ * @brief parse a flat json-object
+ *
+ * @param record record without line-break
+ * @param fields reference for the output
+ * @param error reference for error-output
+ *
+ * @return false, if record is invalid, else true
+ */
+bool
+RowParser::parseJsonRecord(const std::string_view record,
+                           std::vector<RowField> &fields,
+                           ErrorContainer &error)
+{
+    uint64_t pos = 0;
+    while(pos < record.size() && isJsonWhitespace(record[pos])) {
+        pos++;
+    }
+
+    if(pos >= record.size()
+            || record[pos] != '{')
+    {
+        error.addMeesage("json-record is not an object");
+        return false;
+    }
+    pos++;
+
+    std::string key;
+    bool first = true;
+    while(true)
+    {
+        while(pos < record.size() && isJsonWhitespace(record[pos])) {
+            pos++;
+        }
+
+        if(pos >= record.size())
+        {
+            error.addMeesage("json-record is incomplete");
+            return false;
+        }
+
+        // end of object
+        if(record[pos] == '}' && first)
+        {
+            pos++;
+            break;
+        }
+        first = false;
+
+        // parse key
+        key.clear();
+        if(parseJsonString(record, pos, key, error) == false) {
+            return false;
+        }
+
+        const long columnId = getColumnId(key);
+        if(columnId == -1)
+        {
+            error.addMeesage("key '" + key + "' of the json-record doesn't exist in table");
+            return false;
+        }
+        RowField &field = fields[columnId];
+        field.isSet = true;
+        field.isNull = false;
+
+        while(pos < record.size() && isJsonWhitespace(record[pos])) {
+            pos++;
+        }
+        if(pos >= record.size()
+                || record[pos] != ':')
+        {
+            error.addMeesage("missing ':' after key '" + key + "' in json-record");
+            return false;
+        }
+        pos++;
+        while(pos < record.size() && isJsonWhitespace(record[pos])) {
+            pos++;
+        }
+
+        // parse value
+        if(pos >= record.size())
+        {
+            error.addMeesage("json-record is incomplete");
+            return false;
+        }
+        else if(record[pos] == '"')
+        {
+            if(parseJsonString(record, pos, field.value, error) == false) {
+                return false;
+            }
+        }
+        else if(record[pos] == '{'
+                || record[pos] == '[')
+        {
+            error.addMeesage("nested value for key '" + key + "' is not supported");
+            return false;
+        }
+        else
+        {
+            // numbers, bools and null are taken as they are
+            const uint64_t start = pos;
+            while(pos < record.size()
+                  && record[pos] != ','
+                  && record[pos] != '}'
+                  && isJsonWhitespace(record[pos]) == false)
+            {
+                pos++;
+            }
+            field.value = std::string(record.substr(start, pos - start));
+            if(field.value == "null")
+            {
+                field.value.clear();
+                field.isNull = true;
+            }
+        }
+
+        while(pos < record.size() && isJsonWhitespace(record[pos])) {
+            pos++;
+        }
+        if(pos < record.size()
+                && record[pos] == ',')
+        {
+            pos++;
+            continue;
+        }
+        if(pos < record.size()
+                && record[pos] == '}')
+        {
+            pos++;
+            break;
+        }
+
+        error.addMeesage("missing ',' or '}' in json-record");
+        return false;
+    }
+
+    // only whitespaces are allowed behind the object
+    while(pos < record.size())
+    {
+        if(isJsonWhitespace(record[pos]) == false)
+        {
+            error.addMeesage("unexpected content behind json-object");
+            return false;
+        }
+        pos++;
+    }
+
+    return true;
+}
+
+/**
+ * @brief parse a json-string and resolve its escape-sequences
+ *
+ * @param record complete record
+ * @param pos position of the opening quote. Points behind the closing quote afterwards.
+ * @param output reference for the resulting string
+ * @param error reference for error-output
+ *
+ * @return false, if string is invalid, else true
+ */
+bool
+RowParser::parseJsonString(const std::string_view record,
+                           uint64_t &pos,
+                           std::string &output,
+                           ErrorContainer &error) const
+{
+    if(pos >= record.size()
+            || record[pos] != '"')
+    {
+        error.addMeesage("expected string in json-record");
+        return false;
+    }
+    pos++;
+
+    while(pos < record.size())
+    {
+        const char c = record[pos];
+        if(c == '"')
+        {
+            pos++;
+            return true;
+        }
+
+        if(c != '\\')
+        {
+            output.push_back(c);
+            pos++;
+            continue;
+        }
+
+        // escape-sequence
+        pos++;
+        if(pos >= record.size()) {
+            break;
+        }
+
+        switch(record[pos])
+        {
+            case '"':  output.push_back('"');  break;
+            case '\\': output.push_back('\\'); break;
+            case '/':  output.push_back('/');  break;
+            case 'b':  output.push_back('\b'); break;
+            case 'f':  output.push_back('\f'); break;
+            case 'n':  output.push_back('\n'); break;
+            case 'r':  output.push_back('\r'); break;
+            case 't':  output.push_back('\t'); break;
+            case 'u':
+            {
+                if(pos + 4 >= record.size())
+                {
+                    error.addMeesage("invalid unicode-escape in json-string");
+                    return false;
+                }
+
+                uint32_t codePoint = 0;
+                try {
+                    codePoint = std::stoul(std::string(record.substr(pos + 1, 4)), nullptr, 16);
+                } catch(...) {
+                    error.addMeesage("invalid unicode-escape in json-string");
+                    return false;
+                }
+                pos += 4;
+
+                // combine surrogate-pair
+                if(codePoint >= 0xD800
+                        && codePoint < 0xDC00
+                        && pos + 6 < record.size()
+                        && record[pos + 1] == '\\'
+                        && record[pos + 2] == 'u')
+                {
+                    uint32_t low = 0;
+                    try {
+                        low = std::stoul(std::string(record.substr(pos + 3, 4)), nullptr, 16);
+                    } catch(...) {
+                        low = 0;
+                    }
+
+                    if(low >= 0xDC00 && low < 0xE000)
+                    {
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        pos += 6;
+                    }
+                }
+
+                appendUtf8(output, codePoint);
+                break;
+            }
+            default:
+                error.addMeesage("invalid escape-sequence in json-string");
+                return false;
+        }
+        pos++;
+    }
+
+    error.addMeesage("unterminated string in json-record");
+    return false;
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
@@ -0,0 +1,94 @@
+/**
+ * @file       row_parser.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_ROW_PARSER_H
+#define KITSUNEMIMI_SAKURA_DATABASE_ROW_PARSER_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+
+#include <libKitsunemimiCommon/logger.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+struct RowField
+{
+    std::string value = "";
+    bool isSet = false;
+    bool isNull = true;
+};
+
+/**
+ * Parser for single records of csv- or json-lines-input, which maps the fields of the records
+ * to a fixed list of columns. Only flat json-objects with scalar values are supported.
+ */
+class RowParser
+{
+public:
+    enum Format
+    {
+        CSV_FORMAT = 0,
+        JSON_LINES_FORMAT = 1
+    };
+
+    RowParser(const Format format,
+              const std::vector<std::string> &columnNames);
+
+    long findRecordEnd(const std::string_view input) const;
+    bool needHeader() const;
+    bool parseHeader(const std::string_view record,
+                     ErrorContainer &error);
+    bool parseRecord(const std::string_view record,
+                     std::vector<RowField> &fields,
+                     ErrorContainer &error);
+
+private:
+    Format m_format = CSV_FORMAT;
+    std::vector<std::string> m_columnNames;
+    std::vector<long> m_csvMapping;
+    bool m_headerParsed = false;
+
+    long getColumnId(const std::string &name) const;
+
+    bool splitCsv(const std::string_view record,
+                  std::vector<RowField> &values,
+                  ErrorContainer &error) const;
+    bool parseCsvRecord(const std::string_view record,
+                        std::vector<RowField> &fields,
+                        ErrorContainer &error);
+    bool parseJsonRecord(const std::string_view record,
+                         std::vector<RowField> &fields,
+                         ErrorContainer &error);
+    bool parseJsonString(const std::string_view record,
+                         uint64_t &pos,
+                         std::string &output,
+                         ErrorContainer &error) const;
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_ROW_PARSER_H
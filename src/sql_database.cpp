@@ -21,16 +21,91 @@
  */
 
 #include <libKitsunemimiSakuraDatabase/sql_database.h>
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
+#include <trace_scope.h>
+#include <value_compression.h>
+
+#include <sqlite3.h>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <tuple>
+#include <cstdio>
+#include <cctype>
+#include <fstream>
+#include <filesystem>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
 
 namespace Kitsunemimi
 {
 namespace Sakura
 {
 
+/**
+ * @brief get the number of rows, which were changed by the last statement of a connection
+ *
+ * @param db connection, which has run the statement
+ * @param totalChangesBefore total number of changes of the connection before the statement
+ *
+ * @return 0, if the statement didn't change anything, else number of changed rows
+ */
+inline uint64_t
+getChangedRows(sqlite3* db,
+               const int64_t totalChangesBefore)
+{
+    // sqlite3_changes64 is only updated by insert-, update- and delete-statements
+    if(sqlite3_total_changes64(db) == totalChangesBefore) {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(sqlite3_changes64(db));
+}
+
+/**
+ * @brief get the publish-time and the counter out of the name of a snapshot-file
+ *
+ * @param name file-name in the format 'snapshot-<time>-<process-id>-<counter>.db'
+ * @param publishTime reference for the publish-time
+ * @param counter reference for the counter
+ *
+ * @return false, if the name is not the name of a snapshot-file, else true
+ */
+inline bool
+parseSnapshotName(const std::string &name,
+                  int64_t &publishTime,
+                  uint64_t &counter)
+{
+    long long time = 0;
+    long long processId = 0;
+    unsigned long long number = 0;
+    int length = 0;
+    if(sscanf(name.c_str(), "snapshot-%lld-%lld-%llu.db%n", &time, &processId, &number, &length)
+            != 3
+            || static_cast<uint64_t>(length) != name.size())
+    {
+        return false;
+    }
+
+    publishTime = static_cast<int64_t>(time);
+    counter = static_cast<uint64_t>(number);
+
+    return true;
+}
+
 /**
  * @brief constructor
  */
-SqlDatabase::SqlDatabase() {}
+SqlDatabase::SqlDatabase()
+{
+    m_lastRequest = 0;
+    m_replicaPublishTime = 0;
+    m_writerInTransaction = false;
+    m_maxNumberOfParameters = 999;
+    m_planCheckMode = NO_PLAN_CHECK;
+    m_traceHook = nullptr;
+}
 
 /**
  * @brief destructor
@@ -45,12 +120,25 @@ SqlDatabase::~SqlDatabase()
  *
  * @param path file-path to sqlite-database
  * @param error reference for error-output
+ * @param numberOfReaders number of additional read-only connections. If greater than 0, the
+ *                        database-file is permanently switched into the write-ahead-log mode,
+ *                        so read-requests run in parallel to each other and are not blocked by
+ *                        write-requests. Write-requests are still processed one after another,
+ *                        because sqlite allows only one writer per database. Default is 0, so
+ *                        all requests are processed by a single connection.
+ * @param incrementalVacuum true to enable the incremental vacuum for a new database-file, so
+ *                          the maintenance can give free pages back to the file-system. This
+ *                          adds pointer-map pages to the file and some overhead to each write.
+ *                          It has no effect on an already existing database-file, where the
+ *                          first table was created without it.
  *
  * @return true, if successful, else false
  */
 bool
 SqlDatabase::initDatabase(const std::string &path,
-                          Kitsunemimi::ErrorContainer &error)
+                          Kitsunemimi::ErrorContainer &error,
+                          const uint32_t numberOfReaders,
+                          const bool incrementalVacuum)
 {
     std::lock_guard<std::mutex> guard(m_lock);
 
@@ -61,16 +149,163 @@ SqlDatabase::initDatabase(const std::string &path,
         return true;
     }
 
-    // init database
-    if(m_db.initDB(path, error))
+    if(openDatabase(path, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, error) == false) {
+        return false;
+    }
+
+    // must be set before the first table is created
+    if(incrementalVacuum
+            && sqlite3_exec(m_db, "PRAGMA auto_vacuum = INCREMENTAL;", nullptr, nullptr, nullptr)
+               != SQLITE_OK)
     {
-        m_isOpen = true;
-        m_path = path;
+        LOG_WARNING("no incremental vacuum possible for database '" + path + "': "
+                    + std::string(sqlite3_errmsg(m_db)));
+    }
+
+    // without readers all requests are processed by the single connection
+    if(numberOfReaders > 0
+            && openReaders(numberOfReaders, error) == false)
+    {
+        LOG_WARNING("no parallel reads possible for database '" + path + "': "
+                    + error.toString());
+    }
+
+    return true;
+}
+
+/**
+ * @brief initialize a database, which exist only in memory and is lost when closed
+ *
+ * @param error reference for error-output
+ * @param sharedName if not empty, all databases within the process, which are initialized with
+ *                   the same name, share the same content, as long as one of them is open
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::initMemoryDatabase(Kitsunemimi::ErrorContainer &error,
+                                const std::string &sharedName)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(sharedName.empty()) {
+        return openDatabase(":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, error);
+    }
+
+    return openDatabase("file:" + sharedName + "?mode=memory&cache=shared",
+                        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_URI,
+                        error);
+}
+
+/**
+ * @brief initialize a private database in a temporary file, which is deleted when closed.
+ *        Small databases stay in the page-cache and are only written into the file, when the
+ *        cache becomes too big.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::initTemporaryDatabase(Kitsunemimi::ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return openDatabase("", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, error);
+}
+
+/**
+ * @brief load the content of a database-file into a new in-memory database. All requests are
+ *        served from memory and changes are only written back into the file with a checkpoint.
+ *
+ * @param path file-path to sqlite-database. If the file doesn't exist, the database starts empty.
+ * @param error reference for error-output
+ * @param checkpointOnClose true to write the content back into the file, when the database is
+ *                          closed
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::loadDatabaseIntoMemory(const std::string &path,
+                                    Kitsunemimi::ErrorContainer &error,
+                                    const bool checkpointOnClose)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
 
+    if(m_isOpen)
+    {
+        LOG_DEBUG("Database already open");
         return true;
     }
 
-    return false;
+    if(openDatabase(":memory:", SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, error) == false) {
+        return false;
+    }
+
+    // copy the file-content with one step, because nothing else can access the new database
+    sqlite3* fileDb = nullptr;
+    int rc = sqlite3_open_v2(path.c_str(),
+                             &fileDb,
+                             SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                             nullptr);
+    if(rc == SQLITE_OK)
+    {
+        sqlite3_backup* backup = sqlite3_backup_init(m_db, "main", fileDb, "main");
+        if(backup == nullptr)
+        {
+            rc = sqlite3_errcode(m_db);
+        }
+        else
+        {
+            rc = sqlite3_backup_step(backup, -1);
+            sqlite3_backup_finish(backup);
+            if(rc == SQLITE_DONE) {
+                rc = SQLITE_OK;
+            }
+        }
+    }
+    sqlite3_close(fileDb);
+
+    if(rc != SQLITE_OK)
+    {
+        error.addMeesage("Can't load database '" + path + "' into memory: "
+                         + sqlite3_errstr(rc));
+        LOG_ERROR(error);
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        m_isOpen = false;
+        return false;
+    }
+
+    m_checkpointPath = path;
+    m_checkpointOnClose = checkpointOnClose;
+
+    return true;
+}
+
+/**
+ * @brief write the content of a database, which was loaded into memory, back into its file
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the database was not loaded into memory or writing failed, else true
+ */
+bool
+SqlDatabase::checkpointToFile(Kitsunemimi::ErrorContainer &error)
+{
+    std::string checkpointPath = "";
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        checkpointPath = m_checkpointPath;
+    }
+
+    if(checkpointPath.empty())
+    {
+        error.addMeesage("database was not loaded into memory and has no file for checkpoints");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return backupDatabase(checkpointPath, error, -1);
 }
 
 /**
@@ -81,6 +316,29 @@ SqlDatabase::initDatabase(const std::string &path,
 bool
 SqlDatabase::closeDatabase()
 {
+    // finish all asynchronous requests before the connection is closed
+    stopExecutor();
+    stopMaintenance();
+    stopReplication();
+    {
+        std::lock_guard<std::mutex> guard(m_publishLock);
+        unlockPublishDirectory();
+    }
+
+    // write content of in-memory database back into its file
+    bool checkpointOnClose = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        checkpointOnClose = m_isOpen && m_checkpointOnClose;
+    }
+
+    bool checkpointSuccessful = true;
+    if(checkpointOnClose)
+    {
+        ErrorContainer error;
+        checkpointSuccessful = checkpointToFile(error);
+    }
+
     std::lock_guard<std::mutex> guard(m_lock);
 
     // check if already closed
@@ -89,30 +347,144 @@ SqlDatabase::closeDatabase()
     }
 
     // close
-    if(m_db.closeDB())
+    closeReaders();
+    if(sqlite3_close(m_db) == SQLITE_OK)
     {
+        m_db = nullptr;
         m_isOpen = false;
-        return true;
+        m_writerInTransaction = false;
+        m_checkpointPath = "";
+        m_checkpointOnClose = false;
+        m_numberOfMaintenanceRuns = 0;
+        m_vacuumedPages = 0;
+        m_walPages = -1;
+        m_replicaDirectory = "";
+        m_replicaSnapshot = "";
+        m_replicaPublishTime = 0;
+        return checkpointSuccessful;
     }
 
     return false;
 }
 
+/**
+ * @brief open the connection to the database. Must be called while m_lock is held.
+ *
+ * @param path file-path, uri or special name of the database
+ * @param flags flags for opening the database
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::openDatabase(const std::string &path,
+                          const int flags,
+                          ErrorContainer &error)
+{
+    // check if database is already open
+    if(m_isOpen)
+    {
+        LOG_DEBUG("Database already open");
+        return true;
+    }
+
+    // init database
+    if(sqlite3_open_v2(path.c_str(), &m_db, flags, nullptr) != SQLITE_OK)
+    {
+        error.addMeesage("Can't open database '" + path + "': " + sqlite3_errmsg(m_db));
+        LOG_ERROR(error);
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    // compressed columns are compressed and decompressed by sqlite while running the queries
+    if(registerCompressionFunctions(m_db) == false)
+    {
+        error.addMeesage("Can't register functions for database '" + path + "': "
+                         + sqlite3_errmsg(m_db));
+        LOG_ERROR(error);
+        sqlite3_close(m_db);
+        m_db = nullptr;
+        return false;
+    }
+
+    // taken only once, so it can be requested without waiting for the lock of the writer
+    const int maxNumberOfParameters = sqlite3_limit(m_db, SQLITE_LIMIT_VARIABLE_NUMBER, -1);
+    m_maxNumberOfParameters = static_cast<uint32_t>(std::max(maxNumberOfParameters, 1));
+
+    m_isOpen = true;
+    m_path = path;
+
+    return true;
+}
+
 /**
  * @brief execute sql-query
  *
  * @param resultTable table-pointer for the result of the query
  * @param command queuy to execute
  * @param error reference for error-output
+ * @param budget optional limit for the size of the result
  *
  * @return true, if successful, else false
  */
 bool
 SqlDatabase::execSqlCommand(TableItem* resultTable,
                             const std::string &command,
-                            ErrorContainer &error)
+                            ErrorContainer &error,
+                            ResultBudget* budget)
+{
+    return execCommand(command, resultTable, nullptr, error, budget);
+}
+
+/**
+ * @brief execute sql-query and write the result into an arena-based result-container
+ *
+ * @param resultTable reference for the result of the query
+ * @param command queuy to execute
+ * @param error reference for error-output
+ * @param budget optional limit for the size of the result
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::execSqlCommand(SqlResult &resultTable,
+                            const std::string &command,
+                            ErrorContainer &error,
+                            ResultBudget* budget)
+{
+    return execCommand(command, nullptr, &resultTable, error, budget);
+}
+
+/**
+ * @brief execute a single prepared statement, where the values of the parameters are taken from
+ *        the first row of a result-container, so they don't have to be escaped
+ *
+ * @param resultTable pointer to the result of the query, or nullptr if not required
+ * @param statement sql-statement with placeholders
+ * @param parameters result-container with one column per placeholder and one row
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::execPreparedCommand(SqlResult* resultTable,
+                                 const std::string &statement,
+                                 const SqlResult &parameters,
+                                 ErrorContainer &error)
 {
+    updateLastRequest();
+    TraceHook* hook = m_traceHook.load(std::memory_order_acquire);
+    TraceScope trace(hook,
+                     TraceSpan::QUERY_SPAN,
+                     "execPreparedCommand",
+                     "",
+                     hook == nullptr ? "" : createStatementShape(statement));
+
+    trace.startLockWait();
     std::lock_guard<std::mutex> guard(m_lock);
+    trace.stopLockWait();
 
     if(m_isOpen == false)
     {
@@ -121,9 +493,2687 @@ SqlDatabase::execSqlCommand(TableItem* resultTable,
         return false;
     }
 
-    LOG_DEBUG("run SQL-command: " + command);
+    LOG_DEBUG("run prepared SQL-command: " + statement);
+
+    sqlite3_stmt* stmt = nullptr;
+    if(sqlite3_prepare_v2(m_db, statement.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        error.addMeesage("Error while preparing sql-command: " + std::string(sqlite3_errmsg(m_db)));
+        return false;
+    }
+
+    if(checkQueryPlan(stmt, error) == false)
+    {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    if(parameters.getNumberOfRows() > 0
+            && bindRow(stmt, parameters, 0) == false)
+    {
+        error.addMeesage("Error while binding parameters: " + std::string(sqlite3_errmsg(m_db)));
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    const int64_t changesBefore = trace.isActive() ? sqlite3_total_changes64(m_db) : 0;
+    uint64_t numberOfRows = 0;
+    int rc = sqlite3_step(stmt);
+    while(rc == SQLITE_ROW)
+    {
+        if(resultTable != nullptr
+                && appendToResult(*resultTable, stmt, sqlite3_column_count(stmt), error) == false)
+        {
+            sqlite3_finalize(stmt);
+            return false;
+        }
+        numberOfRows++;
+        rc = sqlite3_step(stmt);
+    }
+    m_writerInTransaction.store(sqlite3_get_autocommit(m_db) == 0, std::memory_order_release);
+
+    if(rc != SQLITE_DONE)
+    {
+        error.addMeesage("Error while executing sql-command: " + std::string(sqlite3_errmsg(m_db)));
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    if(trace.isActive())
+    {
+        trace.addRows(getChangedRows(m_db, changesBefore), numberOfRows);
+        trace.setSuccess(true);
+    }
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+/**
+ * @brief insert multiple rows with a prepared statement within one transaction, or within the
+ *        open transaction of the caller
+ *
+ * @param statement insert-statement with one parameter per column of the rows
+ * @param rows rows to insert. Bool-values are stored as text like in all other requests.
+ * @param error reference for error-output
+ * @param rowIds optional list, where the rowids of all inserted rows are added
+ *
+ * @return true, if successful, else false and the transaction is rolled back
+ */
+bool
+SqlDatabase::insertRows(const std::string &statement,
+                        const SqlResult &rows,
+                        ErrorContainer &error,
+                        std::vector<int64_t>* rowIds)
+{
+    updateLastRequest();
+    TraceHook* hook = m_traceHook.load(std::memory_order_acquire);
+    TraceScope trace(hook,
+                     TraceSpan::QUERY_SPAN,
+                     "insertRows",
+                     "",
+                     hook == nullptr ? "" : createStatementShape(statement));
+
+    trace.startLockWait();
+    std::lock_guard<std::mutex> guard(m_lock);
+    trace.stopLockWait();
+
+    if(m_isOpen == false)
+    {
+        error.addMeesage("database not open");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    LOG_DEBUG("insert " + std::to_string(rows.getNumberOfRows()) + " rows with: " + statement);
+
+    if(beginSavepoint(error) == false) {
+        return false;
+    }
+
+    if(runRows(statement, rows, error, rowIds, trace) == false)
+    {
+        rollbackSavepoint();
+        return false;
+    }
+
+    if(releaseSavepoint(error) == false)
+    {
+        rollbackSavepoint();
+        return false;
+    }
+
+    trace.setSuccess(true);
+
+    return true;
+}
+
+/**
+ * @brief run multiple prepared statements, each for all rows of its parameters, within one
+ *        transaction, or within the open transaction of the caller
+ *
+ * @param statements list of statements
+ * @param rows list with one set of parameter-rows per statement
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false and the transaction is rolled back
+ */
+bool
+SqlDatabase::writeRows(const std::vector<std::string> &statements,
+                       const std::vector<const SqlResult*> &rows,
+                       ErrorContainer &error)
+{
+    updateLastRequest();
+    TraceHook* hook = m_traceHook.load(std::memory_order_acquire);
+    TraceScope trace(hook,
+                     TraceSpan::QUERY_SPAN,
+                     "writeRows",
+                     "",
+                     hook == nullptr || statements.empty()
+                         ? "" : createStatementShape(statements.front()));
+
+    trace.startLockWait();
+    std::lock_guard<std::mutex> guard(m_lock);
+    trace.stopLockWait();
+
+    if(m_isOpen == false)
+    {
+        error.addMeesage("database not open");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(statements.size() != rows.size())
+    {
+        error.addMeesage("number of statements doesn't match the number of parameter-sets");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(beginSavepoint(error) == false) {
+        return false;
+    }
+
+    for(uint64_t i = 0; i < statements.size(); i++)
+    {
+        if(rows.at(i)->getNumberOfRows() == 0) {
+            continue;
+        }
+
+        LOG_DEBUG("write " + std::to_string(rows.at(i)->getNumberOfRows())
+                  + " rows with: " + statements.at(i));
+        if(runRows(statements.at(i), *rows.at(i), error, nullptr, trace) == false)
+        {
+            rollbackSavepoint();
+            return false;
+        }
+    }
+
+    if(releaseSavepoint(error) == false)
+    {
+        rollbackSavepoint();
+        return false;
+    }
+
+    trace.setSuccess(true);
+
+    return true;
+}
+
+/**
+ * @brief start the executor for asynchronous requests
+ *
+ * @param numberOfReaders number of threads for reading requests. Writing requests are always
+ *                        processed by a single thread, because sqlite allows only one writer.
+ *
+ * @return false, if the executor is already running, else true
+ */
+bool
+SqlDatabase::startExecutor(const uint32_t numberOfReaders)
+{
+    std::lock_guard<std::mutex> guard(m_executorLock);
+
+    if(m_executor != nullptr) {
+        return false;
+    }
+    m_executor = new DatabaseExecutor(numberOfReaders);
+
+    return true;
+}
+
+/**
+ * @brief stop the executor for asynchronous requests. All already queued requests are finished
+ *        before this function returns.
+ */
+void
+SqlDatabase::stopExecutor()
+{
+    DatabaseExecutor* executor = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(m_executorLock);
+        executor = m_executor;
+        m_executor = nullptr;
+    }
+
+    // delete outside of the lock, because the remaining tasks are processed in the destructor
+    delete executor;
+}
+
+/**
+ * @brief publish a consistent snapshot of the database into a directory, where replicas can
+ *        take it from. The snapshot is written as new file, which is then made current by an
+ *        atomic rename of the 'current'-file, so replicas never see a half-written snapshot.
+ *        If the database was not changed since the last snapshot, only the publish-time is
+ *        updated, so the replicas know, that their content is still up-to-date. Only one
+ *        database can publish into a directory at the same time, which is ensured by a
+ *        lock-file, which is held until the database is closed.
+ *
+ * @param directory directory for the snapshots. It is created, if it doesn't exist.
+ * @param error reference for error-output
+ *
+ * @return false, if another database publishes into the directory or writing failed, else true
+ */
+bool
+SqlDatabase::publishSnapshot(const std::string &directory,
+                             ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> publishGuard(m_publishLock);
+
+    // total_changes only counts inserts, updates and deletes of the own connection, data_version
+    // is changed by commits of other connections and schema_version by changes of the schema
+    // and by restores into this database
+    int64_t changes = 0;
+    int64_t dataVersion = 0;
+    int64_t schemaVersion = 0;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        if(m_isOpen == false)
+        {
+            error.addMeesage("database not open");
+            LOG_ERROR(error);
+            return false;
+        }
+        changes = sqlite3_total_changes64(m_db);
+        if(readPragma("data_version", dataVersion, error) == false
+                || readPragma("schema_version", schemaVersion, error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    const int64_t publishTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+    const std::filesystem::path dirPath(directory);
+    std::error_code fsError;
+    std::filesystem::create_directories(dirPath, fsError);
+    if(lockPublishDirectory(directory, error) == false) {
+        return false;
+    }
+
+    // write new snapshot, if something was changed since the last one
+    std::string snapshotName = m_publishedSnapshot;
+    if(snapshotName.empty()
+            || changes != m_publishedChanges
+            || dataVersion != m_publishedDataVersion
+            || schemaVersion != m_publishedSchemaVersion)
+    {
+        // the process-id and a counter keep the name unique, when multiple databases publish
+        // into the same directory within the same millisecond
+        static std::atomic<uint64_t> publishCounter(0);
+        snapshotName = "snapshot-" + std::to_string(publishTime)
+                       + "-" + std::to_string(getpid())
+                       + "-" + std::to_string(publishCounter.fetch_add(1)) + ".db";
+        const std::string tempPath = (dirPath / (snapshotName + ".tmp")).string();
+
+        sqlite3* targetDb = nullptr;
+        bool success = sqlite3_open(tempPath.c_str(), &targetDb) == SQLITE_OK
+                       && runBackup(targetDb, nullptr, error, 100, 0, nullptr);
+
+        // replicas open the snapshot read-only, which is not possible in write-ahead-log mode
+        success = success && sqlite3_exec(targetDb,
+                                          "PRAGMA journal_mode=DELETE;",
+                                          nullptr,
+                                          nullptr,
+                                          nullptr) == SQLITE_OK;
+        sqlite3_close(targetDb);
+
+        // an incomplete snapshot must never get a name, under which replicas could find it
+        if(success) {
+            std::filesystem::rename(tempPath, dirPath / snapshotName, fsError);
+        }
+        if(success == false
+                || fsError)
+        {
+            std::filesystem::remove(tempPath, fsError);
+            error.addMeesage("Can't write snapshot into directory '" + directory + "'");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        m_publishedSnapshot = snapshotName;
+        m_publishedChanges = changes;
+        m_publishedDataVersion = dataVersion;
+        m_publishedSchemaVersion = schemaVersion;
+    }
+
+    // make snapshot current
+    const std::filesystem::path currentPath = dirPath / "current";
+    {
+        std::ofstream current(currentPath.string() + ".tmp", std::ios::trunc);
+        current << snapshotName << "\n" << publishTime << "\n";
+    }
+    std::filesystem::rename(currentPath.string() + ".tmp", currentPath, fsError);
+    if(fsError)
+    {
+        error.addMeesage("Can't publish snapshot in directory '" + directory + "': "
+                         + fsError.message());
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // remove old snapshots. The one before the current is kept, because replicas could still
+    // copy it at the moment. The snapshots are sorted by their publish-time and counter,
+    // because the numbers within the names have no fixed length.
+    std::vector<std::tuple<int64_t, uint64_t, std::filesystem::path>> oldSnapshots;
+    for(const auto &entry : std::filesystem::directory_iterator(dirPath, fsError))
+    {
+        const std::string name = entry.path().filename().string();
+        int64_t snapshotTime = 0;
+        uint64_t counter = 0;
+        if(name != snapshotName
+                && parseSnapshotName(name, snapshotTime, counter))
+        {
+            oldSnapshots.emplace_back(snapshotTime, counter, entry.path());
+        }
+    }
+    std::sort(oldSnapshots.begin(), oldSnapshots.end());
+    for(uint64_t i = 0; i + 1 < oldSnapshots.size(); i++) {
+        std::filesystem::remove(std::get<2>(oldSnapshots.at(i)), fsError);
+    }
+
+    return true;
+}
+
+/**
+ * @brief take the lock-file of a snapshot-directory. The lock is kept until the database is
+ *        closed or publishes into another directory. Must be called with the publish-lock.
+ *
+ * @param directory directory for the snapshots
+ * @param error reference for error-output
+ *
+ * @return false, if another database already publishes into the directory, else true
+ */
+bool
+SqlDatabase::lockPublishDirectory(const std::string &directory,
+                                  ErrorContainer &error)
+{
+    if(m_publishLockFd != -1
+            && m_publishDirectory == directory)
+    {
+        return true;
+    }
+
+    const std::string lockPath = (std::filesystem::path(directory) / "publisher.lock").string();
+    const int fd = open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if(fd == -1
+            || flock(fd, LOCK_EX | LOCK_NB) != 0)
+    {
+        if(fd != -1) {
+            close(fd);
+        }
+        error.addMeesage("Can't publish into directory '" + directory + "', because another "
+                         "database already publishes into it");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // the last snapshot belongs to the old directory, so the next one has to be written new
+    unlockPublishDirectory();
+    m_publishLockFd = fd;
+    m_publishDirectory = directory;
+    m_publishedSnapshot = "";
+
+    return true;
+}
+
+/**
+ * @brief release the lock-file of the snapshot-directory, if the database published into one.
+ *        Must be called with the publish-lock.
+ */
+void
+SqlDatabase::unlockPublishDirectory()
+{
+    if(m_publishLockFd == -1) {
+        return;
+    }
+
+    // closing the file releases the lock
+    close(m_publishLockFd);
+    m_publishLockFd = -1;
+    m_publishDirectory = "";
+}
+
+/**
+ * @brief start a background-thread, which publishes a snapshot of the database after each
+ *        interval
+ *
+ * @param directory directory for the snapshots
+ * @param interval time in milliseconds between two snapshots
+ *
+ * @return false, if the replication is already running, else true
+ */
+bool
+SqlDatabase::startPublishing(const std::string &directory,
+                             const uint32_t interval)
+{
+    return startReplication(directory, interval, false);
+}
+
+/**
+ * @brief initialize the database as local read-replica of another database. The replica is an
+ *        own file, which is overwritten with the current snapshot of the primary database, each
+ *        time it is refreshed. It should only be used for read-requests, because changes are
+ *        lost with the next refresh.
+ *
+ * @param directory directory, where the primary database publishes its snapshots
+ * @param path file-path of the replica
+ * @param error reference for error-output
+ * @param refreshInterval time in milliseconds between two refreshes. 0 to refresh only
+ *                        manually with refreshReplica.
+ * @param numberOfReaders number of read-only connections of the replica. Default is 0 like for
+ *                        initDatabase, so the replica uses only a single connection.
+ *
+ * @return false, if the replica-file could not be opened, else true. It is no error, if no
+ *         snapshot was published yet.
+ */
+bool
+SqlDatabase::initReplica(const std::string &directory,
+                         const std::string &path,
+                         ErrorContainer &error,
+                         const uint32_t refreshInterval,
+                         const uint32_t numberOfReaders)
+{
+    if(initDatabase(path, error, numberOfReaders) == false) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_replicaDirectory = directory;
+    }
+
+    ErrorContainer refreshError;
+    refreshReplica(refreshError);
+
+    if(refreshInterval > 0) {
+        startReplication(directory, refreshInterval, true);
+    }
+
+    return true;
+}
+
+/**
+ * @brief overwrite the replica with the current snapshot of the primary database. The readers
+ *        of the replica are not blocked and see the new content after the refresh.
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if the database is not a replica, no snapshot is published or copying failed,
+ *         else true
+ */
+bool
+SqlDatabase::refreshReplica(ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_isOpen == false
+            || m_replicaDirectory.empty())
+    {
+        error.addMeesage("database is not open as replica");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    const std::filesystem::path dirPath(m_replicaDirectory);
+    std::string snapshotName = "";
+    int64_t publishTime = 0;
+    {
+        std::ifstream current((dirPath / "current").string());
+        current >> snapshotName >> publishTime;
+    }
+    if(snapshotName.empty()
+            || publishTime == 0)
+    {
+        error.addMeesage("no snapshot published in directory '" + m_replicaDirectory + "'");
+        return false;
+    }
+
+    // copy the content only, if there is a new snapshot
+    if(snapshotName != m_replicaSnapshot)
+    {
+        const std::string snapshotPath = (dirPath / snapshotName).string();
+        sqlite3* sourceDb = nullptr;
+        int rc = sqlite3_open_v2(snapshotPath.c_str(), &sourceDb, SQLITE_OPEN_READONLY, nullptr);
+        if(rc == SQLITE_OK)
+        {
+            sqlite3_backup* backup = sqlite3_backup_init(m_db, "main", sourceDb, "main");
+            if(backup == nullptr)
+            {
+                rc = sqlite3_errcode(m_db);
+            }
+            else
+            {
+                rc = sqlite3_backup_step(backup, -1);
+                sqlite3_backup_finish(backup);
+                if(rc == SQLITE_DONE) {
+                    rc = SQLITE_OK;
+                }
+            }
+        }
+        sqlite3_close(sourceDb);
+
+        if(rc != SQLITE_OK)
+        {
+            error.addMeesage("Can't refresh replica from snapshot '" + snapshotPath + "': "
+                             + sqlite3_errstr(rc));
+            LOG_ERROR(error);
+            return false;
+        }
+        m_replicaSnapshot = snapshotName;
+    }
+    m_replicaPublishTime = publishTime;
+
+    return true;
+}
+
+/**
+ * @brief get the age of the content of the replica
+ *
+ * @return -1, if the database is not a replica or has no snapshot yet, else time in
+ *         milliseconds since the snapshot of the replica was published
+ */
+long
+SqlDatabase::getReplicaStaleness()
+{
+    const int64_t publishTime = m_replicaPublishTime.load();
+    if(publishTime == 0) {
+        return -1;
+    }
+
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+
+    return static_cast<long>(std::max(now - publishTime, static_cast<int64_t>(0)));
+}
+
+/**
+ * @brief stop the background-thread for publishing snapshots or refreshing the replica
+ */
+void
+SqlDatabase::stopReplication()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_replicationLock);
+        if(m_replication.joinable() == false) {
+            return;
+        }
+        m_replicationAbort = true;
+    }
+    m_replicationWakeup.notify_all();
+
+    m_replication.join();
+}
+
+/**
+ * @brief start a background-thread for the maintenance of the database. After each interval it
+ *        waits until there were no requests for some time and then runs one time-boxed
+ *        maintenance, like runMaintenance.
+ *
+ * @param interval time in milliseconds between two maintenance-runs
+ * @param idleTime time in milliseconds without requests, before the maintenance starts
+ * @param maxDuration maximum time in milliseconds for the incremental vacuum of one run
+ * @param pagesPerStep number of pages, which are given back to the file-system with one step
+ *
+ * @return false, if the maintenance is already running, else true
+ */
+bool
+SqlDatabase::startMaintenance(const uint32_t interval,
+                              const uint32_t idleTime,
+                              const uint32_t maxDuration,
+                              const uint32_t pagesPerStep)
+{
+    std::lock_guard<std::mutex> guard(m_maintenanceLock);
+
+    if(m_maintenance.joinable()) {
+        return false;
+    }
+
+    m_maintenanceAbort = false;
+    m_maintenance = std::thread(&SqlDatabase::runMaintenanceLoop,
+                                this,
+                                interval,
+                                idleTime,
+                                maxDuration,
+                                pagesPerStep);
+
+    return true;
+}
+
+/**
+ * @brief stop the background-thread for the maintenance of the database
+ */
+void
+SqlDatabase::stopMaintenance()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_maintenanceLock);
+        if(m_maintenance.joinable() == false) {
+            return;
+        }
+        m_maintenanceAbort = true;
+    }
+    m_maintenanceWakeup.notify_all();
+
+    m_maintenance.join();
+}
+
+/**
+ * @brief run one maintenance of the database. The statistics of the query-planner are updated
+ *        with 'PRAGMA optimize', free pages are given back to the file-system with incremental
+ *        vacuum and the write-ahead-log is written back into the database-file. The vacuum is
+ *        done in small steps and the lock is released between the steps, so other requests are
+ *        not blocked for a long time.
+ *
+ * @param error reference for error-output
+ * @param maxDuration maximum time in milliseconds for the incremental vacuum. Free pages are
+ *                    only given back, if the database was initialized with incrementalVacuum.
+ *                    The vacuum is continued by the next run, if there are still free pages.
+ * @param pagesPerStep number of pages, which are given back to the file-system with one step
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::runMaintenance(ErrorContainer &error,
+                            const uint32_t maxDuration,
+                            const uint32_t pagesPerStep)
+{
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    const std::string vacuumStep = "PRAGMA incremental_vacuum("
+                                   + std::to_string(std::max(pagesPerStep, 1u)) + ");";
+
+    // update statistics of the query-planner. The analysis-limit keeps the time for big tables
+    // short, because only a part of each index is analyzed.
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        if(m_isOpen == false)
+        {
+            error.addMeesage("database not open");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        if(sqlite3_exec(m_db,
+                        "PRAGMA analysis_limit=400; PRAGMA optimize;",
+                        nullptr,
+                        nullptr,
+                        nullptr) != SQLITE_OK)
+        {
+            error.addMeesage("Error while optimizing database: "
+                             + std::string(sqlite3_errmsg(m_db)));
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    // give free pages back to the file-system
+    while(true)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+
+        int64_t autoVacuum = 0;
+        int64_t freelistCount = 0;
+        if(m_isOpen == false
+                || readPragma("auto_vacuum", autoVacuum, error) == false
+                || readPragma("freelist_count", freelistCount, error) == false)
+        {
+            error.addMeesage("Error while reading free pages of database");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        // 2 is the incremental mode
+        if(autoVacuum != 2
+                || freelistCount == 0)
+        {
+            break;
+        }
+
+        if(sqlite3_exec(m_db, vacuumStep.c_str(), nullptr, nullptr, nullptr) != SQLITE_OK)
+        {
+            error.addMeesage("Error while vacuum of database: "
+                             + std::string(sqlite3_errmsg(m_db)));
+            LOG_ERROR(error);
+            return false;
+        }
+        m_vacuumedPages += std::min(static_cast<uint64_t>(freelistCount),
+                                    static_cast<uint64_t>(std::max(pagesPerStep, 1u)));
+
+        if(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(maxDuration)) {
+            break;
+        }
+    }
+
+    // write the write-ahead-log back into the database-file without waiting for readers
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_isOpen == false)
+    {
+        error.addMeesage("database not open");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    int walPages = -1;
+    int checkpointedPages = -1;
+    if(sqlite3_wal_checkpoint_v2(m_db,
+                                 nullptr,
+                                 SQLITE_CHECKPOINT_PASSIVE,
+                                 &walPages,
+                                 &checkpointedPages) != SQLITE_OK)
+    {
+        error.addMeesage("Error while checkpoint of database: "
+                         + std::string(sqlite3_errmsg(m_db)));
+        LOG_ERROR(error);
+        return false;
+    }
+    m_walPages = walPages;
+    m_numberOfMaintenanceRuns++;
+
+    return true;
+}
+
+/**
+ * @brief get size- and fragmentation-metrics of the database and the statistics of the
+ *        maintenance
+ *
+ * @param stats reference for the output
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::getMaintenanceStats(MaintenanceStats &stats,
+                                 ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_isOpen == false)
+    {
+        error.addMeesage("database not open");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    int64_t pageSize = 0;
+    int64_t pageCount = 0;
+    int64_t freelistCount = 0;
+    int64_t autoVacuum = 0;
+    if(readPragma("page_size", pageSize, error) == false
+            || readPragma("page_count", pageCount, error) == false
+            || readPragma("freelist_count", freelistCount, error) == false
+            || readPragma("auto_vacuum", autoVacuum, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    stats.pageSize = static_cast<uint64_t>(pageSize);
+    stats.pageCount = static_cast<uint64_t>(pageCount);
+    stats.freelistCount = static_cast<uint64_t>(freelistCount);
+    stats.fragmentation = 0.0;
+    if(pageCount > 0) {
+        stats.fragmentation = static_cast<double>(freelistCount) / static_cast<double>(pageCount);
+    }
+    stats.incrementalVacuum = autoVacuum == 2;
+    stats.walPages = m_walPages;
+    stats.numberOfRuns = m_numberOfMaintenanceRuns;
+    stats.vacuumedPages = m_vacuumedPages;
+
+    return true;
+}
+
+/**
+ * @brief add a task to the executor for asynchronous requests
+ *
+ * @param type READ_TASK for tasks, which only read, WRITE_TASK for all other tasks
+ * @param task task to execute
+ *
+ * @return false, if the executor is not running, else true
+ */
+bool
+SqlDatabase::postTask(const DatabaseExecutor::TaskType type,
+                      DatabaseExecutor::Task task)
+{
+    std::lock_guard<std::mutex> guard(m_executorLock);
+
+    if(m_executor == nullptr) {
+        return false;
+    }
+
+    return m_executor->post(type, task);
+}
+
+/**
+ * @brief set the default-limit for the results of read-operations of the tables of the database.
+ *        Tables with their own limit use their own one. Direct requests with execSqlCommand are
+ *        not limited.
+ *
+ * @param limit new limit. A limit of 0 rows and 0 bytes disables the limit.
+ */
+void
+SqlDatabase::setResultLimit(const ResultLimit &limit)
+{
+    std::lock_guard<std::mutex> guard(m_resultLimitLock);
+    m_resultLimit = limit;
+}
+
+/**
+ * @brief get the maximum number of parameters of one statement, which is allowed by sqlite.
+ *        Older builds of sqlite allow only 999 parameters.
+ *
+ * @return maximum number of parameters
+ */
+uint32_t
+SqlDatabase::getMaxNumberOfParameters()
+{
+    return m_maxNumberOfParameters.load(std::memory_order_relaxed);
+}
+
+/**
+ * @brief get the default-limit for the results of read-operations of the tables
+ *
+ * @return current limit
+ */
+const SqlDatabase::ResultLimit
+SqlDatabase::getResultLimit()
+{
+    std::lock_guard<std::mutex> guard(m_resultLimitLock);
+    return m_resultLimit;
+}
+
+/**
+ * @brief set a hook, which is called at the start and the end of each request of the database
+ *        and of each operation of its tables. Without hook, tracing costs only one atomic load per
+ *        request.
+ *
+ * @param hook new hook, or nullptr to disable tracing. The hook is not owned by the database and
+ *             has to exist, until it is replaced and all running requests are finished.
+ */
+void
+SqlDatabase::setTraceHook(TraceHook* hook)
+{
+    m_traceHook.store(hook, std::memory_order_release);
+}
+
+/**
+ * @brief get the current trace-hook
+ *
+ * @return current hook, or nullptr if tracing is disabled
+ */
+TraceHook*
+SqlDatabase::getTraceHook()
+{
+    return m_traceHook.load(std::memory_order_acquire);
+}
+
+/**
+ * @brief configure the inspection of query-plans. If enabled, the plan of each distinct statement
+ *        is requested once with EXPLAIN QUERY PLAN and recorded. Literal values are replaced by
+ *        placeholders, so statements, which only differ in their values, share the same entry.
+ *
+ * @param mode NO_PLAN_CHECK to disable, RECORD_PLANS to only record the plans, WARN_ON_SCAN to log
+ *             a warning and FAIL_ON_SCAN to let the request fail, when a hot filtered request
+ *             does a full table-scan. FAIL_ON_SCAN only fails in debug-builds and is handled like
+ *             WARN_ON_SCAN when build with NDEBUG.
+ * @param hotQueryThreshold number of calls of a statement, after which the statement is hot
+ */
+void
+SqlDatabase::setPlanCheck(const PlanCheckMode mode,
+                          const uint64_t hotQueryThreshold)
+{
+    std::lock_guard<std::mutex> guard(m_planLock);
+
+    m_planCheckMode = mode;
+    m_hotQueryThreshold = hotQueryThreshold;
+}
+
+/**
+ * @brief get all recorded query-plans
+ *
+ * @return list with one entry per distinct statement
+ */
+const std::vector<SqlDatabase::QueryPlan>
+SqlDatabase::getQueryPlans()
+{
+    std::lock_guard<std::mutex> guard(m_planLock);
+
+    std::vector<QueryPlan> result;
+    for(const auto &entry : m_queryPlans) {
+        result.push_back(entry.second);
+    }
+
+    return result;
+}
+
+/**
+ * @brief remove all recorded query-plans
+ */
+void
+SqlDatabase::clearQueryPlans()
+{
+    std::lock_guard<std::mutex> guard(m_planLock);
+    m_queryPlans.clear();
+}
+
+/**
+ * @brief request the query-plan of a single statement without running the statement
+ *
+ * @param statement sql-statement to explain
+ * @param plan reference for the output
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::explainQuery(const std::string &statement,
+                          QueryPlan &plan,
+                          ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_isOpen == false)
+    {
+        error.addMeesage("database not open");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    plan = QueryPlan();
+    plan.statement = createStatementShape(statement);
+    if(runExplain(m_db, statement, plan, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief create an online-backup of the database into a file. The database is copied in small
+ *        steps and the lock is released between the steps, so other requests are not blocked
+ *        for the whole backup. Changes of the database while the backup is running are included
+ *        in the backup, so the result is always a consistent state of the database.
+ *
+ * @param targetPath path of the backup-file. Existing files will be overwritten.
+ * @param error reference for error-output
+ * @param pagesPerStep number of database-pages to copy within one step. -1 to copy all at once.
+ * @param pauseBetweenSteps time in milliseconds to wait between two steps
+ * @param progressCallback optional callback, which is called after each step
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::backupDatabase(const std::string &targetPath,
+                            ErrorContainer &error,
+                            const int pagesPerStep,
+                            const uint32_t pauseBetweenSteps,
+                            BackupCallback progressCallback)
+{
+    sqlite3* targetDb = nullptr;
+    if(sqlite3_open(targetPath.c_str(), &targetDb) != SQLITE_OK)
+    {
+        error.addMeesage("Can't open backup-file '" + targetPath + "': "
+                         + sqlite3_errmsg(targetDb));
+        LOG_ERROR(error);
+        sqlite3_close(targetDb);
+        return false;
+    }
+
+    const bool result = runBackup(targetDb,
+                                  nullptr,
+                                  error,
+                                  pagesPerStep,
+                                  pauseBetweenSteps,
+                                  progressCallback);
+    sqlite3_close(targetDb);
+
+    if(result == false)
+    {
+        error.addMeesage("backup into file '" + targetPath + "' failed");
+        LOG_ERROR(error);
+    }
+
+    return result;
+}
+
+/**
+ * @brief create an online-backup of the database into another open database, for example to
+ *        have a consistent snapshot for read-only requests. The existing content of the target
+ *        will be replaced.
+ *
+ * @param target database, which should be overwritten with the content of this database
+ * @param error reference for error-output
+ * @param pagesPerStep number of database-pages to copy within one step. -1 to copy all at once.
+ * @param pauseBetweenSteps time in milliseconds to wait between two steps
+ * @param progressCallback optional callback, which is called after each step
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::backupDatabase(SqlDatabase &target,
+                            ErrorContainer &error,
+                            const int pagesPerStep,
+                            const uint32_t pauseBetweenSteps,
+                            BackupCallback progressCallback)
+{
+    if(&target == this)
+    {
+        error.addMeesage("database can not be backuped into itself");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    sqlite3* targetDb = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(target.m_lock);
+        if(target.m_isOpen == false)
+        {
+            error.addMeesage("target-database of the backup is not open");
+            LOG_ERROR(error);
+            return false;
+        }
+        targetDb = target.m_db;
+    }
+
+    const bool result = runBackup(targetDb,
+                                  &target.m_lock,
+                                  error,
+                                  pagesPerStep,
+                                  pauseBetweenSteps,
+                                  progressCallback);
+    if(result == false)
+    {
+        error.addMeesage("backup into database '" + target.m_path + "' failed");
+        LOG_ERROR(error);
+    }
+
+    return result;
+}
+
+/**
+ * @brief get the size of a blob
+ *
+ * @param tableName name of the table
+ * @param columnName name of the blob-column
+ * @param rowId rowid of the row with the blob
+ * @param error reference for error-output
+ *
+ * @return -1 if the blob can not be opened, else size of the blob in bytes
+ */
+long
+SqlDatabase::getBlobSize(const std::string &tableName,
+                         const std::string &columnName,
+                         const int64_t rowId,
+                         ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    sqlite3_blob* blob = openBlob(tableName, columnName, rowId, false, error);
+    if(blob == nullptr) {
+        return -1;
+    }
+
+    const long size = sqlite3_blob_bytes(blob);
+    sqlite3_blob_close(blob);
+
+    return size;
+}
+
+/**
+ * @brief read a blob in chunks without loading the complete blob into memory. The lock is only
+ *        held while reading a chunk and released while the callback is running. If the row is
+ *        changed while reading, the read is aborted with an error.
+ *
+ * @param tableName name of the table
+ * @param columnName name of the blob-column
+ * @param rowId rowid of the row with the blob
+ * @param readCallback callback, which is called for each chunk. Returning false aborts the read.
+ * @param error reference for error-output
+ * @param chunkSize maximum number of bytes per chunk
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::readBlob(const std::string &tableName,
+                      const std::string &columnName,
+                      const int64_t rowId,
+                      BlobReadCallback readCallback,
+                      ErrorContainer &error,
+                      const uint64_t chunkSize)
+{
+    if(chunkSize == 0)
+    {
+        error.addMeesage("chunk-size for reading blob must be greater than 0");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    std::unique_lock<std::mutex> guard(m_lock);
+
+    sqlite3_blob* blob = openBlob(tableName, columnName, rowId, false, error);
+    if(blob == nullptr) {
+        return false;
+    }
+
+    const uint64_t blobSize = static_cast<uint64_t>(sqlite3_blob_bytes(blob));
+    std::vector<uint8_t> buffer(std::min(chunkSize, blobSize));
+    uint64_t pos = 0;
+
+    while(pos < blobSize)
+    {
+        const uint64_t size = std::min(chunkSize, blobSize - pos);
+        const int rc = sqlite3_blob_read(blob,
+                                         buffer.data(),
+                                         static_cast<int>(size),
+                                         static_cast<int>(pos));
+        if(rc != SQLITE_OK)
+        {
+            error.addMeesage("Error while reading blob: " + std::string(sqlite3_errstr(rc)));
+            LOG_ERROR(error);
+            sqlite3_blob_close(blob);
+            return false;
+        }
+        pos += size;
+
+        // call the callback without holding the lock
+        guard.unlock();
+        const bool proceed = readCallback(buffer.data(), size);
+        guard.lock();
+
+        if(proceed == false)
+        {
+            error.addMeesage("reading blob was aborted by the callback");
+            sqlite3_blob_close(blob);
+            return false;
+        }
+    }
+
+    sqlite3_blob_close(blob);
+
+    return true;
+}
+
+/**
+ * @brief write a blob in chunks without holding the complete blob in memory. The blob is resized
+ *        to the new size and filled within one transaction, or within a savepoint of the open
+ *        transaction of the caller, so the row never contains a partly written blob. The lock is
+ *        held for the whole write, so the callback is not allowed to access the same database.
+ *
+ * @param tableName name of the table
+ * @param columnName name of the blob-column
+ * @param rowId rowid of the row with the blob
+ * @param blobSize total size of the new blob in bytes
+ * @param writeCallback callback to fill the next chunk. It gets a buffer and the size of the chunk
+ *                      and has to return the number of bytes written into the buffer.
+ * @param error reference for error-output
+ * @param chunkSize maximum number of bytes per chunk
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::writeBlob(const std::string &tableName,
+                       const std::string &columnName,
+                       const int64_t rowId,
+                       const uint64_t blobSize,
+                       BlobWriteCallback writeCallback,
+                       ErrorContainer &error,
+                       const uint64_t chunkSize)
+{
+    if(chunkSize == 0)
+    {
+        error.addMeesage("chunk-size for writing blob must be greater than 0");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_isOpen == false)
+    {
+        error.addMeesage("database not open");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(beginSavepoint(error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // resize blob, because the incremental blob-io can not change the size of a blob
+    const std::string resizeCommand = "UPDATE " + tableName
+                                      + " SET " + columnName + "=zeroblob(?) WHERE rowid=?;";
+    sqlite3_stmt* stmt = nullptr;
+    bool success = sqlite3_prepare_v2(m_db, resizeCommand.c_str(), -1, &stmt, nullptr) == SQLITE_OK
+                   && sqlite3_bind_int64(stmt, 1, static_cast<sqlite3_int64>(blobSize)) == SQLITE_OK
+                   && sqlite3_bind_int64(stmt, 2, rowId) == SQLITE_OK
+                   && sqlite3_step(stmt) == SQLITE_DONE;
+    if(success == false) {
+        error.addMeesage("Error while resizing blob: " + std::string(sqlite3_errmsg(m_db)));
+    }
+    sqlite3_finalize(stmt);
+
+    sqlite3_blob* blob = nullptr;
+    if(success)
+    {
+        blob = openBlob(tableName, columnName, rowId, true, error);
+        success = blob != nullptr;
+    }
+
+    // fill blob chunk by chunk
+    std::vector<uint8_t> buffer(std::min(chunkSize, blobSize));
+    uint64_t pos = 0;
+    while(success
+          && pos < blobSize)
+    {
+        const uint64_t size = std::min(chunkSize, blobSize - pos);
+        const long written = writeCallback(buffer.data(), size);
+        if(written <= 0
+                || static_cast<uint64_t>(written) > size)
+        {
+            error.addMeesage("callback delivered no valid data for the blob at position "
+                             + std::to_string(pos));
+            success = false;
+            break;
+        }
+
+        const int rc = sqlite3_blob_write(blob,
+                                          buffer.data(),
+                                          static_cast<int>(written),
+                                          static_cast<int>(pos));
+        if(rc != SQLITE_OK)
+        {
+            error.addMeesage("Error while writing blob: " + std::string(sqlite3_errstr(rc)));
+            success = false;
+            break;
+        }
+        pos += static_cast<uint64_t>(written);
+    }
+
+    if(blob != nullptr) {
+        sqlite3_blob_close(blob);
+    }
+
+    if(success == false
+            || releaseSavepoint(error) == false)
+    {
+        rollbackSavepoint();
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief copy the database step by step into a target-database
+ *
+ * @param targetDb connection to the target-database
+ * @param targetLock lock of the target-database, or nullptr if the target is not shared
+ * @param error reference for error-output
+ * @param pagesPerStep number of database-pages to copy within one step
+ * @param pauseBetweenSteps time in milliseconds to wait between two steps
+ * @param progressCallback optional callback, which is called after each step
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::runBackup(sqlite3* targetDb,
+                       std::mutex* targetLock,
+                       ErrorContainer &error,
+                       const int pagesPerStep,
+                       const uint32_t pauseBetweenSteps,
+                       BackupCallback progressCallback)
+{
+    std::unique_lock<std::mutex> sourceGuard(m_lock, std::defer_lock);
+    std::unique_lock<std::mutex> targetGuard;
+    if(targetLock != nullptr) {
+        targetGuard = std::unique_lock<std::mutex>(*targetLock, std::defer_lock);
+    }
+
+    // lock source and target together to avoid dead-locks with backups in the other direction
+    auto lockBoth = [&]() {
+        if(targetLock != nullptr) {
+            std::lock(sourceGuard, targetGuard);
+        } else {
+            sourceGuard.lock();
+        }
+    };
+    auto unlockBoth = [&]() {
+        sourceGuard.unlock();
+        if(targetLock != nullptr) {
+            targetGuard.unlock();
+        }
+    };
+
+    lockBoth();
+    if(m_isOpen == false)
+    {
+        unlockBoth();
+        error.addMeesage("database not open");
+        return false;
+    }
+
+    sqlite3_backup* backup = sqlite3_backup_init(targetDb, "main", m_db, "main");
+    if(backup == nullptr)
+    {
+        error.addMeesage("Error while initializing backup: "
+                         + std::string(sqlite3_errmsg(targetDb)));
+        unlockBoth();
+        return false;
+    }
+    unlockBoth();
+
+    // give up after around 5 seconds, like the busy-timeout of the connections
+    const uint32_t maxBusyRetries = 500;
+    const uint32_t busyPause = 10;
+    uint32_t numberOfBusySteps = 0;
+
+    int rc = SQLITE_OK;
+    while(rc == SQLITE_OK
+          || rc == SQLITE_BUSY
+          || rc == SQLITE_LOCKED)
+    {
+        lockBoth();
+        rc = sqlite3_backup_step(backup, pagesPerStep);
+        const int remaining = sqlite3_backup_remaining(backup);
+        const int total = sqlite3_backup_pagecount(backup);
+        unlockBoth();
+
+        if(progressCallback) {
+            progressCallback(remaining, total);
+        }
+
+        if(rc == SQLITE_BUSY
+                || rc == SQLITE_LOCKED)
+        {
+            // another connection holds a lock, so wait a bit, but not forever
+            numberOfBusySteps++;
+            if(numberOfBusySteps > maxBusyRetries) {
+                break;
+            }
+            sqlite3_sleep(static_cast<int>(std::max(pauseBetweenSteps, busyPause)));
+            continue;
+        }
+        numberOfBusySteps = 0;
+
+        if(rc != SQLITE_DONE
+                && pauseBetweenSteps > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(pauseBetweenSteps));
+        }
+    }
+
+    lockBoth();
+    sqlite3_backup_finish(backup);
+    unlockBoth();
+
+    if(rc != SQLITE_DONE)
+    {
+        error.addMeesage("Error while running backup: " + std::string(sqlite3_errstr(rc)));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief start a savepoint for a group of writes. Without open transaction it starts a new one,
+ *        else it is nested into the transaction of the caller, so the writes can be rolled back
+ *        without ending the transaction of the caller. Must be called while m_lock is held.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::beginSavepoint(ErrorContainer &error)
+{
+    if(sqlite3_exec(m_db, "SAVEPOINT sakura_write;", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        error.addMeesage("Error while starting transaction: " + std::string(sqlite3_errmsg(m_db)));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief release the savepoint of beginSavepoint. This commits the writes, if there is no
+ *        transaction of the caller around it. Must be called while m_lock is held.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::releaseSavepoint(ErrorContainer &error)
+{
+    if(sqlite3_exec(m_db, "RELEASE sakura_write;", nullptr, nullptr, nullptr) != SQLITE_OK)
+    {
+        error.addMeesage("Error while commiting transaction: " + std::string(sqlite3_errmsg(m_db)));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief roll back all writes since beginSavepoint and remove the savepoint. A transaction of the
+ *        caller stays open. Must be called while m_lock is held.
+ */
+void
+SqlDatabase::rollbackSavepoint()
+{
+    sqlite3_exec(m_db,
+                 "ROLLBACK TO sakura_write; RELEASE sakura_write;",
+                 nullptr,
+                 nullptr,
+                 nullptr);
+}
+
+/**
+ * @brief run a prepared statement for each row of the parameters. Must be called while m_lock is
+ *        held and within a transaction.
+ *
+ * @param statement statement with one parameter per column of the rows
+ * @param rows parameter-rows
+ * @param error reference for error-output
+ * @param rowIds optional list, where the rowids of all inserted rows are added
+ * @param trace span of the request for the number of changed rows
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::runRows(const std::string &statement,
+                     const SqlResult &rows,
+                     ErrorContainer &error,
+                     std::vector<int64_t>* rowIds,
+                     TraceScope &trace)
+{
+    sqlite3_stmt* stmt = nullptr;
+    if(sqlite3_prepare_v2(m_db, statement.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        error.addMeesage("Error while preparing sql-command: " + std::string(sqlite3_errmsg(m_db)));
+        return false;
+    }
+
+    for(uint64_t row = 0; row < rows.getNumberOfRows(); row++)
+    {
+        if(bindRow(stmt, rows, row) == false
+                || sqlite3_step(stmt) != SQLITE_DONE)
+        {
+            error.addMeesage("Error while writing row "
+                             + std::to_string(row)
+                             + ": "
+                             + std::string(sqlite3_errmsg(m_db)));
+            sqlite3_finalize(stmt);
+            return false;
+        }
+        sqlite3_reset(stmt);
+
+        if(rowIds != nullptr) {
+            rowIds->push_back(sqlite3_last_insert_rowid(m_db));
+        }
+        if(trace.isActive()) {
+            trace.addRows(static_cast<uint64_t>(sqlite3_changes64(m_db)), 0);
+        }
+    }
+
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+/**
+ * @brief loop of the maintenance-thread
+ *
+ * @param interval time in milliseconds between two maintenance-runs
+ * @param idleTime time in milliseconds without requests, before the maintenance starts
+ * @param maxDuration maximum time in milliseconds for the incremental vacuum of one run
+ * @param pagesPerStep number of pages, which are given back to the file-system with one step
+ */
+void
+SqlDatabase::runMaintenanceLoop(const uint32_t interval,
+                                const uint32_t idleTime,
+                                const uint32_t maxDuration,
+                                const uint32_t pagesPerStep)
+{
+    std::unique_lock<std::mutex> guard(m_maintenanceLock);
+
+    while(m_maintenanceAbort == false)
+    {
+        m_maintenanceWakeup.wait_for(guard,
+                                     std::chrono::milliseconds(interval),
+                                     [this] { return m_maintenanceAbort; });
+
+        // wait until there were no requests for the idle-time
+        while(m_maintenanceAbort == false)
+        {
+            const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now().time_since_epoch()).count();
+            const int64_t idle = now - m_lastRequest.load();
+            if(idle >= static_cast<int64_t>(idleTime)) {
+                break;
+            }
+            m_maintenanceWakeup.wait_for(guard,
+                                         std::chrono::milliseconds(idleTime - idle),
+                                         [this] { return m_maintenanceAbort; });
+        }
+        if(m_maintenanceAbort) {
+            break;
+        }
+
+        guard.unlock();
+        ErrorContainer error;
+        runMaintenance(error, maxDuration, pagesPerStep);
+        guard.lock();
+    }
+}
+
+/**
+ * @brief start the background-thread for the replication
+ *
+ * @param directory directory for the snapshots
+ * @param interval time in milliseconds between two publishes or refreshes
+ * @param isReplica true to refresh the replica, false to publish snapshots
+ *
+ * @return false, if the replication is already running, else true
+ */
+bool
+SqlDatabase::startReplication(const std::string &directory,
+                              const uint32_t interval,
+                              const bool isReplica)
+{
+    std::lock_guard<std::mutex> guard(m_replicationLock);
+
+    if(m_replication.joinable()) {
+        return false;
+    }
+
+    m_replicationAbort = false;
+    m_replication = std::thread(&SqlDatabase::runReplicationLoop,
+                                this,
+                                directory,
+                                interval,
+                                isReplica);
+
+    return true;
+}
+
+/**
+ * @brief loop of the replication-thread
+ *
+ * @param directory directory for the snapshots
+ * @param interval time in milliseconds between two publishes or refreshes
+ * @param isReplica true to refresh the replica, false to publish snapshots
+ */
+void
+SqlDatabase::runReplicationLoop(const std::string directory,
+                                const uint32_t interval,
+                                const bool isReplica)
+{
+    std::unique_lock<std::mutex> guard(m_replicationLock);
+
+    while(m_replicationAbort == false)
+    {
+        guard.unlock();
+
+        ErrorContainer error;
+        if(isReplica) {
+            refreshReplica(error);
+        } else {
+            publishSnapshot(directory, error);
+        }
+
+        guard.lock();
+        m_replicationWakeup.wait_for(guard,
+                                     std::chrono::milliseconds(interval),
+                                     [this] { return m_replicationAbort; });
+    }
+}
+
+/**
+ * @brief read the value of a pragma with an integer-value. Must be called while m_lock is held.
+ *
+ * @param name name of the pragma
+ * @param value reference for the output
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::readPragma(const std::string &name,
+                        int64_t &value,
+                        ErrorContainer &error)
+{
+    const std::string command = "PRAGMA " + name + ";";
+    sqlite3_stmt* stmt = nullptr;
+    if(sqlite3_prepare_v2(m_db, command.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        error.addMeesage("Error while reading pragma '" + name + "': "
+                         + std::string(sqlite3_errmsg(m_db)));
+        return false;
+    }
+
+    const bool success = sqlite3_step(stmt) == SQLITE_ROW;
+    if(success) {
+        value = sqlite3_column_int64(stmt, 0);
+    } else {
+        error.addMeesage("Error while reading pragma '" + name + "': "
+                         + std::string(sqlite3_errmsg(m_db)));
+    }
+    sqlite3_finalize(stmt);
+
+    return success;
+}
+
+/**
+ * @brief remember the time of the last request, so the maintenance only runs, while the
+ *        database is idle
+ */
+void
+SqlDatabase::updateLastRequest()
+{
+    m_lastRequest = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief bind all values of a row to the parameters of a prepared statement
+ *
+ * @param stmt prepared statement
+ * @param rows result with the values
+ * @param row index of the row to bind
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::bindRow(sqlite3_stmt* stmt,
+                     const SqlResult &rows,
+                     const uint64_t row)
+{
+    for(uint64_t col = 0; col < rows.getNumberOfColumns(); col++)
+    {
+        const int pos = static_cast<int>(col) + 1;
+        int rc = SQLITE_OK;
+
+        switch(rows.getType(row, col))
+        {
+            case SqlResult::STRING_VALUE:
+            {
+                const std::string_view value = rows.getString(row, col);
+                rc = sqlite3_bind_text(stmt, pos, value.data(), value.size(), SQLITE_STATIC);
+                break;
+            }
+            case SqlResult::INT_VALUE:
+                rc = sqlite3_bind_int64(stmt, pos, rows.getInt(row, col));
+                break;
+            case SqlResult::FLOAT_VALUE:
+                rc = sqlite3_bind_double(stmt, pos, rows.getFloat(row, col));
+                break;
+            case SqlResult::BOOL_VALUE:
+                if(rows.getBool(row, col)) {
+                    rc = sqlite3_bind_text(stmt, pos, "true", 4, SQLITE_STATIC);
+                } else {
+                    rc = sqlite3_bind_text(stmt, pos, "false", 5, SQLITE_STATIC);
+                }
+                break;
+            default:
+                rc = sqlite3_bind_null(stmt, pos);
+                break;
+        }
+
+        if(rc != SQLITE_OK) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief record the query-plan of a statement and check it for full table-scans, if enabled.
+ *        Must be called by the thread, which currently owns the connection of the statement.
+ *
+ * @param stmt prepared statement, which should be checked
+ * @param error reference for error-output
+ *
+ * @return false, if the plan could not be requested or the statement is not allowed to run
+ *         because of a full table-scan, else true
+ */
+bool
+SqlDatabase::checkQueryPlan(sqlite3_stmt* stmt,
+                            ErrorContainer &error)
+{
+    const PlanCheckMode mode = m_planCheckMode.load(std::memory_order_relaxed);
+    if(mode == NO_PLAN_CHECK) {
+        return true;
+    }
+
+    const std::string statement = sqlite3_sql(stmt);
+    const std::string shape = createStatementShape(statement);
+
+    std::unique_lock<std::mutex> guard(m_planLock);
+
+    // request the plan only once for each distinct statement. The lock is released while
+    // explaining, so other connections are not blocked by it.
+    std::map<std::string, QueryPlan>::iterator it = m_queryPlans.find(shape);
+    if(it == m_queryPlans.end())
+    {
+        guard.unlock();
+        QueryPlan newPlan;
+        newPlan.statement = shape;
+        if(runExplain(sqlite3_db_handle(stmt), statement, newPlan, error) == false) {
+            return false;
+        }
+        guard.lock();
+
+        // keeps the entry of another thread, which explained the same statement in the meantime
+        it = m_queryPlans.emplace(shape, newPlan).first;
+    }
+
+    QueryPlan* plan = &it->second;
+    plan->numberOfCalls++;
+
+    // unfiltered requests like counting or listing all rows are expected to scan the table
+    if(mode == RECORD_PLANS
+            || plan->hasFullScan == false
+            || plan->isFiltered == false
+            || plan->numberOfCalls < m_hotQueryThreshold)
+    {
+        return true;
+    }
+
+#ifndef NDEBUG
+    if(mode == FAIL_ON_SCAN)
+    {
+        error.addMeesage("hot request does a full table-scan: " + shape);
+        LOG_ERROR(error);
+        return false;
+    }
+#endif
+
+    if(plan->scanReported == false)
+    {
+        LOG_WARNING("hot request does a full table-scan: " + shape);
+        plan->scanReported = true;
+    }
+
+    return true;
+}
+
+/**
+ * @brief request the query-plan of a statement with EXPLAIN QUERY PLAN. Must be called by the
+ *        thread, which currently owns the connection.
+ *
+ * @param connection connection to use for the request
+ * @param statement sql-statement to explain
+ * @param plan reference for the output
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::runExplain(sqlite3* connection,
+                        const std::string &statement,
+                        QueryPlan &plan,
+                        ErrorContainer &error)
+{
+    const std::string command = "EXPLAIN QUERY PLAN " + statement;
+    sqlite3_stmt* stmt = nullptr;
+    if(sqlite3_prepare_v2(connection, command.c_str(), -1, &stmt, nullptr) != SQLITE_OK)
+    {
+        error.addMeesage("Error while preparing query-plan: "
+                         + std::string(sqlite3_errmsg(connection)));
+        return false;
+    }
+
+    // the 4th column of the output contains the description of the step
+    int rc = sqlite3_step(stmt);
+    while(rc == SQLITE_ROW)
+    {
+        const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        const std::string detail = text == nullptr ? "" : text;
+        plan.details.push_back(detail);
+
+        if(detail.compare(0, 5, "SCAN ") == 0
+                && detail != "SCAN CONSTANT ROW")
+        {
+            plan.hasFullScan = true;
+        }
+        if(detail.find("TEMP B-TREE") != std::string::npos) {
+            plan.hasTempBTree = true;
+        }
+
+        rc = sqlite3_step(stmt);
+    }
+
+    if(rc != SQLITE_DONE)
+    {
+        error.addMeesage("Error while requesting query-plan: "
+                         + std::string(sqlite3_errmsg(connection)));
+        sqlite3_finalize(stmt);
+        return false;
+    }
+    sqlite3_finalize(stmt);
+
+    plan.isFiltered = plan.statement.find(" WHERE ") != std::string::npos;
+
+    return true;
+}
+
+/**
+ * @brief create the shape of a statement by replacing all string- and number-literals by '?' and
+ *        by reducing whitespaces to single spaces and converting keywords to upper-case
+ *
+ * @param statement original statement
+ *
+ * @return shape of the statement
+ */
+const std::string
+SqlDatabase::createStatementShape(const std::string &statement)
+{
+    std::string shape = "";
+    shape.reserve(statement.size());
+
+    uint64_t pos = 0;
+    while(pos < statement.size())
+    {
+        const char c = statement[pos];
+
+        // string-literal, where quotes are escaped by double quotes
+        if(c == '\'')
+        {
+            pos++;
+            while(pos < statement.size())
+            {
+                if(statement[pos] == '\'')
+                {
+                    if(pos + 1 < statement.size()
+                            && statement[pos + 1] == '\'')
+                    {
+                        pos += 2;
+                        continue;
+                    }
+                    break;
+                }
+                pos++;
+            }
+            shape.push_back('?');
+            pos++;
+            continue;
+        }
+
+        // number-literal, which is not part of an identifier
+        const bool prevIsIdent = shape.size() > 0
+                                 && (isalnum(static_cast<unsigned char>(shape.back()))
+                                     || shape.back() == '_');
+        if((isdigit(static_cast<unsigned char>(c))
+                || (c == '-' && pos + 1 < statement.size()
+                    && isdigit(static_cast<unsigned char>(statement[pos + 1]))))
+                && prevIsIdent == false)
+        {
+            pos++;
+            while(pos < statement.size()
+                  && (isdigit(static_cast<unsigned char>(statement[pos]))
+                      || statement[pos] == '.'))
+            {
+                pos++;
+            }
+            shape.push_back('?');
+            continue;
+        }
+
+        // whitespaces
+        if(isspace(static_cast<unsigned char>(c)))
+        {
+            if(shape.size() > 0
+                    && shape.back() != ' ')
+            {
+                shape.push_back(' ');
+            }
+            pos++;
+            continue;
+        }
+
+        shape.push_back(static_cast<char>(toupper(static_cast<unsigned char>(c))));
+        pos++;
+    }
+
+    while(shape.size() > 0
+          && (shape.back() == ' ' || shape.back() == ';'))
+    {
+        shape.pop_back();
+    }
+
+    return shape;
+}
+
+/**
+ * @brief open a blob for incremental io. Has to be called while holding the lock.
+ *
+ * @param tableName name of the table
+ * @param columnName name of the blob-column
+ * @param rowId rowid of the row with the blob
+ * @param writable true to open the blob for writing
+ * @param error reference for error-output
+ *
+ * @return nullptr, if failed, else handle of the blob
+ */
+sqlite3_blob*
+SqlDatabase::openBlob(const std::string &tableName,
+                      const std::string &columnName,
+                      const int64_t rowId,
+                      const bool writable,
+                      ErrorContainer &error)
+{
+    if(m_isOpen == false)
+    {
+        error.addMeesage("database not open");
+        LOG_ERROR(error);
+        return nullptr;
+    }
+
+    sqlite3_blob* blob = nullptr;
+    if(sqlite3_blob_open(m_db,
+                         "main",
+                         tableName.c_str(),
+                         columnName.c_str(),
+                         rowId,
+                         writable ? 1 : 0,
+                         &blob) != SQLITE_OK)
+    {
+        error.addMeesage("Error while opening blob of column '" + columnName + "' in row "
+                         + std::to_string(rowId) + ": " + std::string(sqlite3_errmsg(m_db)));
+        LOG_ERROR(error);
+        sqlite3_blob_close(blob);
+        return nullptr;
+    }
+
+    return blob;
+}
+
+/**
+ * @brief switch the database into the write-ahead-log mode and open the read-only connections.
+ *        Must be called while m_lock is held.
+ *
+ * @param numberOfReaders number of read-only connections
+ * @param error reference for error-output
+ *
+ * @return false, if the mode can not be changed or a connection can not be opened, else true
+ */
+bool
+SqlDatabase::openReaders(const uint32_t numberOfReaders,
+                         ErrorContainer &error)
+{
+    // readers only see committed changes and don't block the writer in the write-ahead-log mode
+    TableItem journalMode;
+    if(runCommand("PRAGMA journal_mode=WAL;", &journalMode, nullptr, error) == false) {
+        return false;
+    }
+    if(journalMode.getNumberOfRows() == 0
+            || journalMode.getCell(0, 0) != "wal")
+    {
+        error.addMeesage("write-ahead-log mode is not supported");
+        return false;
+    }
+
+    std::vector<sqlite3*> readers;
+    for(uint32_t i = 0; i < numberOfReaders; i++)
+    {
+        sqlite3* reader = nullptr;
+        if(sqlite3_open_v2(m_path.c_str(), &reader, SQLITE_OPEN_READONLY, nullptr) != SQLITE_OK)
+        {
+            error.addMeesage("Can't open reader for database '" + m_path + "': "
+                             + sqlite3_errmsg(reader));
+            sqlite3_close(reader);
+            for(sqlite3* openReader : readers) {
+                sqlite3_close(openReader);
+            }
+            return false;
+        }
+
+        // readers only wait, while the write-ahead-log is reset by a checkpoint
+        sqlite3_busy_timeout(reader, 5000);
+        registerCompressionFunctions(reader);
+        readers.push_back(reader);
+    }
+
+    std::lock_guard<std::mutex> guard(m_readerLock);
+    m_readers = readers;
+    m_freeReaders = readers;
+
+    return true;
+}
+
+/**
+ * @brief close all read-only connections after they are not in use anymore. Requests, which
+ *        come in the meantime, are processed by the writer.
+ */
+void
+SqlDatabase::closeReaders()
+{
+    std::unique_lock<std::mutex> guard(m_readerLock);
+
+    std::vector<sqlite3*> readers;
+    readers.swap(m_readers);
+    m_readerReleased.wait(guard, [&] { return m_freeReaders.size() == readers.size(); });
+
+    for(sqlite3* reader : readers) {
+        sqlite3_close(reader);
+    }
+    m_freeReaders.clear();
+}
+
+/**
+ * @brief take a free read-only connection and wait, if all are in use
+ *
+ * @return nullptr, if there are no read-only connections, else connection for exclusive use
+ */
+sqlite3*
+SqlDatabase::acquireReader()
+{
+    std::unique_lock<std::mutex> guard(m_readerLock);
+
+    m_readerReleased.wait(guard, [this] {
+        return m_readers.empty() || m_freeReaders.empty() == false;
+    });
+    if(m_readers.empty()) {
+        return nullptr;
+    }
+
+    sqlite3* reader = m_freeReaders.back();
+    m_freeReaders.pop_back();
+
+    return reader;
+}
+
+/**
+ * @brief give back a read-only connection after use
+ *
+ * @param reader connection, which was taken with acquireReader
+ */
+void
+SqlDatabase::releaseReader(sqlite3* reader)
+{
+    {
+        std::lock_guard<std::mutex> guard(m_readerLock);
+        m_freeReaders.push_back(reader);
+    }
+    m_readerReleased.notify_all();
+}
+
+/**
+ * @brief execute sql-query with a reader-connection, if it is a read-request, else with the
+ *        writer-connection
+ *
+ * @param command queuy to execute
+ * @param tableResult pointer to table-item for the result, or nullptr
+ * @param arenaResult pointer to arena-based result, or nullptr
+ * @param error reference for error-output
+ * @param budget optional limit for the size of the result, or nullptr
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::execCommand(const std::string &command,
+                         TableItem* tableResult,
+                         SqlResult* arenaResult,
+                         ErrorContainer &error,
+                         ResultBudget* budget)
+{
+    updateLastRequest();
+    LOG_DEBUG("run SQL-command: " + command);
+
+    TraceHook* hook = m_traceHook.load(std::memory_order_acquire);
+    TraceScope trace(hook,
+                     TraceSpan::QUERY_SPAN,
+                     "execSqlCommand",
+                     "",
+                     hook == nullptr ? "" : createStatementShape(command));
+    const uint64_t rowsBefore = trace.isActive()
+                                ? getNumberOfResultRows(tableResult, arenaResult)
+                                : 0;
+
+    // read-only commands run with a reader-connection, so they don't wait for the writer. While
+    // a transaction is open on the writer, reads stay there to see the uncommitted rows.
+    bool isDone = false;
+    bool success = true;
+    if(m_writerInTransaction.load(std::memory_order_acquire) == false)
+    {
+        success = runReadCommand(command,
+                                 tableResult,
+                                 arenaResult,
+                                 error,
+                                 isDone,
+                                 &trace,
+                                 budget);
+    }
+    if(isDone == false)
+    {
+        trace.startLockWait();
+        std::lock_guard<std::mutex> guard(m_lock);
+        trace.stopLockWait();
+
+        if(m_isOpen == false)
+        {
+            error.addMeesage("database not open");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        success = runCommand(command, tableResult, arenaResult, error, &trace, budget);
+        m_writerInTransaction.store(sqlite3_get_autocommit(m_db) == 0, std::memory_order_release);
+    }
+
+    if(trace.isActive())
+    {
+        trace.addRows(0, getNumberOfResultRows(tableResult, arenaResult) - rowsBefore);
+        trace.setSuccess(success);
+    }
+
+    return success;
+}
+
+/**
+ * @brief get number of rows of a result
+ *
+ * @param tableResult pointer to table-item for the result, or nullptr
+ * @param arenaResult pointer to arena-based result, or nullptr
+ *
+ * @return number of rows of the given result
+ */
+uint64_t
+SqlDatabase::getNumberOfResultRows(TableItem* tableResult,
+                                   SqlResult* arenaResult)
+{
+    if(tableResult != nullptr) {
+        return tableResult->getNumberOfRows();
+    }
+    if(arenaResult != nullptr) {
+        return arenaResult->getNumberOfRows();
+    }
+
+    return 0;
+}
+
+/**
+ * @brief check by the first keyword, if a command is a read-request. This is only a fast
+ *        pre-check. The final decision is done by sqlite, when the command is prepared.
+ *
+ * @param command sql-command to check
+ *
+ * @return true, if the command starts with a keyword for reading, else false
+ */
+bool
+SqlDatabase::isReadCommand(const std::string &command)
+{
+    uint64_t pos = 0;
+    while(pos < command.size()
+          && std::isspace(static_cast<unsigned char>(command[pos])))
+    {
+        pos++;
+    }
+
+    std::string keyword = "";
+    while(pos < command.size()
+          && std::isalpha(static_cast<unsigned char>(command[pos])))
+    {
+        const unsigned char c = static_cast<unsigned char>(command[pos]);
+        keyword.push_back(static_cast<char>(std::toupper(c)));
+        pos++;
+    }
+
+    return keyword == "SELECT"
+            || keyword == "WITH"
+            || keyword == "VALUES";
+}
+
+/**
+ * @brief prepare all statements of a command with a read-only connection
+ *
+ * @param reader read-only connection
+ * @param command sql-command with one or more statements
+ * @param statements reference for the prepared statements
+ *
+ * @return false, if a statement can not be prepared or would change anything, else true
+ */
+bool
+SqlDatabase::prepareReadCommand(sqlite3* reader,
+                                const std::string &command,
+                                std::vector<sqlite3_stmt*> &statements)
+{
+    const char* pos = command.c_str();
+    const char* end = pos + command.size();
+
+    while(pos < end)
+    {
+        sqlite3_stmt* stmt = nullptr;
+        const char* tail = nullptr;
+        if(sqlite3_prepare_v2(reader, pos, static_cast<int>(end - pos), &stmt, &tail) != SQLITE_OK)
+        {
+            for(sqlite3_stmt* statement : statements) {
+                sqlite3_finalize(statement);
+            }
+            statements.clear();
+            return false;
+        }
+        pos = tail;
+
+        if(stmt == nullptr) {
+            continue;
+        }
+        statements.push_back(stmt);
+
+        // transaction-statements are also read-only for sqlite, so check the keyword too
+        if(sqlite3_stmt_readonly(stmt) == 0
+                || isReadCommand(sqlite3_sql(stmt)) == false)
+        {
+            for(sqlite3_stmt* statement : statements) {
+                sqlite3_finalize(statement);
+            }
+            statements.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief try to run a command with a read-only connection
+ *
+ * @param command sql-command to execute
+ * @param tableResult pointer to table-item for the result, or nullptr
+ * @param arenaResult pointer to arena-based result, or nullptr
+ * @param error reference for error-output
+ * @param isDone set to true, if the command was executed, and to false, if it has to be
+ *               executed by the writer, because it is not read-only or there are no readers
+ * @param trace optional span of the request for the time to wait for a reader
+ * @param budget optional limit for the size of the result
+ *
+ * @return false, if the command was executed and failed, else true
+ */
+bool
+SqlDatabase::runReadCommand(const std::string &command,
+                            TableItem* tableResult,
+                            SqlResult* arenaResult,
+                            ErrorContainer &error,
+                            bool &isDone,
+                            TraceScope* trace,
+                            ResultBudget* budget)
+{
+    isDone = false;
+    if(isReadCommand(command) == false) {
+        return true;
+    }
+
+    if(trace != nullptr) {
+        trace->startLockWait();
+    }
+    sqlite3* reader = acquireReader();
+    if(trace != nullptr) {
+        trace->stopLockWait();
+    }
+    if(reader == nullptr) {
+        return true;
+    }
+
+    // errors while preparing are reported by the writer, which prepares the command again
+    std::vector<sqlite3_stmt*> statements;
+    if(prepareReadCommand(reader, command, statements) == false)
+    {
+        releaseReader(reader);
+        return true;
+    }
+
+    isDone = true;
+    bool success = true;
+    for(sqlite3_stmt* stmt : statements)
+    {
+        if(success) {
+            success = runStatement(stmt, tableResult, arenaResult, error, trace, budget);
+        } else {
+            sqlite3_finalize(stmt);
+        }
+    }
+    releaseReader(reader);
+
+    return success;
+}
+
+/**
+ * @brief run all statements of a command with the writer-connection. Must be called while m_lock
+ *        is held.
+ *
+ * @param command sql-command with one or more statements
+ * @param tableResult pointer to table-item for the result, or nullptr
+ * @param arenaResult pointer to arena-based result, or nullptr
+ * @param error reference for error-output
+ * @param trace optional span of the request for the number of changed rows
+ * @param budget optional limit for the size of the result
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::runCommand(const std::string &command,
+                        TableItem* tableResult,
+                        SqlResult* arenaResult,
+                        ErrorContainer &error,
+                        TraceScope* trace,
+                        ResultBudget* budget)
+{
+    const char* pos = command.c_str();
+    const char* end = pos + command.size();
+
+    while(pos < end)
+    {
+        sqlite3_stmt* stmt = nullptr;
+        const char* tail = nullptr;
+        if(sqlite3_prepare_v2(m_db, pos, static_cast<int>(end - pos), &stmt, &tail) != SQLITE_OK)
+        {
+            error.addMeesage("Error while preparing sql-command: " + std::string(sqlite3_errmsg(m_db)));
+            return false;
+        }
+        pos = tail;
+
+        // statement is empty, for example because of only whitespaces at the end of the command
+        if(stmt == nullptr) {
+            continue;
+        }
+
+        if(runStatement(stmt, tableResult, arenaResult, error, trace, budget) == false) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief run a prepared statement and finalize it afterwards
+ *
+ * @param stmt prepared statement
+ * @param tableResult pointer to table-item for the result, or nullptr
+ * @param arenaResult pointer to arena-based result, or nullptr
+ * @param error reference for error-output
+ * @param trace optional span of the request for the number of changed rows
+ * @param budget optional limit for the size of the result. It is checked before each row is
+ *               added to the result, so the limit is never exceeded by more than one row.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlDatabase::runStatement(sqlite3_stmt* stmt,
+                          TableItem* tableResult,
+                          SqlResult* arenaResult,
+                          ErrorContainer &error,
+                          TraceScope* trace,
+                          ResultBudget* budget)
+{
+    if(checkQueryPlan(stmt, error) == false)
+    {
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    const bool isTraced = trace != nullptr && trace->isActive();
+    sqlite3* db = sqlite3_db_handle(stmt);
+    const int64_t changesBefore = isTraced ? sqlite3_total_changes64(db) : 0;
+
+    // results of writing statements can not be stopped before all changes are done
+    if(budget != nullptr
+            && sqlite3_stmt_readonly(stmt) == 0)
+    {
+        budget = nullptr;
+    }
+
+    // key-columns at the end of the statement are not part of the result
+    int numberOfColumns = sqlite3_column_count(stmt);
+    int numberOfKeyColumns = 0;
+    if(budget != nullptr)
+    {
+        numberOfKeyColumns = std::min(static_cast<int>(budget->numberOfKeyColumns),
+                                      numberOfColumns);
+        numberOfColumns -= numberOfKeyColumns;
+    }
+
+    int rc = sqlite3_step(stmt);
+    while(rc == SQLITE_ROW)
+    {
+        if(budget != nullptr
+                && consumeBudget(*budget, stmt) == false)
+        {
+            if(budget->truncate)
+            {
+                budget->isTruncated = true;
+                rc = SQLITE_DONE;
+                break;
+            }
+
+            error.addMeesage("result exceeds its limit (maximum rows: "
+                             + std::to_string(budget->limit.maxRows) + ", maximum bytes: "
+                             + std::to_string(budget->limit.maxBytes) + ", 0 for no limit)");
+            sqlite3_finalize(stmt);
+            return false;
+        }
+
+        if(tableResult != nullptr) {
+            appendToTable(*tableResult, stmt, numberOfColumns);
+        }
+
+        if(arenaResult != nullptr
+                && appendToResult(*arenaResult, stmt, numberOfColumns, error) == false)
+        {
+            sqlite3_finalize(stmt);
+            return false;
+        }
+
+        if(numberOfKeyColumns > 0)
+        {
+            budget->lastKey.clear();
+            for(int i = numberOfColumns; i < numberOfColumns + numberOfKeyColumns; i++)
+            {
+                const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                budget->lastKey.emplace_back(text == nullptr ? "" : text,
+                                             sqlite3_column_bytes(stmt, i));
+            }
+        }
+
+        rc = sqlite3_step(stmt);
+    }
+
+    if(rc != SQLITE_DONE)
+    {
+        error.addMeesage("Error while executing sql-command: "
+                         + std::string(sqlite3_errmsg(db)));
+        sqlite3_finalize(stmt);
+        return false;
+    }
+
+    if(isTraced) {
+        trace->addRows(getChangedRows(db, changesBefore), 0);
+    }
+    sqlite3_finalize(stmt);
+
+    return true;
+}
+
+/**
+ * @brief add the current row of a statement to the used part of a result-budget
+ *
+ * @param budget budget of the request
+ * @param stmt statement with the current row
+ *
+ * @return false, if the row doesn't fit into the budget anymore, else true. In truncating mode
+ *         the first row is always accepted, so paging through a result makes progress.
+ */
+bool
+SqlDatabase::consumeBudget(ResultBudget &budget,
+                           sqlite3_stmt* stmt)
+{
+    // size of the values without the overhead of the result-container
+    uint64_t rowSize = 0;
+    if(budget.limit.maxBytes > 0)
+    {
+        const int numberOfColumns = sqlite3_column_count(stmt)
+                                    - static_cast<int>(budget.numberOfKeyColumns);
+        for(int i = 0; i < numberOfColumns; i++)
+        {
+            const int type = sqlite3_column_type(stmt, i);
+            if(type == SQLITE_TEXT
+                    || type == SQLITE_BLOB)
+            {
+                rowSize += static_cast<uint64_t>(sqlite3_column_bytes(stmt, i));
+            }
+            else
+            {
+                rowSize += 8;
+            }
+        }
+    }
+
+    const bool isFirstRow = budget.numberOfRows == 0;
+    if(budget.truncate == false
+            || isFirstRow == false)
+    {
+        if(budget.limit.maxRows > 0
+                && budget.numberOfRows + 1 > budget.limit.maxRows)
+        {
+            return false;
+        }
+        if(budget.limit.maxBytes > 0
+                && budget.numberOfBytes + rowSize > budget.limit.maxBytes)
+        {
+            return false;
+        }
+    }
+
+    budget.numberOfRows++;
+    budget.numberOfBytes += rowSize;
+
+    return true;
+}
+
+/**
+ * @brief convert the current row of a statement into data-items and add it to a table-item
+ *
+ * @param resultTable reference to the table-item for the output
+ * @param stmt statement with the current row
+ * @param numberOfColumns number of columns of the statement, which belong to the result
+ */
+void
+SqlDatabase::appendToTable(TableItem &resultTable,
+                           sqlite3_stmt* stmt,
+                           const int numberOfColumns)
+{
+    // add columns to the table-item, but only the first time
+    if(resultTable.getNumberOfColums() == 0)
+    {
+        for(int i = 0; i < numberOfColumns; i++) {
+            resultTable.addColumn(sqlite3_column_name(stmt, i));
+        }
+    }
+
+    // collect row-data
+    DataArray* row = new DataArray();
+    for(int i = 0; i < numberOfColumns; i++)
+    {
+        switch(sqlite3_column_type(stmt, i))
+        {
+            case SQLITE_INTEGER:
+                row->append(new DataValue(static_cast<long>(sqlite3_column_int64(stmt, i))));
+                break;
+            case SQLITE_FLOAT:
+                row->append(new DataValue(sqlite3_column_double(stmt, i)));
+                break;
+            case SQLITE_NULL:
+                row->append(new DataValue());
+                break;
+            default:
+            {
+                const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                const std::string value(text, sqlite3_column_bytes(stmt, i));
+                // bool-values are stored as text
+                if(value == "true") {
+                    row->append(new DataValue(true));
+                } else if(value == "false") {
+                    row->append(new DataValue(false));
+                } else {
+                    row->append(new DataValue(value));
+                }
+                break;
+            }
+        }
+    }
+
+    resultTable.addRow(row);
+}
+
+/**
+ * @brief write the current row of a statement into an arena-based result
+ *
+ * @param resultTable reference to the result for the output
+ * @param stmt statement with the current row
+ * @param numberOfColumns number of columns of the statement, which belong to the result
+ * @param error reference for error-output
+ *
+ * @return false, if the columns of the result doesn't match the statement, else true
+ */
+bool
+SqlDatabase::appendToResult(SqlResult &resultTable,
+                            sqlite3_stmt* stmt,
+                            const int numberOfColumns,
+                            ErrorContainer &error)
+{
+    // add columns to the result, if not already predefined by the caller
+    if(resultTable.getNumberOfColumns() == 0)
+    {
+        for(int i = 0; i < numberOfColumns; i++) {
+            resultTable.addColumn(sqlite3_column_name(stmt, i));
+        }
+    }
+
+    if(resultTable.getNumberOfColumns() != static_cast<uint64_t>(numberOfColumns))
+    {
+        error.addMeesage("number of columns of the sql-result doesn't match the result-table");
+        return false;
+    }
+
+    for(int i = 0; i < numberOfColumns; i++)
+    {
+        const SqlResult::ValueType colType = resultTable.getColumnType(i);
+        switch(sqlite3_column_type(stmt, i))
+        {
+            case SQLITE_INTEGER:
+            {
+                const int64_t value = sqlite3_column_int64(stmt, i);
+                if(colType == SqlResult::BOOL_VALUE) {
+                    resultTable.appendBool(value != 0);
+                } else {
+                    resultTable.appendInt(value);
+                }
+                break;
+            }
+            case SQLITE_FLOAT:
+                resultTable.appendFloat(sqlite3_column_double(stmt, i));
+                break;
+            case SQLITE_NULL:
+                resultTable.appendNull();
+                break;
+            default:
+            {
+                const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                const int size = sqlite3_column_bytes(stmt, i);
+                // bool-values are stored as text
+                if(colType == SqlResult::BOOL_VALUE
+                        || colType == SqlResult::NULL_VALUE)
+                {
+                    const std::string_view value(text, size);
+                    if(value == "true")
+                    {
+                        resultTable.appendBool(true);
+                        break;
+                    }
+                    if(value == "false")
+                    {
+                        resultTable.appendBool(false);
+                        break;
+                    }
+                }
+                resultTable.appendString(text, size);
+                break;
+            }
+        }
+    }
 
-    return m_db.execSqlCommand(resultTable, command, error);
+    return true;
 }
 
 } // namespace Sakura
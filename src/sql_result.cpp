@@ -0,0 +1,576 @@
+/**
+ * @file       sql_result.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
+
+#include <libKitsunemimiJson/json_item.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * @brief constructor
+ */
+SqlResult::SqlResult() {}
+
+/**
+ * @brief destructor
+ */
+SqlResult::~SqlResult() {}
+
+/**
+ * @brief remove all columns and rows. The cells are plain values, so this doesn't have to iterate
+ *        over the content.
+ */
+void
+SqlResult::clear()
+{
+    m_columns.clear();
+    m_cells.clear();
+    m_stringBuffer.clear();
+}
+
+/**
+ * @brief remove all rows, but keep the columns and the already allocated memory, so the result
+ *        can be filled again without new allocations
+ */
+void
+SqlResult::clearRows()
+{
+    m_cells.clear();
+    m_stringBuffer.clear();
+}
+
+/**
+ * @brief add a new column to the result. Columns can only be added as long as there are no rows.
+ *
+ * @param name name of the column
+ * @param type expected type of the values of the column. NULL_VALUE if unknown.
+ * @param hide true to skip the column, when converted into a table- or json-item
+ *
+ * @return false, if rows are already in the result, else true
+ */
+bool
+SqlResult::addColumn(const std::string &name,
+                     const ValueType type,
+                     const bool hide)
+{
+    if(m_cells.size() > 0) {
+        return false;
+    }
+
+    ColumnInfo info;
+    info.name = name;
+    info.type = type;
+    info.hide = hide;
+    m_columns.push_back(info);
+
+    return true;
+}
+
+/**
+ * @brief get number of columns
+ */
+uint64_t
+SqlResult::getNumberOfColumns() const
+{
+    return m_columns.size();
+}
+
+/**
+ * @brief get name of a column
+ *
+ * @param column index of the column
+ *
+ * @return name of the column, or empty string if index is invalid
+ */
+const std::string
+SqlResult::getColumnName(const uint64_t column) const
+{
+    if(column >= m_columns.size()) {
+        return "";
+    }
+
+    return m_columns.at(column).name;
+}
+
+/**
+ * @brief get expected type of a column
+ *
+ * @param column index of the column
+ *
+ * @return type of the column, or NULL_VALUE if unknown or index is invalid
+ */
+SqlResult::ValueType
+SqlResult::getColumnType(const uint64_t column) const
+{
+    if(column >= m_columns.size()) {
+        return NULL_VALUE;
+    }
+
+    return m_columns.at(column).type;
+}
+
+/**
+ * @brief get index of a column by its name
+ *
+ * @param name name of the column
+ *
+ * @return -1 if not found, else index of the column
+ */
+long
+SqlResult::getColumnId(const std::string &name) const
+{
+    for(uint64_t i = 0; i < m_columns.size(); i++)
+    {
+        if(m_columns.at(i).name == name) {
+            return static_cast<long>(i);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief check if a column should be hidden in the output
+ *
+ * @param column index of the column
+ *
+ * @return true, if hidden, else false
+ */
+bool
+SqlResult::isHidden(const uint64_t column) const
+{
+    if(column >= m_columns.size()) {
+        return false;
+    }
+
+    return m_columns.at(column).hide;
+}
+
+/**
+ * @brief get number of complete rows
+ */
+uint64_t
+SqlResult::getNumberOfRows() const
+{
+    if(m_columns.size() == 0) {
+        return 0;
+    }
+
+    return m_cells.size() / m_columns.size();
+}
+
+/**
+ * @brief pre-allocate memory for the result
+ *
+ * @param numberOfRows number of rows to reserve
+ * @param numberOfStringBytes number of bytes to reserve for string-values
+ */
+void
+SqlResult::reserve(const uint64_t numberOfRows,
+                   const uint64_t numberOfStringBytes)
+{
+    m_cells.reserve(numberOfRows * m_columns.size());
+    m_stringBuffer.reserve(numberOfStringBytes);
+}
+
+/**
+ * @brief append a null-value to the current row
+ */
+void
+SqlResult::appendNull()
+{
+    Cell cell;
+    cell.intValue = 0;
+    cell.stringSize = 0;
+    cell.type = NULL_VALUE;
+    m_cells.push_back(cell);
+}
+
+/**
+ * @brief append a string-value to the current row
+ *
+ * @param value pointer to the string
+ * @param size length of the string
+ */
+void
+SqlResult::appendString(const char* value,
+                        const uint64_t size)
+{
+    Cell cell;
+    cell.stringPos = m_stringBuffer.size();
+    cell.stringSize = static_cast<uint32_t>(size);
+    cell.type = STRING_VALUE;
+    m_stringBuffer.append(value, size);
+    m_cells.push_back(cell);
+}
+
+/**
+ * @brief append an int-value to the current row
+ *
+ * @param value value to append
+ */
+void
+SqlResult::appendInt(const int64_t value)
+{
+    Cell cell;
+    cell.intValue = value;
+    cell.stringSize = 0;
+    cell.type = INT_VALUE;
+    m_cells.push_back(cell);
+}
+
+/**
+ * @brief append a bool-value to the current row
+ *
+ * @param value value to append
+ */
+void
+SqlResult::appendBool(const bool value)
+{
+    Cell cell;
+    cell.intValue = value;
+    cell.stringSize = 0;
+    cell.type = BOOL_VALUE;
+    m_cells.push_back(cell);
+}
+
+/**
+ * @brief append a float-value to the current row
+ *
+ * @param value value to append
+ */
+void
+SqlResult::appendFloat(const double value)
+{
+    Cell cell;
+    cell.floatValue = value;
+    cell.stringSize = 0;
+    cell.type = FLOAT_VALUE;
+    m_cells.push_back(cell);
+}
+
+/**
+ * @brief append a complete row of another result as new row
+ *
+ * @param source result with the row to copy. It must have the same number of columns.
+ * @param row index of the row within the source
+ *
+ * @return false, if the number of columns is different or the row doesn't exist, else true
+ */
+bool
+SqlResult::appendRow(const SqlResult &source,
+                     const uint64_t row)
+{
+    if(source.m_columns.size() != m_columns.size()
+            || row >= source.getNumberOfRows())
+    {
+        return false;
+    }
+
+    for(uint64_t x = 0; x < m_columns.size(); x++)
+    {
+        Cell cell = *source.getCell(row, x);
+        if(cell.type == STRING_VALUE)
+        {
+            const uint64_t sourcePos = cell.stringPos;
+            cell.stringPos = m_stringBuffer.size();
+            m_stringBuffer.append(source.m_stringBuffer, sourcePos, cell.stringSize);
+        }
+        m_cells.push_back(cell);
+    }
+
+    return true;
+}
+
+/**
+ * @brief get type of a cell
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return type of the cell, NULL_VALUE if null or out of range
+ */
+SqlResult::ValueType
+SqlResult::getType(const uint64_t row,
+                   const uint64_t column) const
+{
+    const Cell* cell = getCell(row, column);
+    if(cell == nullptr) {
+        return NULL_VALUE;
+    }
+
+    return static_cast<ValueType>(cell->type);
+}
+
+/**
+ * @brief check if a cell is null
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return true, if null or out of range, else false
+ */
+bool
+SqlResult::isNull(const uint64_t row,
+                  const uint64_t column) const
+{
+    return getType(row, column) == NULL_VALUE;
+}
+
+/**
+ * @brief get string-value of a cell. The returned view is only valid as long as the result is
+ *        not modified.
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return view on the string, or empty view if the cell is not a string
+ */
+std::string_view
+SqlResult::getString(const uint64_t row,
+                     const uint64_t column) const
+{
+    const Cell* cell = getCell(row, column);
+    if(cell == nullptr
+            || cell->type != STRING_VALUE)
+    {
+        return std::string_view();
+    }
+
+    return std::string_view(&m_stringBuffer[cell->stringPos], cell->stringSize);
+}
+
+/**
+ * @brief get int-value of a cell
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return value of the cell, or 0 if the cell has not a numeric type
+ */
+int64_t
+SqlResult::getInt(const uint64_t row,
+                  const uint64_t column) const
+{
+    const Cell* cell = getCell(row, column);
+    if(cell == nullptr) {
+        return 0;
+    }
+
+    if(cell->type == INT_VALUE
+            || cell->type == BOOL_VALUE)
+    {
+        return cell->intValue;
+    }
+    if(cell->type == FLOAT_VALUE) {
+        return static_cast<int64_t>(cell->floatValue);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief get bool-value of a cell
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return value of the cell, or false if the cell has not a bool- or int-type
+ */
+bool
+SqlResult::getBool(const uint64_t row,
+                   const uint64_t column) const
+{
+    const Cell* cell = getCell(row, column);
+    if(cell == nullptr) {
+        return false;
+    }
+
+    if(cell->type == INT_VALUE
+            || cell->type == BOOL_VALUE)
+    {
+        return cell->intValue != 0;
+    }
+
+    return false;
+}
+
+/**
+ * @brief get float-value of a cell
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return value of the cell, or 0.0 if the cell has not a numeric type
+ */
+double
+SqlResult::getFloat(const uint64_t row,
+                    const uint64_t column) const
+{
+    const Cell* cell = getCell(row, column);
+    if(cell == nullptr) {
+        return 0.0;
+    }
+
+    if(cell->type == FLOAT_VALUE) {
+        return cell->floatValue;
+    }
+    if(cell->type == INT_VALUE) {
+        return static_cast<double>(cell->intValue);
+    }
+
+    return 0.0;
+}
+
+/**
+ * @brief convert a single cell into a new data-item
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return new allocated data-value, which has to be deleted by the caller
+ */
+DataItem*
+SqlResult::toDataItem(const uint64_t row,
+                      const uint64_t column) const
+{
+    const Cell* cell = getCell(row, column);
+    if(cell == nullptr) {
+        return new DataValue();
+    }
+
+    switch(cell->type)
+    {
+        case STRING_VALUE:
+            return new DataValue(std::string(&m_stringBuffer[cell->stringPos], cell->stringSize));
+        case INT_VALUE:
+            return new DataValue(static_cast<long>(cell->intValue));
+        case BOOL_VALUE:
+            return new DataValue(cell->intValue != 0);
+        case FLOAT_VALUE:
+            return new DataValue(cell->floatValue);
+        default:
+            break;
+    }
+
+    return new DataValue();
+}
+
+/**
+ * @brief convert the complete result into a table-item. Hidden columns are skipped.
+ *
+ * @param result reference to the table-item for the output
+ *
+ * @return false, if the table-item already has content, else true
+ */
+bool
+SqlResult::toTableItem(TableItem &result) const
+{
+    if(result.getNumberOfColums() != 0) {
+        return false;
+    }
+
+    // create header
+    for(const ColumnInfo &info : m_columns)
+    {
+        if(info.hide == false) {
+            result.addColumn(info.name);
+        }
+    }
+
+    // create body
+    const uint64_t numberOfRows = getNumberOfRows();
+    for(uint64_t y = 0; y < numberOfRows; y++)
+    {
+        DataArray* row = new DataArray();
+        for(uint64_t x = 0; x < m_columns.size(); x++)
+        {
+            if(m_columns.at(x).hide == false) {
+                row->append(toDataItem(y, x));
+            }
+        }
+        result.addRow(row);
+    }
+
+    return true;
+}
+
+/**
+ * @brief convert a single row into a json-map. Hidden columns are skipped.
+ *
+ * @param result reference to the json-item for the output
+ * @param row row to convert
+ *
+ * @return false, if row doesn't exist, else true
+ */
+bool
+SqlResult::toJsonItem(JsonItem &result,
+                      const uint64_t row) const
+{
+    if(row >= getNumberOfRows()) {
+        return false;
+    }
+
+    for(uint64_t x = 0; x < m_columns.size(); x++)
+    {
+        if(m_columns.at(x).hide) {
+            continue;
+        }
+
+        DataItem* value = toDataItem(row, x);
+        result.insert(m_columns.at(x).name, value);
+        delete value;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get pointer to a cell
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return nullptr, if out of range, else pointer to the cell
+ */
+const SqlResult::Cell*
+SqlResult::getCell(const uint64_t row,
+                   const uint64_t column) const
+{
+    if(column >= m_columns.size()) {
+        return nullptr;
+    }
+
+    const uint64_t pos = row * m_columns.size() + column;
+    if(pos >= m_cells.size()) {
+        return nullptr;
+    }
+
+    return &m_cells[pos];
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
@@ -22,610 +22,4678 @@
 
 #include <libKitsunemimiSakuraDatabase/sql_table.h>
 #include <libKitsunemimiSakuraDatabase/sql_database.h>
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
+#include <libKitsunemimiSakuraDatabase/table_snapshot.h>
+#include <row_parser.h>
+#include <trace_scope.h>
+#include <value_compression.h>
+#include <write_back_cache.h>
 
 #include <libKitsunemimiCommon/methods/string_methods.h>
 #include <libKitsunemimiJson/json_item.h>
 
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <chrono>
+#include <map>
+#include <algorithm>
+#include <limits>
+#include <cctype>
+
 namespace Kitsunemimi
 {
 namespace Sakura
 {
 
+// the buffer is reused for all queries of the thread, so its memory is only allocated once
+thread_local std::string t_queryBuffer;
+thread_local bool t_queryBufferInUse = false;
+
 /**
- * @brief constructor
- *
- * @param db pointer to database
+ * @brief buffer to build a sql-query. The memory is reused for all queries of the calling
+ *        thread. If a query is built, while another query of the same thread is still in
+ *        progress, the new query uses its own string instead.
  */
-SqlTable::SqlTable(SqlDatabase* db)
+class QueryBuffer
 {
-    m_db = db;
-}
+public:
+    QueryBuffer()
+    {
+        if(t_queryBufferInUse)
+        {
+            m_buffer = &m_ownBuffer;
+            return;
+        }
 
-/**
- * @brief destructor
- */
-SqlTable::~SqlTable() {}
+        t_queryBufferInUse = true;
+        m_buffer = &t_queryBuffer;
+        t_queryBuffer.clear();
+        if(t_queryBuffer.capacity() < m_reservedSize) {
+            t_queryBuffer.reserve(m_reservedSize);
+        }
+    }
+
+    ~QueryBuffer()
+    {
+        if(m_buffer != &t_queryBuffer) {
+            return;
+        }
+
+        // the memory of single huge queries should not stay with the thread until it ends
+        if(t_queryBuffer.capacity() > m_maxKeptSize)
+        {
+            std::string().swap(t_queryBuffer);
+            t_queryBuffer.reserve(m_reservedSize);
+        }
+
+        t_queryBufferInUse = false;
+    }
+
+    QueryBuffer(const QueryBuffer &) = delete;
+    QueryBuffer& operator=(const QueryBuffer &) = delete;
+
+    std::string& get() { return *m_buffer; }
+
+private:
+    static constexpr uint64_t m_reservedSize = 4096;
+    static constexpr uint64_t m_maxKeptSize = 64 * 1024;
+
+    std::string* m_buffer = nullptr;
+    std::string m_ownBuffer;
+};
 
 /**
- * @brief initalize table
+ * @brief get the value of a hex-digit
  *
- * @param error reference for error-output
+ * @param digit character to convert
  *
- * @return true, if successfuly or table already exist, else false
+ * @return -1, if the character is not a hex-digit, else its value
  */
-bool
-SqlTable::initTable(ErrorContainer &error)
+static int
+getHexValue(const char digit)
 {
-    return m_db->execSqlCommand(nullptr, createTableCreateQuery(), error);
+    if(digit >= '0' && digit <= '9') {
+        return digit - '0';
+    }
+    if(digit >= 'a' && digit <= 'f') {
+        return digit - 'a' + 10;
+    }
+    if(digit >= 'A' && digit <= 'F') {
+        return digit - 'A' + 10;
+    }
+
+    return -1;
 }
 
 /**
- * @brief insert values into the table
+ * @brief check if a string is a number, like it is written by the quote-function of sqlite
  *
- * @param values string-list with values to insert
- * @param error reference for error-output
+ * @param literal string to check
+ * @param allowFraction true to allow also real-numbers like '-1.5e+20', false for integers
  *
- * @return uuid of the new entry, if successful, else empty string
+ * @return true, if valid number, else false
  */
-bool
-SqlTable::insertToDb(JsonItem &values,
-                     ErrorContainer &error)
+static bool
+isNumberLiteral(const std::string &literal,
+                const bool allowFraction)
 {
-    Kitsunemimi::TableItem resultItem;
-
-    // get values from input to check if all required values are set
-    std::vector<std::string> dbValues;
-    for(const DbHeaderEntry &entry : m_tableHeader)
-    {
-        if(values.contains(entry.name) == false
-                && entry.allowNull == false)
+    uint64_t pos = 0;
+    auto skipDigits = [&]() {
+        const uint64_t start = pos;
+        while(pos < literal.size()
+              && std::isdigit(static_cast<unsigned char>(literal.at(pos))))
         {
-            error.addMeesage("insert into dabase failed, because '"
-                             + entry.name
-                             + "' is required, but missing in the input-values.");
-            LOG_ERROR(error);
-            return false;
+            pos++;
         }
-        dbValues.push_back(values.get(entry.name).toString());
-    }
+        return pos > start;
+    };
 
-    // build and run insert-command
-    if(m_db->execSqlCommand(&resultItem, createInsertQuery(dbValues), error) == false)
+    if(pos < literal.size()
+            && literal.at(pos) == '-')
     {
-        LOG_ERROR(error);
+        pos++;
+    }
+    if(skipDigits() == false) {
         return false;
     }
 
-    return true;
-}
-
-/**
- * @brief update values within the table
- *
- * @param conditions conditions to filter table
- * @param updates json-map with key-value pairs to update
- * @param error reference for error-output
- *
- * @return true, if successful, else false
- */
-bool
-SqlTable::updateInDb(const std::vector<RequestCondition> &conditions,
-                     const JsonItem &updates,
-                     ErrorContainer &error)
-{
-    // precheck
-    if(conditions.size() == 0)
+    if(allowFraction)
     {
-        error.addMeesage("no conditions given for table-access.");
-        LOG_ERROR(error);
-        return false;
+        if(pos < literal.size()
+                && literal.at(pos) == '.')
+        {
+            pos++;
+            if(skipDigits() == false) {
+                return false;
+            }
+        }
+
+        if(pos < literal.size()
+                && literal.at(pos) == 'e')
+        {
+            pos++;
+            if(pos < literal.size()
+                    && (literal.at(pos) == '+' || literal.at(pos) == '-'))
+            {
+                pos++;
+            }
+            if(skipDigits() == false) {
+                return false;
+            }
+        }
     }
 
-    Kitsunemimi::TableItem resultItem;
-    return m_db->execSqlCommand(&resultItem, createUpdateQuery(conditions, updates), error);
+    return pos == literal.size();
 }
 
 /**
- * @brief get all rows from table
+ * @brief check if a string is a single value, like it is written by the quote-function of sqlite,
+ *        so it can be used within a query without the risk of an injection
  *
- * @param resultTable pointer to table for the resuld of the query
- * @param error reference for error-output
- * @param showHiddenValues include values in output, which should normally be hidden
- * @param positionOffset offset of the rows to return
- * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param literal string to check
  *
- * @return true, if successful, else false
+ * @return true, if valid literal, else false
  */
-bool
-SqlTable::getAllFromDb(TableItem &resultTable,
-                       ErrorContainer &error,
-                       const bool showHiddenValues,
-                       const uint64_t positionOffset,
-                       const uint64_t numberOfRows)
+static bool
+isSqlLiteral(const std::string &literal)
 {
-    std::vector<RequestCondition> conditions;
-    if(m_db->execSqlCommand(&resultTable,
-                            createSelectQuery(conditions,
-                                              positionOffset,
-                                              numberOfRows),
-                            error) == false)
-    {
-        LOG_ERROR(error);
-        return false;
+    if(literal == "NULL") {
+        return true;
     }
 
-    // if header is missing in result, because there are no entries to list, add a default-header
-    if(resultTable.getNumberOfColums() == 0)
+    // blob like X'0A1B'
+    if(literal.size() >= 3
+            && literal.compare(0, 2, "X'") == 0
+            && literal.back() == '\'')
     {
-        for(const DbHeaderEntry &entry : m_tableHeader) {
-            resultTable.addColumn(entry.name);
+        const uint64_t numberOfDigits = literal.size() - 3;
+        for(uint64_t i = 2; i < literal.size() - 1; i++)
+        {
+            if(getHexValue(literal.at(i)) == -1) {
+                return false;
+            }
         }
+        return numberOfDigits % 2 == 0;
     }
 
-    // remove all values, which should be hide
-    if(showHiddenValues == false)
+    // text, where quotes within the text are doubled
+    if(literal.size() >= 2
+            && literal.front() == '\''
+            && literal.back() == '\'')
     {
-        for(const DbHeaderEntry &entry : m_tableHeader)
+        for(uint64_t i = 1; i < literal.size() - 1; i++)
         {
-            if(entry.hide) {
-                resultTable.deleteColumn(entry.name);
+            if(literal.at(i) != '\'') {
+                continue;
+            }
+            if(i + 2 >= literal.size()
+                    || literal.at(i + 1) != '\'')
+            {
+                return false;
             }
+            i++;
         }
+        return true;
     }
 
-    return true;
+    return isNumberLiteral(literal, true);
 }
 
-
 /**
- * @brief get one or more rows from table or also the complete table
- *
- * @param resultTable pointer to table for the resuld of the query
- * @param conditions conditions to filter table
- * @param error reference for error-output
- * @param showHiddenValues include values in output, which should normally be hidden
- * @param positionOffset offset of the rows to return
- * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @brief constructor
  *
- * @return true, if successful, else false
+ * @param db pointer to database
  */
-bool
-SqlTable::getFromDb(TableItem &resultTable,
-                    const std::vector<RequestCondition> &conditions,
-                    ErrorContainer &error,
-                    const bool showHiddenValues,
-                    const uint64_t positionOffset,
-                    const uint64_t numberOfRows)
+SqlTable::SqlTable(SqlDatabase* db)
 {
-    if(m_db->execSqlCommand(&resultTable,
-                            createSelectQuery(conditions,
-                                              positionOffset,
-                                              numberOfRows),
-                            error) == false)
-    {
-        LOG_ERROR(error);
-        return false;
-    }
+    m_db = db;
+}
 
-    // if header is missing in result, because there are no entries to list, add a default-header
-    if(resultTable.getNumberOfColums() == 0)
+/**
+ * @brief destructor
+ */
+SqlTable::~SqlTable()
+{
+    stopExpirySweeper();
+
+    // wait for asynchronous requests, which still use this table
     {
-        for(const DbHeaderEntry &entry : m_tableHeader) {
-            resultTable.addColumn(entry.name);
-        }
+        std::unique_lock<std::mutex> guard(m_asyncLock);
+        m_asyncFinished.wait(guard, [this] { return m_numberOfAsyncRequests == 0; });
     }
 
-    // remove all values, which should be hide
-    if(showHiddenValues == false)
+    // write the remaining changes of the write-back mode into the database
+    stopWriteBackFlusher();
     {
-        for(const DbHeaderEntry &entry : m_tableHeader)
+        std::unique_lock<std::shared_mutex> guard(m_writeBackLock);
+        if(m_writeBackCache != nullptr)
         {
-            if(entry.hide) {
-                resultTable.deleteColumn(entry.name);
-            }
+            ErrorContainer error;
+            flushWriteBackCache(error);
+            delete m_writeBackCache;
+            m_writeBackCache = nullptr;
         }
     }
 
-    return true;
+    // delivers all remaining events before the feed is destroyed
+    delete m_changeFeed;
 }
 
-
 /**
- * @brief get one or more rows from table
+ * @brief initalize table
  *
- * @param resultTable pointer to table for the resuld of the query
- * @param conditions conditions to filter table
  * @param error reference for error-output
- * @param showHiddenValues include values in output, which should normally be hidden
- * @param positionOffset offset of the rows to return
- * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
  *
- * @return true, if successful, else false
+ * @return true, if successfuly or table already exist, else false
  */
 bool
-SqlTable::getFromDb(JsonItem &result,
-                    const std::vector<RequestCondition> &conditions,
-                    ErrorContainer &error,
-                    const bool showHiddenValues,
-                    const uint64_t positionOffset,
-                    const uint64_t numberOfRows)
+SqlTable::initTable(ErrorContainer &error)
 {
-    // precheck
-    if(conditions.size() == 0)
-    {
-        error.addMeesage("no conditions given for table-access.");
-        LOG_ERROR(error);
+    if(checkColumns(error) == false) {
         return false;
     }
 
-    // run select-query
-    TableItem tableResult;
-    if(m_db->execSqlCommand(&tableResult,
-                            createSelectQuery(conditions,
-                                              positionOffset,
-                                              numberOfRows),
+    // the index on the expiry-column allows to find expired rows without full table-scan
+    if(m_db->execSqlCommand(nullptr,
+                            createTableCreateQuery()
+                            + createExpiryIndexQuery()
+                            + createColumnIndexQuery(),
                             error) == false)
     {
-        LOG_ERROR(error);
         return false;
     }
 
-    // convert table-row to json
-    if(processGetResult(result, tableResult) == false)
-    {
-        error.addMeesage("no entry found in database-table '" + m_tableName + "'.");
-        // HINT: no LOG_ERROR here, because it is possible, that the getFromDb was only called to
-        // check if the entry exist within the database. In this case a false as return is a valid
-        // output and not an error
-        return false;
-    }
+    return initSearchIndex(error);
+}
 
-    // remove all values, which should be hide
-    if(showHiddenValues == false)
-    {
-        for(const DbHeaderEntry &entry : m_tableHeader)
-        {
-            if(entry.hide) {
-                result.remove(entry.name);
-            }
-        }
+/**
+ * @brief register a subscriber for changes of the table. Only changes, which are done with the
+ *        functions of this table-object, are reported. The callback is called with batches of
+ *        events from an own thread and not from the thread, which has changed the table.
+ *
+ * @param callback callback for the change-events
+ *
+ * @return id of the new subscriber
+ */
+uint64_t
+SqlTable::subscribeChanges(ChangeFeed::ChangeCallback callback)
+{
+    std::lock_guard<std::mutex> guard(m_changeFeedLock);
+
+    if(m_changeFeed == nullptr) {
+        m_changeFeed = new ChangeFeed();
     }
 
-    return true;
+    return m_changeFeed->addSubscriber(callback);
 }
 
 /**
- * @brief Request number of rows of the database-table
+ * @brief remove a subscriber for changes of the table
  *
- * @param error reference for error-output
+ * @param subscriberId id of the subscriber
  *
- * @return -1 if request against database failed, else number of rows
+ * @return false, if id was not found, else true
  */
-long
-SqlTable::getNumberOfRows(ErrorContainer &error)
+bool
+SqlTable::unsubscribeChanges(const uint64_t subscriberId)
 {
-    Kitsunemimi::TableItem resultItem;
-    if(m_db->execSqlCommand(&resultItem, createCountQuery(), error) == false) {
-        return -1;
+    std::lock_guard<std::mutex> guard(m_changeFeedLock);
+
+    if(m_changeFeed == nullptr) {
+        return false;
     }
 
-    return resultItem.getBody()->get(0)->get(0)->toValue()->getLong();
+    return m_changeFeed->removeSubscriber(subscriberId);
 }
 
 /**
- * @brief delete all entries for the table
+ * @brief block until all change-events, which are already queued, are delivered
+ */
+void
+SqlTable::flushChanges()
+{
+    std::lock_guard<std::mutex> guard(m_changeFeedLock);
+
+    if(m_changeFeed != nullptr) {
+        m_changeFeed->flush();
+    }
+}
+
+/**
+ * @brief route read-requests of the table to a read-replica, as long as its content is not older
+ *        than the given bound. If the replica is too old, the requests are processed by the
+ *        primary database. Because of this, changes are not visible immediately for reads, but
+ *        after the next refresh of the replica, at the latest after the staleness-bound.
  *
- * @param error reference for error-output
+ * @param replica replica of the database of the table. nullptr to read again only from the
+ *                primary database.
+ * @param maxStaleness maximum age in milliseconds of the content of the replica
+ */
+void
+SqlTable::setReadReplica(SqlDatabase* replica,
+                         const uint32_t maxStaleness)
+{
+    std::lock_guard<std::mutex> guard(m_readReplicaLock);
+    m_readReplica = replica;
+    m_maxStaleness = maxStaleness;
+}
+
+/**
+ * @brief set the limit for the results of read-operations of the table. Results of
+ *        getAllFromDb and getFromDb, which exceed the limit, let the request fail, while
+ *        getAllFromDb with continuation-token returns the result in multiple parts.
  *
- * @return true, if successful, else false
+ * @param limit new limit. With 0 rows and 0 bytes, the default-limit of the database is used.
  */
-bool
-SqlTable::deleteAllFromDb(ErrorContainer &error)
+void
+SqlTable::setResultLimit(const SqlDatabase::ResultLimit &limit)
 {
-    const std::vector<RequestCondition> conditions;
-    Kitsunemimi::TableItem resultItem;
-    return m_db->execSqlCommand(&resultItem, createDeleteQuery(conditions), error);
+    std::lock_guard<std::mutex> guard(m_resultLimitLock);
+    m_resultLimit = limit;
 }
 
 /**
- * @brief delete one of more rows from database
+ * @brief start a background-thread, which deletes expired rows. The rows are deleted in small
+ *        batches with a pause between the batches, so other requests are not blocked for a long
+ *        time, when many rows expire at the same time.
  *
- * @param conditions conditions to filter table
- * @param error reference for error-output
+ * @param sweepInterval time in milliseconds between two runs of the sweeper
+ * @param batchSize maximum number of rows to delete with one request
+ * @param pauseBetweenBatches time in milliseconds to wait between two batches
  *
- * @return true, if successful, else false
+ * @return false, if the table has no expiry-column or the sweeper is already running, else true
  */
 bool
-SqlTable::deleteFromDb(const std::vector<RequestCondition> &conditions,
-                       ErrorContainer &error)
+SqlTable::startExpirySweeper(const uint32_t sweepInterval,
+                             const uint64_t batchSize,
+                             const uint32_t pauseBetweenBatches)
 {
-    // precheck
-    if(conditions.size() == 0)
+    if(getExpiryColumnId() == -1
+            || batchSize == 0)
     {
-        error.addMeesage("no conditions given for table-access.");
-        LOG_ERROR(error);
         return false;
     }
 
-    Kitsunemimi::TableItem resultItem;
-    return m_db->execSqlCommand(&resultItem, createDeleteQuery(conditions), error);
-}
+    std::lock_guard<std::mutex> guard(m_sweeperLock);
 
-/**
+    if(m_sweeper.joinable()) {
+        return false;
+    }
+
+    m_sweeperAbort = false;
+    m_sweeper = std::thread(&SqlTable::runExpirySweeper,
+                            this,
+                            sweepInterval,
+                            batchSize,
+                            pauseBetweenBatches);
+
+    return true;
+}
+
+/**
+ * @brief stop the background-thread, which deletes expired rows
+ */
+void
+SqlTable::stopExpirySweeper()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_sweeperLock);
+        if(m_sweeper.joinable() == false) {
+            return;
+        }
+        m_sweeperAbort = true;
+    }
+    m_sweeperWakeup.notify_all();
+
+    m_sweeper.join();
+}
+
+/**
+ * @brief delete a batch of expired rows
+ *
+ * @param error reference for error-output
+ * @param batchSize maximum number of rows to delete
+ *
+ * @return -1 if request failed or table has no expiry-column, else number of deleted rows
+ */
+long
+SqlTable::deleteExpiredRows(ErrorContainer &error,
+                            const uint64_t batchSize)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "deleteExpiredRows",
+                     m_tableName);
+
+    if(getExpiryColumnId() == -1)
+    {
+        error.addMeesage("table '" + m_tableName + "' has no column with time-to-live");
+        LOG_ERROR(error);
+        return -1;
+    }
+
+    // the keys of the deleted rows are always returned to count them
+    TableItem resultItem;
+    if(m_db->execSqlCommand(&resultItem, createDeleteExpiredQuery(batchSize), error) == false)
+    {
+        LOG_ERROR(error);
+        return -1;
+    }
+
+    std::vector<std::string> primaryKeys;
+    for(uint64_t row = 0; row < resultItem.getNumberOfRows(); row++) {
+        primaryKeys.push_back(resultItem.getCell(0, row));
+    }
+    publishChanges(ChangeEvent::DELETE_CHANGE, primaryKeys);
+
+    return static_cast<long>(primaryKeys.size());
+}
+
+/**
+ * @brief enable the write-back mode. In this mode the table is held in memory with the primary
+ *        key as index and all changes are done only in memory. Changed rows are written into the
+ *        database within one transaction by a background-thread, so repeated changes of the same
+ *        row result in only one write. Changes, which are not written yet, are lost on a crash.
+ *        Get-requests for single rows are answered from memory, all other reads write the
+ *        changes into the database first. Requests, which run at the same time, either use
+ *        the memory or the database, but never a cache, which is already deleted.
+ *
+ * @param error reference for error-output
+ * @param flushInterval time in milliseconds between two writes into the database
+ * @param maxDirtyRows number of changed rows, which triggers a write before the interval is over
+ *
+ * @return false, if the table doesn't support the write-back mode or loading failed, else true
+ */
+bool
+SqlTable::enableWriteBack(ErrorContainer &error,
+                          const uint32_t flushInterval,
+                          const uint64_t maxDirtyRows)
+{
+    {
+        std::shared_lock<std::shared_mutex> guard(m_writeBackLock);
+        if(m_writeBackCache != nullptr)
+        {
+            error.addMeesage("write-back mode of table '" + m_tableName + "' is already enabled");
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    const long primaryKeyId = getPrimaryKeyId();
+    if(primaryKeyId == -1)
+    {
+        error.addMeesage("write-back mode requires a primary key in table '" + m_tableName + "'");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        if(entry.type == BLOB_TYPE
+                || entry.timeToLive > 0
+                || entry.isVersion)
+        {
+            error.addMeesage("write-back mode doesn't support blob-, time-to-live- "
+                             "and version-columns");
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    // load the current state of the table without the limit for results
+    SqlResult content;
+    const std::vector<RequestCondition> noConditions;
+    if(readFromDb(content, noConditions, error, true, 0, 0, {}, nullptr) == false) {
+        return false;
+    }
+
+    WriteBackCache* cache = new WriteBackCache(static_cast<uint64_t>(primaryKeyId));
+    for(uint64_t row = 0; row < content.getNumberOfRows(); row++)
+    {
+        WriteBackCache::CachedRow cachedRow;
+        for(uint64_t col = 0; col < m_tableHeader.size(); col++)
+        {
+            const bool isNull = content.isNull(row, col);
+            cachedRow.isNull.push_back(isNull);
+            if(isNull)
+            {
+                cachedRow.values.push_back("");
+                continue;
+            }
+
+            DataItem* value = content.toDataItem(row, col);
+            cachedRow.values.push_back(value->toString());
+            delete value;
+        }
+        cache->loadRow(cachedRow);
+    }
+
+    {
+        // another thread could have enabled the mode while the table was loaded
+        std::unique_lock<std::shared_mutex> guard(m_writeBackLock);
+        if(m_writeBackCache != nullptr)
+        {
+            delete cache;
+            error.addMeesage("write-back mode of table '" + m_tableName + "' is already enabled");
+            LOG_ERROR(error);
+            return false;
+        }
+        m_writeBackCache = cache;
+    }
+    m_flushInterval = flushInterval;
+    m_maxDirtyRows = maxDirtyRows;
+    startWriteBackFlusher();
+
+    return true;
+}
+
+/**
+ * @brief write all changes into the database and disable the write-back mode. Waits for running
+ *        requests, which still use the memory of the write-back mode.
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if writing the changes failed and the write-back mode is still enabled, else true
+ */
+bool
+SqlTable::disableWriteBack(ErrorContainer &error)
+{
+    stopWriteBackFlusher();
+
+    std::unique_lock<std::shared_mutex> guard(m_writeBackLock);
+    if(m_writeBackCache == nullptr) {
+        return true;
+    }
+
+    if(flushWriteBackCache(error) == false)
+    {
+        guard.unlock();
+        startWriteBackFlusher();
+        return false;
+    }
+
+    delete m_writeBackCache;
+    m_writeBackCache = nullptr;
+
+    return true;
+}
+
+/**
+ * @brief write all changed rows of the write-back mode into the database within one transaction
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful or write-back mode is disabled, else false
+ */
+bool
+SqlTable::flushWriteBack(ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "flushWriteBack",
+                     m_tableName);
+
+    std::shared_lock<std::shared_mutex> guard(m_writeBackLock);
+    return flushWriteBackCache(error);
+}
+
+/**
+ * @brief write all changed rows of the write-back cache into the database. The caller must hold
+ *        the write-back lock, so the cache can not be deleted while it is written.
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful or write-back mode is disabled, else false
+ */
+bool
+SqlTable::flushWriteBackCache(ErrorContainer &error)
+{
+    if(m_writeBackCache == nullptr) {
+        return true;
+    }
+
+    // only one flush at the same time, so older states can not overwrite newer ones
+    std::lock_guard<std::mutex> guard(m_flushLock);
+
+    std::vector<WriteBackCache::CachedRow> changedRows;
+    std::vector<std::string> deletedKeys;
+    m_writeBackCache->takeDirtyRows(changedRows, deletedKeys);
+    if(changedRows.size() == 0
+            && deletedKeys.size() == 0)
+    {
+        return true;
+    }
+
+    SqlResult upserts;
+    initResultColumns(upserts, true);
+    for(const WriteBackCache::CachedRow &row : changedRows)
+    {
+        for(uint64_t i = 0; i < m_tableHeader.size(); i++) {
+            appendCachedValue(upserts, m_tableHeader.at(i), row.values.at(i), row.isNull.at(i));
+        }
+    }
+
+    const DbHeaderEntry &keyEntry = m_tableHeader.at(getPrimaryKeyId());
+    SqlResult deletes;
+    deletes.addColumn(keyEntry.name);
+    for(const std::string &key : deletedKeys) {
+        appendCachedValue(deletes, keyEntry, key, false);
+    }
+
+    if(m_db->writeRows({createPreparedInsertQuery(true), createPreparedDeleteQuery()},
+                       {&upserts, &deletes},
+                       error) == false)
+    {
+        m_writeBackCache->restoreDirtyRows(changedRows, deletedKeys);
+        error.addMeesage("writing changes of table '" + m_tableName + "' failed");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief insert values into the table
+ *
+ * @param values string-list with values to insert
+ * @param error reference for error-output
+ *
+ * @return uuid of the new entry, if successful, else empty string
+ */
+bool
+SqlTable::insertToDb(JsonItem &values,
+                     ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "insertToDb",
+                     m_tableName);
+
+    // check if all required values are set
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        // blobs, expiry-times and versions get default-values, when the row is created
+        if(entry.type == BLOB_TYPE
+                || entry.timeToLive > 0
+                || entry.isVersion)
+        {
+            continue;
+        }
+
+        if(values.contains(entry.name) == false
+                && entry.allowNull == false)
+        {
+            error.addMeesage("insert into dabase failed, because '"
+                             + entry.name
+                             + "' is required, but missing in the input-values.");
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    // in write-back mode the row is only added to the memory
+    std::shared_lock<std::shared_mutex> writeBackGuard(m_writeBackLock);
+    if(m_writeBackCache != nullptr)
+    {
+        // blob-, time-to-live- and version-columns are not allowed in write-back mode
+        WriteBackCache::CachedRow row;
+        row.values.reserve(m_tableHeader.size());
+        row.isNull.reserve(m_tableHeader.size());
+        for(const DbHeaderEntry &entry : m_tableHeader)
+        {
+            row.values.push_back(values.get(entry.name).toString());
+            row.isNull.push_back(values.contains(entry.name) == false);
+        }
+        const std::string &primaryKey = row.values.at(getPrimaryKeyId());
+
+        if(m_writeBackCache->insertRow(row) == false)
+        {
+            error.addMeesage("insert into dabase failed, because an entry with the primary key '"
+                             + primaryKey + "' already exist.");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        publishChanges(ChangeEvent::INSERT_CHANGE, {primaryKey});
+        requestFlushIfNeeded();
+        return true;
+    }
+    writeBackGuard.unlock();
+
+    // build and run insert-command
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createInsertQuery(command, values);
+    if(runMutation(command, ChangeEvent::INSERT_CHANGE, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief update values within the table
+ *
+ * @param conditions conditions to filter table
+ * @param updates json-map with key-value pairs to update
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::updateInDb(const std::vector<RequestCondition> &conditions,
+                     const JsonItem &updates,
+                     ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "updateInDb",
+                     m_tableName);
+
+    // precheck
+    if(conditions.size() == 0)
+    {
+        error.addMeesage("no conditions given for table-access.");
+        LOG_ERROR(error);
+        return false;
+    }
+    if(checkConditions(conditions, error) == false) {
+        return false;
+    }
+
+    // in write-back mode the rows are only updated in memory
+    std::shared_lock<std::shared_mutex> writeBackGuard(m_writeBackLock);
+    if(m_writeBackCache != nullptr)
+    {
+        std::vector<std::pair<uint64_t, std::string>> cacheConditions;
+        if(convertConditions(conditions, cacheConditions, error) == false) {
+            return false;
+        }
+
+        std::vector<std::pair<uint64_t, std::string>> cacheUpdates;
+        for(const std::string &key : updates.getKeys())
+        {
+            const long columnId = getColumnId(key);
+            if(columnId == -1
+                    || columnId == getPrimaryKeyId())
+            {
+                error.addMeesage("column '" + key + "' can not be updated in write-back mode");
+                LOG_ERROR(error);
+                return false;
+            }
+            cacheUpdates.emplace_back(columnId, updates.get(key).toString());
+        }
+
+        publishChanges(ChangeEvent::UPDATE_CHANGE,
+                       m_writeBackCache->updateRows(cacheConditions, cacheUpdates));
+        requestFlushIfNeeded();
+        return true;
+    }
+    writeBackGuard.unlock();
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createUpdateQuery(command, conditions, updates);
+    return runMutation(command, ChangeEvent::UPDATE_CHANGE, error);
+}
+
+/**
+ * @brief update values within the table, but only if the rows still have the expected version.
+ *        Check and update are done by one query, so concurrent read-modify-write sequences can
+ *        not overwrite the changes of each other without an additional lock.
+ *
+ * @param conditions conditions to filter table, normally the primary key of the row
+ * @param updates json-map with key-value pairs to update
+ * @param expectedVersion version of the row, which was read before the update
+ * @param error reference for error-output
+ *
+ * @return -1 if failed, 0 if no row with the expected version was found, because the row was
+ *         changed or deleted in the meantime, else the new version of the updated rows
+ */
+long
+SqlTable::updateInDbIfVersion(const std::vector<RequestCondition> &conditions,
+                              const JsonItem &updates,
+                              const int64_t expectedVersion,
+                              ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "updateInDbIfVersion",
+                     m_tableName);
+
+    // precheck
+    if(conditions.size() == 0)
+    {
+        error.addMeesage("no conditions given for table-access.");
+        LOG_ERROR(error);
+        return -1;
+    }
+    if(checkConditions(conditions, error) == false) {
+        return -1;
+    }
+
+    const long versionColumnId = getVersionColumnId();
+    if(versionColumnId == -1)
+    {
+        error.addMeesage("table '" + m_tableName + "' has no version-column");
+        LOG_ERROR(error);
+        return -1;
+    }
+
+    const std::string &versionName = m_tableHeader.at(versionColumnId).name;
+    const std::vector<std::string> keys = updates.getKeys();
+    if(std::find(keys.begin(), keys.end(), versionName) != keys.end())
+    {
+        error.addMeesage("version-column '" + versionName + "' can not be updated directly");
+        LOG_ERROR(error);
+        return -1;
+    }
+
+    std::vector<RequestCondition> versionConditions = conditions;
+    versionConditions.emplace_back(versionName, std::to_string(expectedVersion));
+
+    uint64_t numberOfChangedRows = 0;
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createUpdateQuery(command, versionConditions, updates);
+    if(runMutation(command, ChangeEvent::UPDATE_CHANGE, error, &numberOfChangedRows) == false) {
+        return -1;
+    }
+
+    if(numberOfChangedRows == 0) {
+        return 0;
+    }
+
+    return expectedVersion + 1;
+}
+
+/**
+ * @brief get all rows from table
+ *
+ * @param resultTable pointer to table for the resuld of the query
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param orderBy columns to sort the result. Rows with the same values are sorted by the order
+ *                of their insertion, so pagination is stable.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::getAllFromDb(TableItem &resultTable,
+                       ErrorContainer &error,
+                       const bool showHiddenValues,
+                       const uint64_t positionOffset,
+                       const uint64_t numberOfRows,
+                       const std::vector<OrderBy> &orderBy)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getAllFromDb",
+                     m_tableName);
+
+    SqlDatabase::ResultBudget budget;
+    budget.limit = getResultLimit();
+
+    const std::vector<RequestCondition> conditions;
+    return readFromDb(resultTable,
+                      conditions,
+                      error,
+                      showHiddenValues,
+                      positionOffset,
+                      numberOfRows,
+                      orderBy,
+                      &budget);
+}
+
+/**
+ * @brief get all rows from table into an arena-based result
+ *
+ * @param resultTable reference to the result of the query. Existing content will be removed.
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param orderBy columns to sort the result. Rows with the same values are sorted by the order
+ *                of their insertion, so pagination is stable.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::getAllFromDb(SqlResult &resultTable,
+                       ErrorContainer &error,
+                       const bool showHiddenValues,
+                       const uint64_t positionOffset,
+                       const uint64_t numberOfRows,
+                       const std::vector<OrderBy> &orderBy)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getAllFromDb",
+                     m_tableName);
+
+    const std::vector<RequestCondition> conditions;
+    return getFromDb(resultTable,
+                     conditions,
+                     error,
+                     showHiddenValues,
+                     positionOffset,
+                     numberOfRows,
+                     orderBy);
+}
+
+/**
+ * @brief get all rows of the table in multiple parts, which are limited by the result-limit of
+ *        the table or database. Without limit, the complete table is returned with one part.
+ *
+ * @param resultTable reference for the result of the query
+ * @param continuationToken token of the previous part, or empty string to start at the first
+ *                          row. It is replaced by the token for the next part, or by an empty
+ *                          string, if the result is complete.
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param orderBy columns to sort the result. Must be the same for all parts of one result.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::getAllFromDb(TableItem &resultTable,
+                       std::string &continuationToken,
+                       ErrorContainer &error,
+                       const bool showHiddenValues,
+                       const std::vector<OrderBy> &orderBy)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getAllFromDb",
+                     m_tableName);
+
+    return readPartFromDb(&resultTable,
+                          nullptr,
+                          continuationToken,
+                          error,
+                          showHiddenValues,
+                          orderBy);
+}
+
+/**
+ * @brief get all rows of the table in multiple parts, which are limited by the result-limit of
+ *        the table or database. Without limit, the complete table is returned with one part.
+ *
+ * @param resultTable reference for the result of the query
+ * @param continuationToken token of the previous part, or empty string to start at the first
+ *                          row. It is replaced by the token for the next part, or by an empty
+ *                          string, if the result is complete.
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param orderBy columns to sort the result. Must be the same for all parts of one result.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::getAllFromDb(SqlResult &resultTable,
+                       std::string &continuationToken,
+                       ErrorContainer &error,
+                       const bool showHiddenValues,
+                       const std::vector<OrderBy> &orderBy)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getAllFromDb",
+                     m_tableName);
+
+    return readPartFromDb(nullptr,
+                          &resultTable,
+                          continuationToken,
+                          error,
+                          showHiddenValues,
+                          orderBy);
+}
+
+/**
+ * @brief get one or more rows from table or also the complete table
+ *
+ * @param resultTable pointer to table for the resuld of the query
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param orderBy columns to sort the result. Rows with the same values are sorted by the order
+ *                of their insertion, so pagination is stable.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::getFromDb(TableItem &resultTable,
+                    const std::vector<RequestCondition> &conditions,
+                    ErrorContainer &error,
+                    const bool showHiddenValues,
+                    const uint64_t positionOffset,
+                    const uint64_t numberOfRows,
+                    const std::vector<OrderBy> &orderBy)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getFromDb",
+                     m_tableName);
+
+    SqlDatabase::ResultBudget budget;
+    budget.limit = getResultLimit();
+
+    return readFromDb(resultTable,
+                      conditions,
+                      error,
+                      showHiddenValues,
+                      positionOffset,
+                      numberOfRows,
+                      orderBy,
+                      &budget);
+}
+
+/**
+ * @brief get one or more rows from table into an arena-based result
+ *
+ * @param resultTable reference to the result of the query. Existing content will be removed.
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param orderBy columns to sort the result. Rows with the same values are sorted by the order
+ *                of their insertion, so pagination is stable.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::getFromDb(SqlResult &resultTable,
+                    const std::vector<RequestCondition> &conditions,
+                    ErrorContainer &error,
+                    const bool showHiddenValues,
+                    const uint64_t positionOffset,
+                    const uint64_t numberOfRows,
+                    const std::vector<OrderBy> &orderBy)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getFromDb",
+                     m_tableName);
+
+    SqlDatabase::ResultBudget budget;
+    budget.limit = getResultLimit();
+
+    return readFromDb(resultTable,
+                      conditions,
+                      error,
+                      showHiddenValues,
+                      positionOffset,
+                      numberOfRows,
+                      orderBy,
+                      &budget);
+}
+
+
+/**
+ * @brief get one or more rows from table
+ *
+ * @param resultTable pointer to table for the resuld of the query
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::getFromDb(JsonItem &result,
+                    const std::vector<RequestCondition> &conditions,
+                    ErrorContainer &error,
+                    const bool showHiddenValues,
+                    const uint64_t positionOffset,
+                    const uint64_t numberOfRows)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getFromDb",
+                     m_tableName);
+
+    // precheck
+    if(conditions.size() == 0)
+    {
+        error.addMeesage("no conditions given for table-access.");
+        LOG_ERROR(error);
+        return false;
+    }
+    if(checkConditions(conditions, error) == false) {
+        return false;
+    }
+
+    // run select-query, or search in memory in write-back mode
+    TableItem tableResult;
+    std::shared_lock<std::shared_mutex> writeBackGuard(m_writeBackLock);
+    if(m_writeBackCache != nullptr)
+    {
+        if(getFromCache(tableResult, conditions, error) == false) {
+            return false;
+        }
+    }
+    else
+    {
+        QueryBuffer queryBuffer;
+        std::string &command = queryBuffer.get();
+        createSelectQuery(command, conditions, positionOffset, numberOfRows);
+        if(getReadDatabase()->execSqlCommand(&tableResult, command, error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+    writeBackGuard.unlock();
+
+    // convert table-row to json
+    if(processGetResult(result, tableResult) == false)
+    {
+        error.addMeesage("no entry found in database-table '" + m_tableName + "'.");
+        // HINT: no LOG_ERROR here, because it is possible, that the getFromDb was only called to
+        // check if the entry exist within the database. In this case a false as return is a valid
+        // output and not an error
+        return false;
+    }
+
+    // remove all values, which should be hide
+    if(showHiddenValues == false)
+    {
+        for(const DbHeaderEntry &entry : m_tableHeader)
+        {
+            if(entry.hide) {
+                result.remove(entry.name);
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief get multiple rows by their primary keys. The keys are requested in chunks with one
+ *        prepared statement per chunk, instead of one request per key.
+ *
+ * @param result reference for the output. Existing content will be removed. The rows are in the
+ *               same order like the keys and there is one row for each key, which was found.
+ * @param primaryKeys primary keys of the requested rows
+ * @param missingKeys reference for the list of keys, which were not found
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param chunkSize maximum number of keys per statement. It is reduced to the maximum number of
+ *                  parameters, which is allowed by sqlite.
+ *
+ * @return false, if the table has no primary key or a query failed, else true. Missing keys are
+ *         not an error.
+ */
+bool
+SqlTable::getManyFromDb(SqlResult &result,
+                        const std::vector<std::string> &primaryKeys,
+                        std::vector<std::string> &missingKeys,
+                        ErrorContainer &error,
+                        const bool showHiddenValues,
+                        const uint32_t chunkSize)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getManyFromDb",
+                     m_tableName);
+
+    initResultColumns(result, showHiddenValues);
+    missingKeys.clear();
+
+    const long primaryKeyId = getPrimaryKeyId();
+    if(primaryKeyId == -1)
+    {
+        error.addMeesage("table '" + m_tableName + "' has no primary key");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return false;
+    }
+
+    // each key is one parameter of the statement, so a chunk can not be larger than allowed
+    const uint64_t maxChunkSize = m_db->getMaxNumberOfParameters();
+    const uint64_t step = std::max(std::min(static_cast<uint64_t>(chunkSize), maxChunkSize),
+                                   static_cast<uint64_t>(1));
+    result.reserve(primaryKeys.size());
+    SqlResult parameters;
+    SqlResult chunkResult;
+    std::map<std::string, uint64_t> rowIds;
+
+    for(uint64_t begin = 0; begin < primaryKeys.size(); begin += step)
+    {
+        const uint64_t end = std::min(begin + step, static_cast<uint64_t>(primaryKeys.size()));
+
+        // keys are bound as parameters, so they don't have to be escaped
+        parameters.clear();
+        for(uint64_t i = begin; i < end; i++) {
+            parameters.addColumn(std::to_string(i - begin), SqlResult::STRING_VALUE);
+        }
+        for(uint64_t i = begin; i < end; i++) {
+            parameters.appendString(primaryKeys.at(i).c_str(), primaryKeys.at(i).size());
+        }
+
+        QueryBuffer queryBuffer;
+        std::string &command = queryBuffer.get();
+        createManyQuery(command, end - begin);
+        initResultColumns(chunkResult, showHiddenValues);
+        SqlDatabase* db = getReadDatabase();
+        if(db->execPreparedCommand(&chunkResult, command, parameters, error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+
+        // sqlite returns the rows in any order, so sort them like the requested keys
+        rowIds.clear();
+        for(uint64_t row = 0; row < chunkResult.getNumberOfRows(); row++)
+        {
+            if(chunkResult.getType(row, primaryKeyId) == SqlResult::STRING_VALUE)
+            {
+                const std::string_view key = chunkResult.getString(row, primaryKeyId);
+                rowIds.emplace(std::string(key), row);
+            }
+            else
+            {
+                const DataItem* key = chunkResult.toDataItem(row, primaryKeyId);
+                rowIds.emplace(key->toString(), row);
+                delete key;
+            }
+        }
+
+        for(uint64_t i = begin; i < end; i++)
+        {
+            const auto it = rowIds.find(primaryKeys.at(i));
+            if(it == rowIds.end()) {
+                missingKeys.push_back(primaryKeys.at(i));
+            } else {
+                result.appendRow(chunkResult, it->second);
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Request number of rows of the database-table
+ *
+ * @param error reference for error-output
+ *
+ * @return -1 if request against database failed, else number of rows
+ */
+long
+SqlTable::getNumberOfRows(ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "getNumberOfRows",
+                     m_tableName);
+
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return -1;
+    }
+
+    Kitsunemimi::TableItem resultItem;
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createCountQuery(command);
+    if(getReadDatabase()->execSqlCommand(&resultItem, command, error) == false) {
+        return -1;
+    }
+
+    return resultItem.getBody()->get(0)->get(0)->toValue()->getLong();
+}
+
+/**
+ * @brief calculate aggregates within sqlite, so only the results are transfered instead of all
+ *        rows. The result has one column per group-by column, followed by one column per
+ *        aggregate, and one row per group, sorted by the group-by columns.
+ *        COUNT is always an int, AVG always a float and SUM, MIN and MAX have the type of their
+ *        column. Without any matching row, SUM, AVG, MIN and MAX are null.
+ *
+ * @param result reference for the output
+ * @param conditions conditions to filter table
+ * @param groupBy columns to group the rows. If empty, the complete table is one group.
+ * @param aggregates aggregates to calculate for each group
+ * @param error reference for error-output
+ *
+ * @return false, if a column doesn't exist, an aggregate doesn't fit the type of its column or
+ *         the query failed, else true
+ */
+bool
+SqlTable::aggregateFromDb(SqlResult &result,
+                          const std::vector<RequestCondition> &conditions,
+                          const std::vector<std::string> &groupBy,
+                          const std::vector<Aggregate> &aggregates,
+                          ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "aggregateFromDb",
+                     m_tableName);
+
+    if(aggregates.size() == 0)
+    {
+        error.addMeesage("no aggregates given for table '" + m_tableName + "'");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(checkConditions(conditions, error) == false) {
+        return false;
+    }
+
+    if(initAggregateColumns(result, groupBy, aggregates, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return false;
+    }
+
+    if(getReadDatabase()->execSqlCommand(result,
+                            createAggregateQuery(conditions, groupBy, aggregates),
+                            error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief search rows with the full-text search-index of the table. The search-text is searched
+ *        as substring within all searchable columns and the results are sorted by relevance.
+ *        Search-texts with less than 3 characters can not use the index and are slower.
+ *
+ * @param result reference for the output
+ * @param searchText text to search
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ *
+ * @return false, if the table has no searchable columns or the query failed, else true
+ */
+bool
+SqlTable::searchInDb(SqlResult &result,
+                     const std::string &searchText,
+                     ErrorContainer &error,
+                     const bool showHiddenValues,
+                     const uint64_t positionOffset,
+                     const uint64_t numberOfRows)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "searchInDb",
+                     m_tableName);
+
+    const std::string query = createSearchQuery(searchText, positionOffset, numberOfRows);
+    if(query.empty())
+    {
+        error.addMeesage("table '" + m_tableName + "' has no searchable columns");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return false;
+    }
+
+    initResultColumns(result, showHiddenValues);
+    if(getReadDatabase()->execSqlCommand(result, query, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief join the rows of the table with the rows of another table of the same database within
+ *        one query, so sqlite can use the indexes of the key-columns instead of requesting the
+ *        matching rows of the other table one by one. The result contains the selected columns
+ *        of the table followed by the selected columns of the other table.
+ *
+ * @param result reference for the output. Existing content will be removed.
+ * @param conditions conditions to filter the rows of the table
+ * @param join other table, key-columns, conditions and columns of the join
+ * @param error reference for error-output
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ *
+ * @return false, if the other table is invalid, a column doesn't exist or the query failed,
+ *         else true
+ */
+bool
+SqlTable::joinFromDb(SqlResult &result,
+                     const std::vector<RequestCondition> &conditions,
+                     const Join &join,
+                     ErrorContainer &error,
+                     const uint64_t positionOffset,
+                     const uint64_t numberOfRows)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "joinFromDb",
+                     m_tableName);
+
+    result.clear();
+
+    SqlTable* otherTable = join.otherTable;
+    if(otherTable == nullptr
+            || otherTable == this
+            || otherTable->m_db != m_db)
+    {
+        error.addMeesage("table '" + m_tableName + "' can only be joined with another table "
+                         "of the same database");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // check key-columns and collect the columns of the result. Compressed columns can not be
+    // keys, because the compressed values would be compared.
+    std::vector<const DbHeaderEntry*> columns;
+    std::vector<const DbHeaderEntry*> otherColumns;
+    const long columnId = getColumnId(join.colName);
+    const long otherColumnId = otherTable->getColumnId(join.otherColName);
+    if(columnId == -1
+            || otherColumnId == -1
+            || m_tableHeader.at(columnId).isCompressed
+            || otherTable->m_tableHeader.at(otherColumnId).isCompressed
+            || getJoinColumns(join.columns, columns, error) == false
+            || otherTable->getJoinColumns(join.otherColumns, otherColumns, error) == false)
+    {
+        error.addMeesage("join of table '" + m_tableName + "' with table '"
+                         + otherTable->m_tableName + "' has invalid columns");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(checkConditions(conditions, error) == false
+            || otherTable->checkConditions(join.otherConditions, error) == false)
+    {
+        return false;
+    }
+
+    for(const DbHeaderEntry* entry : columns) {
+        result.addColumn(entry->name, getResultType(entry->type));
+    }
+    for(const DbHeaderEntry* entry : otherColumns)
+    {
+        result.addColumn(otherTable->m_tableName + "_" + entry->name,
+                         getResultType(entry->type));
+    }
+
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false
+            || otherTable->flushWriteBack(error) == false)
+    {
+        return false;
+    }
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createJoinQuery(command,
+                    conditions,
+                    join,
+                    columns,
+                    otherColumns,
+                    positionOffset,
+                    numberOfRows);
+    if(getReadDatabase()->execSqlCommand(result, command, error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief request the query-plan, which sqlite uses for a get-request with the given conditions,
+ *        to check if the request can use an index
+ *
+ * @param conditions conditions to filter table
+ * @param plan reference for the output
+ * @param error reference for error-output
+ * @param orderBy columns to sort the result
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::explainGetFromDb(const std::vector<RequestCondition> &conditions,
+                           SqlDatabase::QueryPlan &plan,
+                           ErrorContainer &error,
+                           const std::vector<OrderBy> &orderBy)
+{
+    if(checkConditions(conditions, error) == false
+            || checkOrderBy(orderBy, error) == false)
+    {
+        return false;
+    }
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createSelectQuery(command, conditions, 0, 0, orderBy);
+    return m_db->explainQuery(command, plan, error);
+}
+
+/**
+ * @brief delete all entries for the table
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::deleteAllFromDb(ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "deleteAllFromDb",
+                     m_tableName);
+
+    const std::vector<RequestCondition> conditions;
+
+    // in write-back mode the rows are only deleted in memory
+    std::shared_lock<std::shared_mutex> writeBackGuard(m_writeBackLock);
+    if(m_writeBackCache != nullptr)
+    {
+        const std::vector<std::pair<uint64_t, std::string>> cacheConditions;
+        publishChanges(ChangeEvent::DELETE_CHANGE, m_writeBackCache->deleteRows(cacheConditions));
+        requestFlushIfNeeded();
+        return true;
+    }
+    writeBackGuard.unlock();
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createDeleteQuery(command, conditions);
+    return runMutation(command, ChangeEvent::DELETE_CHANGE, error);
+}
+
+/**
+ * @brief delete one of more rows from database
+ *
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::deleteFromDb(const std::vector<RequestCondition> &conditions,
+                       ErrorContainer &error)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "deleteFromDb",
+                     m_tableName);
+
+    // precheck
+    if(conditions.size() == 0)
+    {
+        error.addMeesage("no conditions given for table-access.");
+        LOG_ERROR(error);
+        return false;
+    }
+    if(checkConditions(conditions, error) == false) {
+        return false;
+    }
+
+    // in write-back mode the rows are only deleted in memory
+    std::shared_lock<std::shared_mutex> writeBackGuard(m_writeBackLock);
+    if(m_writeBackCache != nullptr)
+    {
+        std::vector<std::pair<uint64_t, std::string>> cacheConditions;
+        if(convertConditions(conditions, cacheConditions, error) == false) {
+            return false;
+        }
+
+        publishChanges(ChangeEvent::DELETE_CHANGE, m_writeBackCache->deleteRows(cacheConditions));
+        requestFlushIfNeeded();
+        return true;
+    }
+    writeBackGuard.unlock();
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createDeleteQuery(command, conditions);
+    return runMutation(command, ChangeEvent::DELETE_CHANGE, error);
+}
+
+/**
+ * @brief export the content of the table as columnar snapshot into a file. The table is read in
+ *        multiple steps, so the database is not blocked for the whole export. Because of this,
+ *        changes, which are done while the export is running, can be partially included.
+ *
+ * @param filePath path of the new snapshot-file
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param rowsPerStep number of rows to read from the database with one request
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::exportSnapshot(const std::string &filePath,
+                         ErrorContainer &error,
+                         const bool showHiddenValues,
+                         const uint64_t rowsPerStep)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "exportSnapshot",
+                     m_tableName);
+
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return false;
+    }
+
+    // precheck
+    if(rowsPerStep == 0)
+    {
+        error.addMeesage("number of rows per step for the export must be greater than 0.");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    // the rowid is added as last hidden column to continue the reading after the last row
+    SqlResult content;
+    initResultColumns(content, showHiddenValues);
+    content.addColumn("rowid", SqlResult::INT_VALUE, true);
+    const uint64_t rowIdColumn = m_tableHeader.size();
+
+    int64_t lastRowId = INT64_MIN;
+    while(true)
+    {
+        const uint64_t oldNumberOfRows = content.getNumberOfRows();
+        if(m_db->execSqlCommand(content,
+                                createSnapshotQuery(lastRowId, rowsPerStep),
+                                error) == false)
+        {
+            LOG_ERROR(error);
+            return false;
+        }
+
+        const uint64_t newNumberOfRows = content.getNumberOfRows();
+        if(newNumberOfRows - oldNumberOfRows < rowsPerStep) {
+            break;
+        }
+        lastRowId = content.getInt(newNumberOfRows - 1, rowIdColumn);
+    }
+
+    if(TableSnapshot::writeSnapshot(filePath, content, error) == false)
+    {
+        error.addMeesage("export of table '" + m_tableName + "' failed");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief import rows from a csv- or json-lines-input into the table. The input is read in chunks
+ *        and the rows are inserted with a prepared statement in transactions of limited size, so
+ *        the used memory doesn't depend on the size of the input. Csv-input must begin with a
+ *        header-line with the names of the columns. If an invalid row is found, the import stops
+ *        and all rows of the current transaction are not inserted.
+ *
+ * @param fd file-descriptor to read the input from
+ * @param format format of the input
+ * @param error reference for error-output
+ * @param rowsPerTransaction maximum number of rows to insert within one transaction
+ *
+ * @return -1 if the import failed, else number of imported rows
+ */
+long
+SqlTable::importFromFile(const int fd,
+                         const ImportFormat format,
+                         ErrorContainer &error,
+                         const uint64_t rowsPerTransaction)
+{
+    TraceScope trace(m_db->getTraceHook(),
+                     TraceSpan::OPERATION_SPAN,
+                     "importFromFile",
+                     m_tableName);
+
+    // precheck
+    if(rowsPerTransaction == 0)
+    {
+        error.addMeesage("number of rows per transaction for the import must be greater than 0.");
+        LOG_ERROR(error);
+        return -1;
+    }
+    {
+        std::shared_lock<std::shared_mutex> guard(m_writeBackLock);
+        if(m_writeBackCache != nullptr)
+        {
+            error.addMeesage("import is not supported in write-back mode.");
+            LOG_ERROR(error);
+            return -1;
+        }
+    }
+
+    std::vector<std::string> columnNames;
+    for(const DbHeaderEntry &entry : m_tableHeader) {
+        columnNames.push_back(entry.name);
+    }
+
+    RowParser::Format parserFormat = RowParser::CSV_FORMAT;
+    if(format == JSON_LINES_IMPORT) {
+        parserFormat = RowParser::JSON_LINES_FORMAT;
+    }
+    RowParser parser(parserFormat, columnNames);
+
+    const std::string insertQuery = createPreparedInsertQuery();
+    const long primaryKeyId = getPrimaryKeyId();
+    SqlResult rows;
+    initResultColumns(rows, true);
+
+    std::vector<RowField> fields;
+    std::vector<char> chunk(64 * 1024);
+    std::string buffer;
+    uint64_t recordNumber = 0;
+    long numberOfImportedRows = 0;
+    bool endOfInput = false;
+
+    while(endOfInput == false)
+    {
+        // read next chunk
+        const ssize_t readBytes = read(fd, chunk.data(), chunk.size());
+        if(readBytes < 0)
+        {
+            if(errno == EINTR) {
+                continue;
+            }
+
+            error.addMeesage("failed to read input for import into table '" + m_tableName + "'");
+            LOG_ERROR(error);
+            return -1;
+        }
+
+        if(readBytes == 0) {
+            endOfInput = true;
+        } else {
+            buffer.append(chunk.data(), readBytes);
+        }
+
+        // process all complete records of the buffer
+        uint64_t pos = 0;
+        while(pos < buffer.size())
+        {
+            std::string_view record(buffer.data() + pos, buffer.size() - pos);
+            const long recordEnd = parser.findRecordEnd(record);
+            if(recordEnd == -1)
+            {
+                // incomplete record at the end of the buffer has to wait for the next chunk
+                if(endOfInput == false) {
+                    break;
+                }
+                pos = buffer.size();
+            }
+            else
+            {
+                record = record.substr(0, recordEnd);
+                pos += recordEnd + 1;
+            }
+            recordNumber++;
+
+            if(record.size() > 0
+                    && record.back() == '\r')
+            {
+                record.remove_suffix(1);
+            }
+            if(record.size() == 0) {
+                continue;
+            }
+
+            bool success = false;
+            if(parser.needHeader()) {
+                success = parser.parseHeader(record, error);
+            } else {
+                success = parser.parseRecord(record, fields, error)
+                          && appendImportRow(rows, fields, error);
+            }
+
+            if(success == false)
+            {
+                error.addMeesage("import into table '"
+                                 + m_tableName
+                                 + "' failed at record "
+                                 + std::to_string(recordNumber));
+                LOG_ERROR(error);
+                return -1;
+            }
+
+            // write full transaction
+            if(rows.getNumberOfRows() >= rowsPerTransaction)
+            {
+                if(flushImportRows(insertQuery, rows, primaryKeyId, error) == false)
+                {
+                    LOG_ERROR(error);
+                    return -1;
+                }
+                numberOfImportedRows += rows.getNumberOfRows();
+                rows.clearRows();
+            }
+        }
+
+        buffer.erase(0, pos);
+    }
+
+    // write remaining rows
+    if(rows.getNumberOfRows() > 0)
+    {
+        if(flushImportRows(insertQuery, rows, primaryKeyId, error) == false)
+        {
+            LOG_ERROR(error);
+            return -1;
+        }
+        numberOfImportedRows += rows.getNumberOfRows();
+    }
+
+    return numberOfImportedRows;
+}
+
+/**
+ * @brief insert values into the table asynchronously with the executor of the database
+ *
+ * @param values json-map with the values to insert
+ * @param callback callback, which is called by the executor with the result of the request
+ *
+ * @return false, if the executor of the database is not running, else true
+ */
+bool
+SqlTable::insertToDbAsync(const JsonItem &values,
+                          AsyncCallback callback)
+{
+    return runAsync(DatabaseExecutor::WRITE_TASK, [this, values, callback]() {
+        ErrorContainer error;
+        JsonItem input = values;
+        const bool success = insertToDb(input, error);
+        callback(success, error);
+    });
+}
+
+/**
+ * @brief update values within the table asynchronously with the executor of the database
+ *
+ * @param conditions conditions to filter table
+ * @param updates json-map with key-value pairs to update
+ * @param callback callback, which is called by the executor with the result of the request
+ *
+ * @return false, if the executor of the database is not running, else true
+ */
+bool
+SqlTable::updateInDbAsync(const std::vector<RequestCondition> &conditions,
+                          const JsonItem &updates,
+                          AsyncCallback callback)
+{
+    return runAsync(DatabaseExecutor::WRITE_TASK, [this, conditions, updates, callback]() {
+        ErrorContainer error;
+        const bool success = updateInDb(conditions, updates, error);
+        callback(success, error);
+    });
+}
+
+/**
+ * @brief get a row from the table asynchronously with the executor of the database
+ *
+ * @param conditions conditions to filter table
+ * @param callback callback, which is called by the executor with the result of the request
+ * @param showHiddenValues include values in output, which should normally be hidden
+ *
+ * @return false, if the executor of the database is not running, else true
+ */
+bool
+SqlTable::getFromDbAsync(const std::vector<RequestCondition> &conditions,
+                         AsyncJsonCallback callback,
+                         const bool showHiddenValues)
+{
+    return runAsync(DatabaseExecutor::READ_TASK, [this, conditions, callback, showHiddenValues]() {
+        ErrorContainer error;
+        JsonItem result;
+        const bool success = getFromDb(result, conditions, error, showHiddenValues);
+        callback(success, result, error);
+    });
+}
+
+/**
+ * @brief get all rows from table asynchronously with the executor of the database
+ *
+ * @param callback callback, which is called by the executor with the result of the request
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ *
+ * @return false, if the executor of the database is not running, else true
+ */
+bool
+SqlTable::getAllFromDbAsync(AsyncResultCallback callback,
+                            const bool showHiddenValues,
+                            const uint64_t positionOffset,
+                            const uint64_t numberOfRows)
+{
+    return runAsync(DatabaseExecutor::READ_TASK,
+                    [this, callback, showHiddenValues, positionOffset, numberOfRows]() {
+        ErrorContainer error;
+        SqlResult result;
+        const bool success = getAllFromDb(result,
+                                          error,
+                                          showHiddenValues,
+                                          positionOffset,
+                                          numberOfRows);
+        callback(success, result, error);
+    });
+}
+
+/**
+ * @brief delete rows from the table asynchronously with the executor of the database
+ *
+ * @param conditions conditions to filter table
+ * @param callback callback, which is called by the executor with the result of the request
+ *
+ * @return false, if the executor of the database is not running, else true
+ */
+bool
+SqlTable::deleteFromDbAsync(const std::vector<RequestCondition> &conditions,
+                            AsyncCallback callback)
+{
+    return runAsync(DatabaseExecutor::WRITE_TASK, [this, conditions, callback]() {
+        ErrorContainer error;
+        const bool success = deleteFromDb(conditions, error);
+        callback(success, error);
+    });
+}
+
+/**
+ * @brief get the size of a blob
+ *
+ * @param conditions conditions to filter table. They must match exactly one row.
+ * @param columnName name of the blob-column
+ * @param error reference for error-output
+ *
+ * @return -1 if request failed, else size of the blob in bytes
+ */
+long
+SqlTable::getBlobSize(const std::vector<RequestCondition> &conditions,
+                      const std::string &columnName,
+                      ErrorContainer &error)
+{
+    int64_t rowId = 0;
+    std::string primaryKey = "";
+    if(getBlobRow(conditions, columnName, rowId, primaryKey, error) == false) {
+        return -1;
+    }
+
+    return m_db->getBlobSize(m_tableName, columnName, rowId, error);
+}
+
+/**
+ * @brief read a blob in chunks without loading the complete blob into memory
+ *
+ * @param conditions conditions to filter table. They must match exactly one row.
+ * @param columnName name of the blob-column
+ * @param readCallback callback, which is called for each chunk. Returning false aborts the read.
+ * @param error reference for error-output
+ * @param chunkSize maximum number of bytes per chunk
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::readBlob(const std::vector<RequestCondition> &conditions,
+                   const std::string &columnName,
+                   SqlDatabase::BlobReadCallback readCallback,
+                   ErrorContainer &error,
+                   const uint64_t chunkSize)
+{
+    int64_t rowId = 0;
+    std::string primaryKey = "";
+    if(getBlobRow(conditions, columnName, rowId, primaryKey, error) == false) {
+        return false;
+    }
+
+    return m_db->readBlob(m_tableName, columnName, rowId, readCallback, error, chunkSize);
+}
+
+/**
+ * @brief replace a blob by new content, which is written in chunks
+ *
+ * @param conditions conditions to filter table. They must match exactly one row.
+ * @param columnName name of the blob-column
+ * @param blobSize total size of the new blob in bytes
+ * @param writeCallback callback to fill the next chunk. It has to return the number of bytes
+ *                      written into the buffer and is not allowed to access the database.
+ * @param error reference for error-output
+ * @param chunkSize maximum number of bytes per chunk
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::writeBlob(const std::vector<RequestCondition> &conditions,
+                    const std::string &columnName,
+                    const uint64_t blobSize,
+                    SqlDatabase::BlobWriteCallback writeCallback,
+                    ErrorContainer &error,
+                    const uint64_t chunkSize)
+{
+    int64_t rowId = 0;
+    std::string primaryKey = "";
+    if(getBlobRow(conditions, columnName, rowId, primaryKey, error) == false) {
+        return false;
+    }
+
+    if(m_db->writeBlob(m_tableName,
+                       columnName,
+                       rowId,
+                       blobSize,
+                       writeCallback,
+                       error,
+                       chunkSize) == false)
+    {
+        return false;
+    }
+
+    publishChanges(ChangeEvent::UPDATE_CHANGE, {primaryKey});
+
+    return true;
+}
+
+/**
  * @brief create a sql-query to create a table
  *
  * @return created sql-query
  */
 const std::string
-SqlTable::createTableCreateQuery()
+SqlTable::createTableCreateQuery()
+{
+    std::string command = "CREATE TABLE IF NOT EXISTS ";
+    command.append(m_tableName);
+    command.append(" (");
+
+    // create all field of the table
+    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        const DbHeaderEntry* entry = &m_tableHeader[i];
+        if(i != 0) {
+            command.append(" , ");
+        }
+        command.append(entry->name + "  ");
+
+        // set type of the value
+        switch(entry->type)
+        {
+            case STRING_TYPE:
+                if(entry->maxLength > 0)
+                {
+                    command.append("varchar(");
+                    command.append(std::to_string(entry->maxLength));
+                    command.append(") ");
+                }
+                else
+                {
+                   command.append("text ");
+                }
+                break;
+            case INT_TYPE:
+                command.append("int ");
+                break;
+            case BOOL_TYPE:
+                command.append("bool ");
+                break;
+            case FLOAT_TYPE:
+                command.append("real ");
+                break;
+            case BLOB_TYPE:
+                command.append("blob ");
+                break;
+        }
+
+        // set if key is primary key
+        if(entry->isPrimary) {
+            command.append("PRIMARY KEY ");
+        }
+
+        // set if value is not allowed to be null
+        if(entry->allowNull == false) {
+            command.append("NOT NULL ");
+        }
+    }
+
+    command.append(");");
+
+    return command;
+}
+
+/**
+ * @brief create a sql-query to get a line from the table
+ *
+ * @param command reference for the output. Existing content will be removed.
+ * @param conditions conditions to filter table
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param orderBy columns to sort the result
+ */
+void
+SqlTable::createSelectQuery(std::string &command,
+                            const std::vector<RequestCondition> &conditions,
+                            const uint64_t positionOffset,
+                            const uint64_t numberOfRows,
+                            const std::vector<OrderBy> &orderBy)
+{
+    initQueryFragments();
+
+    command.assign(m_selectPrefix);
+    appendFilter(command, conditions);
+    appendOrderBy(command, orderBy);
+
+    // limit number of results
+    if(numberOfRows > 0)
+    {
+        command.append(" LIMIT ");
+        command.append(std::to_string(numberOfRows));
+        command.append(" OFFSET ");
+        command.append(std::to_string(positionOffset));
+    }
+
+    command.append(" ;");
+}
+
+/**
+ * @brief append the order-by clause of a select-query. The rowid is added as last column, if the
+ *        primary key is not part of the order, so rows with the same values have a stable order.
+ *        It is sorted in the same direction like the last column, so an index on the columns
+ *        can still be used, because each index of sqlite is also sorted by the rowid.
+ *
+ * @param command reference to the query, where the clause should be appended
+ * @param orderBy columns to sort the result. Nothing is appended, if empty.
+ */
+void
+SqlTable::appendOrderBy(std::string &command,
+                        const std::vector<OrderBy> &orderBy)
+{
+    if(orderBy.size() == 0) {
+        return;
+    }
+
+    command.append(" ORDER BY ");
+    bool hasPrimaryKey = false;
+    for(uint32_t i = 0; i < orderBy.size(); i++)
+    {
+        const OrderBy* order = &orderBy.at(i);
+        if(i > 0) {
+            command.append(" , ");
+        }
+        command.append(order->colName);
+        command.append(order->descending ? " DESC" : " ASC");
+
+        const long columnId = getColumnId(order->colName);
+        hasPrimaryKey |= columnId != -1 && m_tableHeader.at(columnId).isPrimary;
+    }
+
+    if(hasPrimaryKey == false) {
+        command.append(orderBy.back().descending ? " , rowid DESC" : " , rowid ASC");
+    }
+}
+
+/**
+ * @brief create a sql-query to get the next part of all rows of the table. The sort-key and the
+ *        rowid of each row are added as sql-literals behind the columns of the table, so the
+ *        next part can continue behind the last row. The result is always sorted at least by the
+ *        rowid, so the order is stable over all parts.
+ *
+ * @param command reference for the output. Existing content will be removed.
+ * @param orderBy columns to sort the result
+ * @param lastKey sort-key and rowid of the last row of the previous part, or empty to start at
+ *                the first row
+ * @param numberOfRows maximum number of rows
+ */
+void
+SqlTable::createContinuationQuery(std::string &command,
+                                  const std::vector<OrderBy> &orderBy,
+                                  const std::vector<std::string> &lastKey,
+                                  const uint64_t numberOfRows)
+{
+    initQueryFragments();
+
+    command.assign("SELECT ");
+    command.append(m_columnList);
+    for(const OrderBy &order : orderBy)
+    {
+        command.append(" , quote(");
+        command.append(order.colName);
+        command.append(")");
+    }
+    command.append(" , quote(rowid) from ");
+    command.append(m_tableName);
+
+    const uint64_t sizeWithoutFilter = command.size();
+    appendFilter(command, {});
+
+    // rows behind the last row in the order of the result. NULL is smaller than all other values,
+    // so it comes first with ascending and last with descending order.
+    if(lastKey.size() > 0)
+    {
+        command.append(command.size() == sizeWithoutFilter ? " WHERE (" : " AND (");
+        const bool rowIdDescending = orderBy.size() > 0 && orderBy.back().descending;
+        for(uint64_t i = 0; i < lastKey.size(); i++)
+        {
+            const bool isRowId = i == orderBy.size();
+            const std::string &column = isRowId ? "rowid" : orderBy.at(i).colName;
+            const bool descending = isRowId ? rowIdDescending : orderBy.at(i).descending;
+            const std::string &value = lastKey.at(i);
+
+            if(i > 0) {
+                command.append(" OR ");
+            }
+            command.append("(");
+            for(uint64_t j = 0; j < i; j++)
+            {
+                command.append(orderBy.at(j).colName);
+                command.append(" IS ");
+                command.append(lastKey.at(j));
+                command.append(" AND ");
+            }
+
+            if(value == "NULL") {
+                command.append(descending ? "0" : column + " IS NOT NULL");
+            } else if(descending) {
+                command.append("(" + column + " < " + value + " OR " + column + " IS NULL)");
+            } else {
+                command.append(column + " > " + value);
+            }
+            command.append(")");
+        }
+        command.append(")");
+
+        // additional range for the first column, so an index on it can be used to find the start
+        if(orderBy.size() > 0
+                && orderBy.front().descending == false
+                && lastKey.front() != "NULL")
+        {
+            command.append(" AND " + orderBy.front().colName + " >= " + lastKey.front());
+        }
+    }
+
+    if(orderBy.size() > 0) {
+        appendOrderBy(command, orderBy);
+    } else {
+        command.append(" ORDER BY rowid ASC");
+    }
+
+    command.append(" LIMIT ");
+    command.append(std::to_string(numberOfRows));
+    command.append(" ;");
+}
+
+/**
+ * @brief create a sql-query to update values within the table
+ *
+ * @param command reference for the output. Existing content will be removed.
+ * @param conditions conditions to filter table
+ * @param updates json-map with key-value pairs to update
+ */
+void
+SqlTable::createUpdateQuery(std::string &command,
+                            const std::vector<RequestCondition> &conditions,
+                            const JsonItem &updates)
+{
+    initQueryFragments();
+
+    // add set-section
+    command.assign(m_updatePrefix);
+    const std::vector<std::string> keys = updates.getKeys();
+    for(uint32_t i = 0; i < keys.size(); i++)
+    {
+        if(i > 0) {
+            command.append(" , ");
+        }
+        const long columnId = getColumnId(keys.at(i));
+        command.append(keys.at(i));
+        command.append("=");
+        appendValue(command,
+                    columnId == -1 ? nullptr : &m_tableHeader.at(columnId),
+                    updates.getItemContent()->get(keys.at(i)));
+        command.append(" ");
+    }
+
+    // each update creates a new version of the rows
+    const long versionColumnId = getVersionColumnId();
+    if(versionColumnId != -1
+            && std::find(keys.begin(), keys.end(), m_tableHeader.at(versionColumnId).name)
+               == keys.end())
+    {
+        const std::string &versionName = m_tableHeader.at(versionColumnId).name;
+        if(keys.size() > 0) {
+            command.append(" , ");
+        }
+        command.append(versionName + "=" + versionName + "+1 ");
+    }
+
+    // add where-section
+    if(conditions.size() > 0)
+    {
+        command.append(" WHERE ");
+
+        for(uint32_t i = 0; i < conditions.size(); i++)
+        {
+            if(i > 0) {
+                command.append(" AND ");
+            }
+            const RequestCondition* condition = &conditions.at(i);
+            command.append(condition->colName);
+            command.append("='");
+            command.append(condition->value);
+            command.append("' ");
+        }
+    }
+    command.append(" ;");
+}
+
+/**
+ * @brief create a sql-query to insert values into the table
+ *
+ * @param command reference for the output. Existing content will be removed.
+ * @param values json-map with the values to insert. Missing values are inserted as empty
+ *               string, if the column has no default-value.
+ */
+void
+SqlTable::createInsertQuery(std::string &command,
+                            const JsonItem &values)
+{
+    initQueryFragments();
+
+    // fields are already part of the prefix
+    command.assign(m_insertPrefix);
+
+    // create values
+    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        if(i != 0) {
+            command.append(" , ");
+        }
+        const DbHeaderEntry &entry = m_tableHeader[i];
+        const DataItem* value = nullptr;
+        if(values.getItemContent() != nullptr) {
+            value = values.getItemContent()->get(entry.name);
+        }
+
+        // blobs are created empty and have to be written with writeBlob
+        if(entry.type == BLOB_TYPE)
+        {
+            command.append("zeroblob(0)");
+            continue;
+        }
+
+        // new rows expire after the time-to-live, if no expiry-time is given
+        if(entry.timeToLive > 0
+                && value == nullptr)
+        {
+            appendValue(command, &entry, std::to_string(time(nullptr) + entry.timeToLive));
+            continue;
+        }
+
+        // new rows start with the first version
+        if(entry.isVersion)
+        {
+            appendValue(command, &entry, "1");
+            continue;
+        }
+
+        appendValue(command, &entry, value);
+    }
+
+    command.append(" );");
+}
+
+/**
+ * @brief create a sql-query to insert values into the table with a prepared statement
+ *
+ * @param updateExisting true to update rows with the same primary key. This is done with an
+ *                       upsert instead of a replace, so update-triggers are called.
+ *
+ * @return created sql-query with one parameter per column
+ */
+const std::string
+SqlTable::createPreparedInsertQuery(const bool updateExisting)
+{
+    std::string command = "INSERT INTO ";
+    command.append(m_tableName);
+    command.append("(");
+
+    // create fields
+    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        if(i != 0) {
+            command.append(" , ");
+        }
+        command.append(m_tableHeader[i].name);
+    }
+
+    // create placeholder
+    command.append(") VALUES (");
+    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        if(i != 0) {
+            command.append(" , ");
+        }
+        if(m_tableHeader[i].isCompressed) {
+            command.append(COMPRESS_FUNCTION + "(?)");
+        } else {
+            command.append("?");
+        }
+    }
+    command.append(" )");
+
+    if(updateExisting)
+    {
+        command.append(" ON CONFLICT(");
+        command.append(m_tableHeader.at(getPrimaryKeyId()).name);
+        command.append(") DO UPDATE SET ");
+        for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+        {
+            if(i != 0) {
+                command.append(" , ");
+            }
+            command.append(m_tableHeader[i].name + "=excluded." + m_tableHeader[i].name);
+        }
+    }
+    command.append(" ;");
+
+    return command;
+}
+
+/**
+ * @brief create query to delete a row by its primary key with a prepared statement
+ *
+ * @return created sql-query with the primary key as parameter
+ */
+const std::string
+SqlTable::createPreparedDeleteQuery()
+{
+    std::string command  = "DELETE FROM ";
+    command.append(m_tableName);
+    command.append(" WHERE ");
+    command.append(m_tableHeader.at(getPrimaryKeyId()).name);
+    command.append("=? ;");
+
+    return command;
+}
+
+/**
+ * @brief create query to delete rows from table
+ *
+ * @param command reference for the output. Existing content will be removed.
+ * @param conditions conditions to filter table
+ */
+void
+SqlTable::createDeleteQuery(std::string &command,
+                            const std::vector<RequestCondition> &conditions)
+{
+    initQueryFragments();
+
+    command.assign(m_deletePrefix);
+
+    if(conditions.size() > 0)
+    {
+        command.append(" WHERE ");
+
+        for(uint32_t i = 0; i < conditions.size(); i++)
+        {
+            if(i > 0) {
+                command.append(" AND ");
+            }
+            const RequestCondition* condition = &conditions.at(i);
+            command.append(condition->colName);
+            command.append("='");
+            command.append(condition->value);
+            command.append("' ");
+        }
+    }
+    command.append(" ;");
+}
+
+/**
+ * @brief create a sql-query to request number of rows of the table
+ *
+ * @param command reference for the output. Existing content will be removed.
+ */
+void
+SqlTable::createCountQuery(std::string &command)
+{
+    command.assign("SELECT COUNT(*) as number_of_rows FROM ");
+    command.append(m_tableName);
+
+    // expired rows are not counted, even if they are not deleted yet
+    const std::string expiryFilter = createExpiryFilter();
+    if(expiryFilter.size() > 0)
+    {
+        command.append(" WHERE ");
+        command.append(expiryFilter);
+    }
+    command.append(";");
+}
+
+/**
+ * @brief create a sql-query to get multiple rows by their primary keys
+ *
+ * @param command reference for the output. Existing content will be removed.
+ * @param numberOfKeys number of keys, which are bound as parameters to the query
+ */
+void
+SqlTable::createManyQuery(std::string &command,
+                          const uint64_t numberOfKeys)
+{
+    initQueryFragments();
+
+    command.assign(m_selectPrefix);
+    command.append(" WHERE ");
+    command.append(m_tableHeader.at(getPrimaryKeyId()).name);
+    command.append(" IN (");
+    for(uint64_t i = 0; i < numberOfKeys; i++)
+    {
+        if(i > 0) {
+            command.append(" , ");
+        }
+        command.append("?");
+    }
+    command.append(")");
+
+    // expired rows are hidden, even if they are not deleted yet
+    const std::string expiryFilter = createExpiryFilter();
+    if(expiryFilter.size() > 0)
+    {
+        command.append(" AND ");
+        command.append(expiryFilter);
+    }
+    command.append(" ;");
+}
+
+/**
+ * @brief create a sql-query to join the table with another table. Conditions of the other table
+ *        are part of the join-constraint, so they also work for rows without matching row.
+ *
+ * @param command reference for the output. Existing content will be removed.
+ * @param conditions conditions to filter the rows of the table
+ * @param join other table, key-columns and conditions of the join
+ * @param columns columns of the table for the result
+ * @param otherColumns columns of the other table for the result
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ */
+void
+SqlTable::createJoinQuery(std::string &command,
+                          const std::vector<RequestCondition> &conditions,
+                          const Join &join,
+                          const std::vector<const DbHeaderEntry*> &columns,
+                          const std::vector<const DbHeaderEntry*> &otherColumns,
+                          const uint64_t positionOffset,
+                          const uint64_t numberOfRows)
+{
+    const std::string &otherName = join.otherTable->m_tableName;
+
+    // add columns of both tables with the name of their table, so equal names are no problem
+    command.assign("SELECT ");
+    for(uint32_t i = 0; i < columns.size() + otherColumns.size(); i++)
+    {
+        const bool isOther = i >= columns.size();
+        const DbHeaderEntry* entry = isOther ? otherColumns.at(i - columns.size()) : columns.at(i);
+        const std::string &tableName = isOther ? otherName : m_tableName;
+        if(i > 0) {
+            command.append(" , ");
+        }
+        command.append(createColumnExpression(*entry, tableName + "."));
+        command.append(" AS ");
+        command.append(isOther ? otherName + "_" + entry->name : entry->name);
+    }
+
+    // add join-constraint
+    command.append(" FROM ");
+    command.append(m_tableName);
+    command.append(join.keepUnmatched ? " LEFT JOIN " : " JOIN ");
+    command.append(otherName);
+    command.append(" ON " + m_tableName + "." + join.colName);
+    command.append(" = " + otherName + "." + join.otherColName);
+    for(const RequestCondition &condition : join.otherConditions)
+    {
+        command.append(" AND " + otherName + "." + condition.colName);
+        command.append("='" + condition.value + "'");
+    }
+    const std::string otherExpiryFilter = join.otherTable->createExpiryFilter(otherName + ".");
+    if(otherExpiryFilter.size() > 0) {
+        command.append(" AND " + otherExpiryFilter);
+    }
+
+    // add where-section
+    const std::string expiryFilter = createExpiryFilter(m_tableName + ".");
+    for(uint32_t i = 0; i < conditions.size(); i++)
+    {
+        command.append(i == 0 ? " WHERE " : " AND ");
+        command.append(m_tableName + "." + conditions.at(i).colName);
+        command.append("='" + conditions.at(i).value + "'");
+    }
+    if(expiryFilter.size() > 0)
+    {
+        command.append(conditions.size() == 0 ? " WHERE " : " AND ");
+        command.append(expiryFilter);
+    }
+
+    // sort by the order of insertion, so pagination is stable
+    command.append(" ORDER BY " + m_tableName + ".rowid");
+    if(numberOfRows > 0)
+    {
+        command.append(" LIMIT ");
+        command.append(std::to_string(numberOfRows));
+        command.append(" OFFSET ");
+        command.append(std::to_string(positionOffset));
+    }
+
+    command.append(" ;");
+}
+
+/**
+ * @brief create a sql-query to calculate aggregates over the table
+ *
+ * @param conditions conditions to filter table
+ * @param groupBy columns to group the rows
+ * @param aggregates aggregates to calculate for each group
+ *
+ * @return created sql-query
+ */
+const std::string
+SqlTable::createAggregateQuery(const std::vector<RequestCondition> &conditions,
+                               const std::vector<std::string> &groupBy,
+                               const std::vector<Aggregate> &aggregates)
+{
+    std::string command = "SELECT ";
+    for(const std::string &column : groupBy)
+    {
+        command.append(column);
+        command.append(" , ");
+    }
+
+    for(uint32_t i = 0; i < aggregates.size(); i++)
+    {
+        const Aggregate* aggregate = &aggregates.at(i);
+        if(i > 0) {
+            command.append(" , ");
+        }
+
+        switch(aggregate->function)
+        {
+            case COUNT_AGGREGATE:
+                command.append("COUNT(");
+                break;
+            case SUM_AGGREGATE:
+                command.append("SUM(");
+                break;
+            case AVG_AGGREGATE:
+                command.append("AVG(");
+                break;
+            case MIN_AGGREGATE:
+                command.append("MIN(");
+                break;
+            case MAX_AGGREGATE:
+                command.append("MAX(");
+                break;
+        }
+
+        if(aggregate->colName.empty()) {
+            command.append("*");
+        } else {
+            command.append(aggregate->colName);
+        }
+        command.append(")");
+    }
+
+    command.append(" FROM ");
+    command.append(m_tableName);
+    appendFilter(command, conditions);
+
+    // group and sort by the same columns, so the groups have a stable order
+    if(groupBy.size() > 0)
+    {
+        std::string groupColumns = "";
+        for(uint32_t i = 0; i < groupBy.size(); i++)
+        {
+            if(i > 0) {
+                groupColumns.append(" , ");
+            }
+            groupColumns.append(groupBy.at(i));
+        }
+        command.append(" GROUP BY " + groupColumns + " ORDER BY " + groupColumns);
+    }
+
+    command.append(" ;");
+
+    return command;
+}
+
+/**
+ * @brief append the where-clause for the conditions of a request. Expired rows are always
+ *        filtered out.
+ *
+ * @param filter reference to the query, where the clause should be appended
+ * @param conditions conditions to filter table
+ */
+void
+SqlTable::appendFilter(std::string &filter,
+                       const std::vector<RequestCondition> &conditions)
+{
+    const std::string expiryFilter = createExpiryFilter();
+
+    if(conditions.size() > 0
+            || expiryFilter.size() > 0)
+    {
+        filter.append(" WHERE ");
+
+        for(uint32_t i = 0; i < conditions.size(); i++)
+        {
+            if(i > 0) {
+                filter.append(" AND ");
+            }
+            const RequestCondition* condition = &conditions.at(i);
+            filter.append(condition->colName);
+            filter.append("='");
+            filter.append(condition->value);
+            filter.append("' ");
+        }
+
+        // expired rows are hidden, even if they are not deleted yet
+        if(expiryFilter.size() > 0)
+        {
+            if(conditions.size() > 0) {
+                filter.append(" AND ");
+            }
+            filter.append(expiryFilter);
+        }
+    }
+}
+
+/**
+ * @brief create the full-text search-index for all searchable columns together with the triggers,
+ *        which keep the index in sync with the table. The index uses the trigram-tokenizer, so it
+ *        can be used to search for substrings.
+ *
+ * @return empty string, if the table has no searchable columns, else created sql-query
+ */
+const std::string
+SqlTable::createSearchIndexQuery()
+{
+    std::string columns = "";
+    std::string newValues = "";
+    std::string oldValues = "";
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        if(entry.isSearchable == false) {
+            continue;
+        }
+        columns.append(" , " + entry.name);
+        newValues.append(" , new." + entry.name);
+        oldValues.append(" , old." + entry.name);
+    }
+    if(columns.empty()) {
+        return "";
+    }
+
+    const std::string index = m_tableName + "_search";
+    const std::string insertNew = "INSERT INTO " + index + "(rowid" + columns + ") "
+                                  "VALUES (new.rowid" + newValues + "); ";
+    const std::string deleteOld = "INSERT INTO " + index + "(" + index + " , rowid" + columns
+                                  + ") VALUES ('delete' , old.rowid" + oldValues + "); ";
+
+    std::string command = "CREATE VIRTUAL TABLE IF NOT EXISTS " + index
+                          + " USING fts5(" + columns.substr(3)
+                          + " , content='" + m_tableName + "' , content_rowid='rowid'"
+                          + " , tokenize='trigram'); ";
+    command.append("CREATE TRIGGER IF NOT EXISTS " + index + "_insert AFTER INSERT ON "
+                   + m_tableName + " BEGIN " + insertNew + "END; ");
+    command.append("CREATE TRIGGER IF NOT EXISTS " + index + "_delete AFTER DELETE ON "
+                   + m_tableName + " BEGIN " + deleteOld + "END; ");
+    command.append("CREATE TRIGGER IF NOT EXISTS " + index + "_update AFTER UPDATE ON "
+                   + m_tableName + " BEGIN " + deleteOld + insertNew + "END;");
+
+    return command;
+}
+
+/**
+ * @brief create a sql-query to search rows with the full-text search-index
+ *
+ * @param searchText text to search
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ *
+ * @return empty string, if the table has no searchable columns, else created sql-query
+ */
+const std::string
+SqlTable::createSearchQuery(const std::string &searchText,
+                            const uint64_t positionOffset,
+                            const uint64_t numberOfRows)
+{
+    const std::string index = m_tableName + "_search";
+
+    // columns of the table have to be named explicitly, because the index has the same names
+    std::string command = "SELECT ";
+    bool hasSearchableColumn = false;
+    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        const DbHeaderEntry* entry = &m_tableHeader[i];
+        if(i != 0) {
+            command.append(" , ");
+        }
+        command.append(createColumnExpression(*entry, m_tableName + "."));
+        if(entry->type == BLOB_TYPE
+                || entry->isCompressed)
+        {
+            command.append(" AS " + entry->name);
+        }
+
+        hasSearchableColumn |= entry->isSearchable;
+    }
+    if(hasSearchableColumn == false) {
+        return "";
+    }
+
+    command.append(" FROM " + m_tableName + " JOIN " + index);
+    command.append(" ON " + m_tableName + ".rowid = " + index + ".rowid WHERE ");
+
+    // the trigram-index can only be used for texts with at least 3 characters, so shorter texts
+    // are searched with like-patterns over the index
+    uint64_t numberOfCharacters = 0;
+    for(const char c : searchText) {
+        numberOfCharacters += (c & 0xC0) != 0x80;
+    }
+    const bool useIndex = numberOfCharacters >= 3;
+
+    // quote the text for sql and escape special characters of the search-syntax
+    std::string escapedText = "";
+    for(const char c : searchText)
+    {
+        if(c == '\'') {
+            escapedText.append("''");
+        } else if(useIndex && c == '"') {
+            escapedText.append("\"\"");
+        } else if(useIndex == false && (c == '%' || c == '_' || c == '\\')) {
+            escapedText.push_back('\\');
+            escapedText.push_back(c);
+        } else {
+            escapedText.push_back(c);
+        }
+    }
+
+    if(useIndex)
+    {
+        command.append(index + " MATCH '\"" + escapedText + "\"'");
+    }
+    else
+    {
+        std::string filter = "";
+        for(const DbHeaderEntry &entry : m_tableHeader)
+        {
+            if(entry.isSearchable == false) {
+                continue;
+            }
+            filter.append(filter.empty() ? "(" : " OR ");
+            filter.append(index + "." + entry.name + " LIKE '%" + escapedText + "%' ESCAPE '\\'");
+        }
+        command.append(filter + ")");
+    }
+
+    // expired rows are hidden, even if they are not deleted yet
+    const std::string expiryFilter = createExpiryFilter();
+    if(expiryFilter.size() > 0) {
+        command.append(" AND " + expiryFilter);
+    }
+
+    if(useIndex) {
+        command.append(" ORDER BY " + index + ".rank");
+    } else {
+        command.append(" ORDER BY " + m_tableName + ".rowid");
+    }
+
+    // limit number of results
+    if(numberOfRows > 0)
+    {
+        command.append(" LIMIT ");
+        command.append(std::to_string(numberOfRows));
+        command.append(" OFFSET ");
+        command.append(std::to_string(positionOffset));
+    }
+
+    command.append(" ;");
+
+    return command;
+}
+
+/**
+ * @brief create a sql-query to read the next rows of the table ordered by their rowid
+ *
+ * @param lastRowId rowid of the last already read row
+ * @param numberOfRows maximum number of rows to read
+ *
+ * @return created sql-query
+ */
+const std::string
+SqlTable::createSnapshotQuery(const int64_t lastRowId,
+                              const uint64_t numberOfRows)
+{
+    std::string command = "SELECT ";
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        command.append(createColumnExpression(entry));
+        if(entry.type == BLOB_TYPE
+                || entry.isCompressed)
+        {
+            command.append(" AS " + entry.name);
+        }
+        command.append(" , ");
+    }
+    command.append("rowid FROM ");
+    command.append(m_tableName);
+    command.append(" WHERE rowid > ");
+    command.append(std::to_string(lastRowId));
+    const std::string expiryFilter = createExpiryFilter();
+    if(expiryFilter.size() > 0) {
+        command.append(" AND " + expiryFilter);
+    }
+    command.append(" ORDER BY rowid LIMIT ");
+    command.append(std::to_string(numberOfRows));
+    command.append(" ;");
+
+    return command;
+}
+
+/**
+ * @brief create the fixed parts of the select-, insert-, update- and delete-queries only once,
+ *        so they don't have to be rebuilt for each request. This can not be done within the
+ *        constructor, because the table-header is filled by the constructor of the derived class.
+ */
+void
+SqlTable::initQueryFragments()
+{
+    std::call_once(m_queryFragmentsInit, [this]
+    {
+        m_columnList = createColumnList();
+        m_selectPrefix = "SELECT " + m_columnList + " from " + m_tableName;
+
+        m_insertPrefix = "INSERT INTO " + m_tableName + "(";
+        for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+        {
+            if(i != 0) {
+                m_insertPrefix.append(" , ");
+            }
+            m_insertPrefix.append(m_tableHeader[i].name);
+        }
+        m_insertPrefix.append(") VALUES (");
+
+        m_updatePrefix = "UPDATE " + m_tableName + " SET ";
+        m_deletePrefix = "DELETE FROM " + m_tableName;
+    });
+}
+
+/**
+ * @brief create the list of columns for select-queries. Blob-columns are replaced by the size of
+ *        the blob, so the content is not loaded into the result, and compressed columns are
+ *        decompressed.
+ *
+ * @return list of columns, or '*' if the table has no blob- or compressed columns
+ */
+const std::string
+SqlTable::createColumnList()
+{
+    bool hasSpecialColumn = false;
+    for(const DbHeaderEntry &entry : m_tableHeader) {
+        hasSpecialColumn |= entry.type == BLOB_TYPE || entry.isCompressed;
+    }
+    if(hasSpecialColumn == false) {
+        return "*";
+    }
+
+    std::string columns = "";
+    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        const DbHeaderEntry* entry = &m_tableHeader[i];
+        if(i != 0) {
+            columns.append(" , ");
+        }
+        columns.append(createColumnExpression(*entry));
+        if(entry->type == BLOB_TYPE
+                || entry->isCompressed)
+        {
+            columns.append(" AS " + entry->name);
+        }
+    }
+
+    return columns;
+}
+
+/**
+ * @brief create the expression to select a column within a query. Blob-columns are replaced by
+ *        the size of the blob and compressed columns are decompressed. Decompression is done by
+ *        sqlite only for the rows and columns, which are part of the result.
+ *
+ * @param entry header-entry of the column
+ * @param tablePrefix prefix for the name of the column, like '<table>.' within joins
+ *
+ * @return expression without alias
+ */
+const std::string
+SqlTable::createColumnExpression(const DbHeaderEntry &entry,
+                                 const std::string &tablePrefix)
+{
+    if(entry.type == BLOB_TYPE) {
+        return "length(" + tablePrefix + entry.name + ")";
+    }
+    if(entry.isCompressed) {
+        return DECOMPRESS_FUNCTION + "(" + tablePrefix + entry.name + ")";
+    }
+
+    return tablePrefix + entry.name;
+}
+
+/**
+ * @brief append a value for insert- or update-queries. Values of compressed columns are
+ *        compressed by sqlite.
+ *
+ * @param command reference to the query, where the value should be appended
+ * @param entry header-entry of the column, or nullptr if unknown
+ * @param value value to append
+ */
+void
+SqlTable::appendValue(std::string &command,
+                      const DbHeaderEntry* entry,
+                      const std::string &value)
+{
+    const bool compress = entry != nullptr && entry->isCompressed;
+    if(compress)
+    {
+        command.append(COMPRESS_FUNCTION);
+        command.append("(");
+    }
+
+    command.append("'");
+    command.append(value);
+    command.append("'");
+
+    if(compress) {
+        command.append(")");
+    }
+}
+
+/**
+ * @brief append a value of a json-input for insert- or update-queries without copying it
+ *
+ * @param command reference to the query, where the value should be appended
+ * @param entry header-entry of the column, or nullptr if unknown
+ * @param value value to append, or nullptr to append an empty string
+ */
+void
+SqlTable::appendValue(std::string &command,
+                      const DbHeaderEntry* entry,
+                      const DataItem* value)
+{
+    const bool compress = entry != nullptr && entry->isCompressed;
+    if(compress)
+    {
+        command.append(COMPRESS_FUNCTION);
+        command.append("(");
+    }
+
+    command.append("'");
+    if(value != nullptr) {
+        value->toString(false, &command);
+    }
+    command.append("'");
+
+    if(compress) {
+        command.append(")");
+    }
+}
+
+/**
+ * @brief create the filter to hide expired rows
+ *
+ * @param tablePrefix prefix for the name of the expiry-column, like '<table>.' within joins
+ *
+ * @return empty string, if the table has no expiry-column, else filter for a where-clause
+ */
+const std::string
+SqlTable::createExpiryFilter(const std::string &tablePrefix)
+{
+    const long expiryColumnId = getExpiryColumnId();
+    if(expiryColumnId == -1) {
+        return "";
+    }
+
+    const std::string name = tablePrefix + m_tableHeader.at(expiryColumnId).name;
+    return "(" + name + " IS NULL OR " + name + " > " + std::to_string(time(nullptr)) + ") ";
+}
+
+/**
+ * @brief create a sql-query to create an index on the expiry-column
+ *
+ * @return empty string, if the table has no expiry-column, else created sql-query
+ */
+const std::string
+SqlTable::createExpiryIndexQuery()
+{
+    const long expiryColumnId = getExpiryColumnId();
+    if(expiryColumnId == -1) {
+        return "";
+    }
+
+    const std::string &name = m_tableHeader.at(expiryColumnId).name;
+    return "CREATE INDEX IF NOT EXISTS " + m_tableName + "_" + name + "_expiry ON "
+           + m_tableName + "(" + name + ");";
+}
+
+/**
+ * @brief create a sql-query to create an index for each indexed column
+ *
+ * @return empty string, if the table has no indexed columns, else created sql-query
+ */
+const std::string
+SqlTable::createColumnIndexQuery()
+{
+    std::string command = "";
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        if(entry.isIndexed == false
+                || entry.isPrimary)
+        {
+            continue;
+        }
+
+        command.append("CREATE INDEX IF NOT EXISTS " + m_tableName + "_" + entry.name
+                       + "_index ON " + m_tableName + "(" + entry.name + ");");
+    }
+
+    return command;
+}
+
+/**
+ * @brief create a sql-query to delete a limited number of expired rows. The rows are searched
+ *        with the index of the expiry-column.
+ *
+ * @param batchSize maximum number of rows to delete
+ *
+ * @return created sql-query, which returns the keys of the deleted rows
+ */
+const std::string
+SqlTable::createDeleteExpiredQuery(const uint64_t batchSize)
+{
+    const std::string &name = m_tableHeader.at(getExpiryColumnId()).name;
+    const long primaryKeyId = getPrimaryKeyId();
+
+    std::string command = "DELETE FROM " + m_tableName;
+    command.append(" WHERE rowid IN (SELECT rowid FROM " + m_tableName);
+    command.append(" WHERE " + name + " <= " + std::to_string(time(nullptr)));
+    command.append(" LIMIT " + std::to_string(batchSize) + ")");
+    if(primaryKeyId != -1) {
+        command.append(" RETURNING " + m_tableHeader.at(primaryKeyId).name + " ;");
+    } else {
+        command.append(" RETURNING rowid ;");
+    }
+
+    return command;
+}
+
+/**
+ * @brief create a sql-query to request the rowid and the primary key of rows
+ *
+ * @param conditions conditions to filter table
+ *
+ * @return created sql-query
+ */
+const std::string
+SqlTable::createRowIdQuery(const std::vector<RequestCondition> &conditions)
+{
+    const long primaryKeyId = getPrimaryKeyId();
+    std::string command = "SELECT rowid , ";
+    if(primaryKeyId != -1) {
+        command.append(m_tableHeader.at(primaryKeyId).name);
+    } else {
+        command.append("rowid");
+    }
+    command.append(" FROM ");
+    command.append(m_tableName);
+    command.append(" WHERE ");
+
+    for(uint32_t i = 0; i < conditions.size(); i++)
+    {
+        if(i > 0) {
+            command.append(" AND ");
+        }
+        const RequestCondition* condition = &conditions.at(i);
+        command.append(condition->colName);
+        command.append("='");
+        command.append(condition->value);
+        command.append("' ");
+    }
+    command.append(" LIMIT 2 ;");
+
+    return command;
+}
+
+/**
+ * @brief convert first row together with header into json
+ *
+ * @param result reference for json-formated output
+ * @param tableContent table-input with at least one row
+ *
+ * @return false, if table is empty, else true
+ */
+bool
+SqlTable::processGetResult(JsonItem &result,
+                           TableItem &tableContent)
+{
+    if(tableContent.getNumberOfRows() == 0) {
+        return false;
+    }
+
+    // prepare result
+    const Kitsunemimi::DataItem* firstRow = tableContent.getBody()->get(0);
+
+    for(uint32_t i = 0; i < m_tableHeader.size(); i++) {
+        result.insert(m_tableHeader.at(i).name, firstRow->get(i));
+    }
+
+    return true;
+}
+
+/**
+ * @brief reset an arena-based result and add all columns of the table-header with their types
+ *
+ * @param resultTable reference to the result to initialize
+ * @param showHiddenValues false to mark hidden columns within the result
+ */
+void
+SqlTable::initResultColumns(SqlResult &resultTable,
+                            const bool showHiddenValues)
+{
+    resultTable.clear();
+
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        resultTable.addColumn(entry.name,
+                              getResultType(entry.type),
+                              entry.hide && showHiddenValues == false);
+    }
+}
+
+/**
+ * @brief get the type of the values of a column within an arena-based result
+ *
+ * @param type type of the column within the table
+ *
+ * @return type of the values within the result
+ */
+SqlResult::ValueType
+SqlTable::getResultType(const DbVataValueTypes type)
+{
+    switch(type)
+    {
+        case STRING_TYPE:
+            return SqlResult::STRING_VALUE;
+        case INT_TYPE:
+            return SqlResult::INT_VALUE;
+        case BOOL_TYPE:
+            return SqlResult::BOOL_VALUE;
+        case FLOAT_TYPE:
+            return SqlResult::FLOAT_VALUE;
+        case BLOB_TYPE:
+            // blob-columns are requested as size of the blob
+            return SqlResult::INT_VALUE;
+    }
+
+    return SqlResult::NULL_VALUE;
+}
+
+/**
+ * @brief check if the options of the columns are valid
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if a compressed column is not a string-column, primary key or searchable,
+ *         or if the version-column is invalid, else true
+ */
+bool
+SqlTable::checkColumns(ErrorContainer &error)
+{
+    uint32_t numberOfVersionColumns = 0;
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        if(entry.isVersion)
+        {
+            numberOfVersionColumns++;
+            if(entry.type != INT_TYPE
+                    || entry.isPrimary
+                    || numberOfVersionColumns > 1)
+            {
+                error.addMeesage("column '" + entry.name + "' of table '" + m_tableName
+                                 + "' can not be the version-column, because only one "
+                                   "int-column, which is not primary key, can be used");
+                LOG_ERROR(error);
+                return false;
+            }
+        }
+
+        if(entry.isCompressed
+                && (entry.type != STRING_TYPE
+                    || entry.isPrimary
+                    || entry.isSearchable))
+        {
+            error.addMeesage("column '" + entry.name + "' of table '" + m_tableName
+                             + "' can not be compressed, because only string-columns, which are "
+                               "not primary key or searchable, can be compressed");
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief get the header-entries of the columns, which should be part of the result of a join
+ *
+ * @param names names of the columns. If empty, all not hidden columns are used.
+ * @param columns reference for the output
+ * @param error reference for error-output
+ *
+ * @return false, if a column doesn't exist, else true
+ */
+bool
+SqlTable::getJoinColumns(const std::vector<std::string> &names,
+                         std::vector<const DbHeaderEntry*> &columns,
+                         ErrorContainer &error)
+{
+    if(names.size() == 0)
+    {
+        for(const DbHeaderEntry &entry : m_tableHeader)
+        {
+            if(entry.hide == false) {
+                columns.push_back(&entry);
+            }
+        }
+        return true;
+    }
+
+    for(const std::string &name : names)
+    {
+        const long columnId = getColumnId(name);
+        if(columnId == -1)
+        {
+            error.addMeesage("column '" + name + "' doesn't exist in table '" + m_tableName + "'");
+            return false;
+        }
+        columns.push_back(&m_tableHeader.at(columnId));
+    }
+
+    return true;
+}
+
+/**
+ * @brief create the full-text search-index, if the table has searchable columns. If the index is
+ *        new, it is filled with the rows, which already exist in the table.
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if a searchable column is not a string-column or creating the index failed,
+ *         else true
+ */
+bool
+SqlTable::initSearchIndex(ErrorContainer &error)
+{
+    const std::string createQuery = createSearchIndexQuery();
+    if(createQuery.empty()) {
+        return true;
+    }
+
+    for(const DbHeaderEntry &entry : m_tableHeader)
+    {
+        if(entry.isSearchable
+                && entry.type != STRING_TYPE)
+        {
+            error.addMeesage("searchable column '" + entry.name + "' is not a string-column");
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    const std::string index = m_tableName + "_search";
+    TableItem existing;
+    if(m_db->execSqlCommand(&existing,
+                            "SELECT name FROM sqlite_master WHERE name='" + index + "';",
+                            error) == false)
+    {
+        return false;
+    }
+
+    if(m_db->execSqlCommand(nullptr, createQuery, error) == false) {
+        return false;
+    }
+
+    // fill new index with the already existing rows
+    if(existing.getNumberOfRows() == 0)
+    {
+        return m_db->execSqlCommand(nullptr,
+                                    "INSERT INTO " + index + "(" + index + ") "
+                                    "VALUES ('rebuild');",
+                                    error);
+    }
+
+    return true;
+}
+
+/**
+ * @brief check that no condition uses a compressed column. Compressed columns contain the
+ *        compressed values, so the plain value of a condition would never match.
+ *
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ *
+ * @return false, if a condition uses a compressed column, else true
+ */
+bool
+SqlTable::checkConditions(const std::vector<RequestCondition> &conditions,
+                          ErrorContainer &error)
+{
+    for(const RequestCondition &condition : conditions)
+    {
+        const long columnId = getColumnId(condition.colName);
+        if(columnId != -1
+                && m_tableHeader.at(columnId).isCompressed)
+        {
+            error.addMeesage("compressed column '" + condition.colName
+                             + "' can not be used within conditions");
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief check that all columns to sort the result exist and can be sorted
+ *
+ * @param orderBy columns to sort the result
+ * @param error reference for error-output
+ *
+ * @return false, if a column doesn't exist or is a blob- or compressed column, else true
+ */
+bool
+SqlTable::checkOrderBy(const std::vector<OrderBy> &orderBy,
+                       ErrorContainer &error)
+{
+    for(const OrderBy &order : orderBy)
+    {
+        const long columnId = getColumnId(order.colName);
+        if(columnId == -1)
+        {
+            error.addMeesage("column '" + order.colName + "' to sort doesn't exist in table '"
+                             + m_tableName + "'");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        if(m_tableHeader.at(columnId).type == BLOB_TYPE)
+        {
+            error.addMeesage("blob-column '" + order.colName + "' can not be sorted");
+            LOG_ERROR(error);
+            return false;
+        }
+
+        // the compressed values would be sorted instead of the plain values
+        if(m_tableHeader.at(columnId).isCompressed)
+        {
+            error.addMeesage("compressed column '" + order.colName + "' can not be sorted");
+            LOG_ERROR(error);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief reset an arena-based result and add the columns for an aggregate-request with the types
+ *        of the aggregates
+ *
+ * @param result reference to the result to initialize
+ * @param groupBy columns to group the rows
+ * @param aggregates aggregates to calculate for each group
+ * @param error reference for error-output
+ *
+ * @return false, if a column doesn't exist or an aggregate doesn't fit its column, else true
+ */
+bool
+SqlTable::initAggregateColumns(SqlResult &result,
+                               const std::vector<std::string> &groupBy,
+                               const std::vector<Aggregate> &aggregates,
+                               ErrorContainer &error)
+{
+    // get the result-types of the columns of the table
+    SqlResult tableColumns;
+    initResultColumns(tableColumns, true);
+    result.clear();
+
+    for(const std::string &column : groupBy)
+    {
+        const long columnId = getColumnId(column);
+        if(columnId == -1)
+        {
+            error.addMeesage("column '" + column + "' doesn't exist in table '"
+                             + m_tableName + "'");
+            return false;
+        }
+        if(m_tableHeader.at(columnId).isCompressed)
+        {
+            error.addMeesage("compressed column '" + column + "' can not be used to group rows");
+            return false;
+        }
+        result.addColumn(column, tableColumns.getColumnType(columnId));
+    }
+
+    for(const Aggregate &aggregate : aggregates)
+    {
+        std::string name = aggregate.resultName;
+        SqlResult::ValueType type = SqlResult::NULL_VALUE;
+
+        // count all rows
+        if(aggregate.colName.empty())
+        {
+            if(aggregate.function != COUNT_AGGREGATE)
+            {
+                error.addMeesage("only count can be used without column");
+                return false;
+            }
+            if(name.empty()) {
+                name = "count";
+            }
+            result.addColumn(name, SqlResult::INT_VALUE);
+            continue;
+        }
+
+        const long columnId = getColumnId(aggregate.colName);
+        if(columnId == -1)
+        {
+            error.addMeesage("column '" + aggregate.colName + "' doesn't exist in table '"
+                             + m_tableName + "'");
+            return false;
+        }
+
+        const DbVataValueTypes columnType = m_tableHeader.at(columnId).type;
+        std::string prefix = "";
+        switch(aggregate.function)
+        {
+            case COUNT_AGGREGATE:
+                prefix = "count_";
+                type = SqlResult::INT_VALUE;
+                break;
+            case SUM_AGGREGATE:
+            case AVG_AGGREGATE:
+                if(columnType != INT_TYPE
+                        && columnType != FLOAT_TYPE)
+                {
+                    error.addMeesage("sum and avg require a numeric column, but '"
+                                     + aggregate.colName + "' is not numeric");
+                    return false;
+                }
+                if(aggregate.function == SUM_AGGREGATE)
+                {
+                    prefix = "sum_";
+                    type = tableColumns.getColumnType(columnId);
+                }
+                else
+                {
+                    prefix = "avg_";
+                    type = SqlResult::FLOAT_VALUE;
+                }
+                break;
+            case MIN_AGGREGATE:
+            case MAX_AGGREGATE:
+                if(columnType == BLOB_TYPE)
+                {
+                    error.addMeesage("min and max can not be used for blob-column '"
+                                     + aggregate.colName + "'");
+                    return false;
+                }
+                if(m_tableHeader.at(columnId).isCompressed)
+                {
+                    error.addMeesage("min and max can not be used for compressed column '"
+                                     + aggregate.colName + "'");
+                    return false;
+                }
+                prefix = aggregate.function == MIN_AGGREGATE ? "min_" : "max_";
+                type = tableColumns.getColumnType(columnId);
+                break;
+        }
+
+        if(name.empty()) {
+            name = prefix + aggregate.colName;
+        }
+        result.addColumn(name, type);
+    }
+
+    return true;
+}
+
+/**
+ * @brief check the values of an imported row against the table-header and append them with the
+ *        type of the column to the rows for the next transaction
+ *
+ * @param rows reference to the rows of the current transaction
+ * @param fields parsed fields with one entry per column of the table-header
+ * @param error reference for error-output
+ *
+ * @return false, if a value is invalid, else true
+ */
+bool
+SqlTable::appendImportRow(SqlResult &rows,
+                          const std::vector<RowField> &fields,
+                          ErrorContainer &error)
 {
-    std::string command = "CREATE TABLE IF NOT EXISTS ";
-    command.append(m_tableName);
-    command.append(" (");
-
-    // create all field of the table
-    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    for(uint64_t i = 0; i < m_tableHeader.size(); i++)
     {
-        const DbHeaderEntry* entry = &m_tableHeader[i];
-        if(i != 0) {
-            command.append(" , ");
+        const DbHeaderEntry &entry = m_tableHeader.at(i);
+        const RowField &field = fields.at(i);
+
+        // blobs can only be written with writeBlob, so only empty blobs are created here
+        if(entry.type == BLOB_TYPE)
+        {
+            if(field.isNull == false
+                    && field.value.empty() == false)
+            {
+                error.addMeesage("value of blob-column '" + entry.name + "' can not be imported");
+                return false;
+            }
+            if(field.isNull && entry.allowNull) {
+                rows.appendNull();
+            } else {
+                rows.appendString("", 0);
+            }
+            continue;
         }
-        command.append(entry->name + "  ");
 
-        // set type of the value
-        switch(entry->type)
+        // new rows expire after the time-to-live, if no expiry-time is given
+        if(field.isNull
+                && entry.timeToLive > 0)
+        {
+            rows.appendInt(time(nullptr) + static_cast<int64_t>(entry.timeToLive));
+            continue;
+        }
+
+        // new rows start with the first version, if no version is given
+        if(field.isNull
+                && entry.isVersion)
+        {
+            rows.appendInt(1);
+            continue;
+        }
+
+        if(field.isNull)
+        {
+            if(entry.allowNull == false)
+            {
+                error.addMeesage("'" + entry.name + "' is required, but missing in the input");
+                return false;
+            }
+            rows.appendNull();
+            continue;
+        }
+
+        const char* value = field.value.c_str();
+        char* end = nullptr;
+        switch(entry.type)
         {
             case STRING_TYPE:
-                if(entry->maxLength > 0)
-                {
-                    command.append("varchar(");
-                    command.append(std::to_string(entry->maxLength));
-                    command.append(") ");
-                }
-                else
+                if(entry.maxLength > 0
+                        && field.value.size() > static_cast<uint64_t>(entry.maxLength))
                 {
-                   command.append("text ");
+                    error.addMeesage("value of '" + entry.name + "' is longer than "
+                                     + std::to_string(entry.maxLength) + " characters");
+                    return false;
                 }
+                rows.appendString(field.value.c_str(), field.value.size());
                 break;
             case INT_TYPE:
-                command.append("int ");
+            {
+                const long long intValue = strtoll(value, &end, 10);
+                if(field.value.empty() || *end != '\0')
+                {
+                    error.addMeesage("value of '" + entry.name + "' is not an integer");
+                    return false;
+                }
+                rows.appendInt(intValue);
                 break;
+            }
             case BOOL_TYPE:
-                command.append("bool ");
+                if(field.value == "true" || field.value == "1") {
+                    rows.appendBool(true);
+                } else if(field.value == "false" || field.value == "0") {
+                    rows.appendBool(false);
+                } else {
+                    error.addMeesage("value of '" + entry.name + "' is not a bool");
+                    return false;
+                }
                 break;
             case FLOAT_TYPE:
-                command.append("real ");
+            {
+                const double floatValue = strtod(value, &end);
+                if(field.value.empty() || *end != '\0')
+                {
+                    error.addMeesage("value of '" + entry.name + "' is not a float");
+                    return false;
+                }
+                rows.appendFloat(floatValue);
+                break;
+            }
+            case BLOB_TYPE:
                 break;
         }
+    }
 
-        // set if key is primary key
-        if(entry->isPrimary) {
-            command.append("PRIMARY KEY ");
+    return true;
+}
+
+/**
+ * @brief write the rows of an import into the database and report them to the subscribers
+ *
+ * @param insertQuery prepared insert-query
+ * @param rows rows to insert
+ * @param primaryKeyId index of the primary-key column, or -1 if the table has no primary key
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::flushImportRows(const std::string &insertQuery,
+                          const SqlResult &rows,
+                          const long primaryKeyId,
+                          ErrorContainer &error)
+{
+    if(hasChangeSubscriber() == false) {
+        return m_db->insertRows(insertQuery, rows, error);
+    }
+
+    std::vector<int64_t> rowIds;
+    if(m_db->insertRows(insertQuery, rows, error, &rowIds) == false) {
+        return false;
+    }
+
+    // use the primary key if available and the rowid otherwise
+    std::vector<std::string> primaryKeys;
+    for(uint64_t row = 0; row < rows.getNumberOfRows(); row++)
+    {
+        if(primaryKeyId != -1)
+        {
+            DataItem* value = rows.toDataItem(row, primaryKeyId);
+            primaryKeys.push_back(value->toString());
+            delete value;
+        }
+        else
+        {
+            primaryKeys.push_back(std::to_string(rowIds.at(row)));
         }
+    }
+    publishChanges(ChangeEvent::INSERT_CHANGE, primaryKeys);
 
-        // set if value is not allowed to be null
-        if(entry->allowNull == false) {
-            command.append("NOT NULL ");
+    return true;
+}
+
+/**
+ * @brief run a query, which changes the table, and report the primary keys of all changed rows
+ *        to the subscribers of the table, if there are any
+ *
+ * @param command insert-, update- or delete-query. It is modified, if there are subscribers or
+ *                the number of changed rows is requested.
+ * @param changeType type of the change for the subscribers
+ * @param error reference for error-output
+ * @param numberOfChangedRows optional pointer for the number of rows, which were changed by the
+ *                            query
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::runMutation(std::string &command,
+                      const ChangeEvent::ChangeType changeType,
+                      ErrorContainer &error,
+                      uint64_t* numberOfChangedRows)
+{
+    Kitsunemimi::TableItem resultItem;
+
+    if(numberOfChangedRows == nullptr
+            && hasChangeSubscriber() == false)
+    {
+        return m_db->execSqlCommand(&resultItem, command, error);
+    }
+
+    // let sqlite return the keys of all changed rows. If the table has no primary key, the rowid
+    // is used instead.
+    const long primaryKeyId = getPrimaryKeyId();
+    std::string returning = " RETURNING rowid ;";
+    if(primaryKeyId != -1) {
+        returning = " RETURNING " + m_tableHeader.at(primaryKeyId).name + " ;";
+    }
+    const size_t end = command.find_last_of(';');
+    if(end != std::string::npos) {
+        command.erase(end);
+    }
+    command.append(returning);
+
+    if(m_db->execSqlCommand(&resultItem, command, error) == false) {
+        return false;
+    }
+
+    if(numberOfChangedRows != nullptr) {
+        *numberOfChangedRows = resultItem.getNumberOfRows();
+    }
+
+    std::vector<std::string> primaryKeys;
+    for(uint64_t row = 0; row < resultItem.getNumberOfRows(); row++) {
+        primaryKeys.push_back(resultItem.getCell(0, row));
+    }
+    publishChanges(changeType, primaryKeys);
+
+    return true;
+}
+
+/**
+ * @brief check if there are subscribers for changes of the table
+ *
+ * @return true, if there is at least one subscriber, else false
+ */
+bool
+SqlTable::hasChangeSubscriber()
+{
+    std::lock_guard<std::mutex> guard(m_changeFeedLock);
+    return m_changeFeed != nullptr && m_changeFeed->hasSubscriber();
+}
+
+/**
+ * @brief add events to the change-feed of the table
+ *
+ * @param changeType type of the change
+ * @param primaryKeys primary keys of the changed rows
+ */
+void
+SqlTable::publishChanges(const ChangeEvent::ChangeType changeType,
+                         const std::vector<std::string> &primaryKeys)
+{
+    std::lock_guard<std::mutex> guard(m_changeFeedLock);
+
+    if(m_changeFeed != nullptr) {
+        m_changeFeed->addEvents(changeType, primaryKeys);
+    }
+}
+
+/**
+ * @brief get index of the primary-key column within the table-header
+ *
+ * @return -1 if the table has no primary key, else index of the column
+ */
+long
+SqlTable::getPrimaryKeyId()
+{
+    for(uint64_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        if(m_tableHeader.at(i).isPrimary) {
+            return static_cast<long>(i);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief get the database for read-requests
+ *
+ * @return read-replica, if set and not too old, else the primary database
+ */
+SqlDatabase*
+SqlTable::getReadDatabase()
+{
+    std::lock_guard<std::mutex> guard(m_readReplicaLock);
+
+    if(m_readReplica != nullptr)
+    {
+        const long staleness = m_readReplica->getReplicaStaleness();
+        if(staleness != -1
+                && staleness <= static_cast<long>(m_maxStaleness))
+        {
+            return m_readReplica;
+        }
+    }
+
+    return m_db;
+}
+
+/**
+ * @brief get rows from the table with a limit for the result
+ *
+ * @param resultTable reference for the result of the query
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param orderBy columns to sort the result
+ * @param budget limit for the size of the result, or nullptr for no limit
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::readFromDb(TableItem &resultTable,
+                     const std::vector<RequestCondition> &conditions,
+                     ErrorContainer &error,
+                     const bool showHiddenValues,
+                     const uint64_t positionOffset,
+                     const uint64_t numberOfRows,
+                     const std::vector<OrderBy> &orderBy,
+                     SqlDatabase::ResultBudget* budget)
+{
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return false;
+    }
+
+    if(checkConditions(conditions, error) == false
+            || checkOrderBy(orderBy, error) == false)
+    {
+        return false;
+    }
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createSelectQuery(command, conditions, positionOffset, numberOfRows, orderBy);
+    if(getReadDatabase()->execSqlCommand(&resultTable, command, error, budget) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    finishTableResult(resultTable, showHiddenValues);
+
+    return true;
+}
+
+/**
+ * @brief get the next part of all rows of the table. Each part continues behind the sort-key
+ *        and rowid of the last row of the previous part, so no row is skipped or returned twice,
+ *        when rows are added or deleted between two parts, and each part is found with an index
+ *        instead of stepping over all previous rows again.
+ *
+ * @param tableResult pointer to table-item for the result, or nullptr
+ * @param arenaResult pointer to arena-based result, or nullptr
+ * @param continuationToken token of the previous part, or empty string to start at the first
+ *                          row. It is replaced by the token for the next part, or by an empty
+ *                          string, if the result is complete.
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param orderBy columns to sort the result. Must be the same for all parts of one result.
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::readPartFromDb(TableItem* tableResult,
+                         SqlResult* arenaResult,
+                         std::string &continuationToken,
+                         ErrorContainer &error,
+                         const bool showHiddenValues,
+                         const std::vector<OrderBy> &orderBy)
+{
+    std::vector<std::string> lastKey;
+    if(parseContinuationToken(continuationToken, orderBy.size() + 1, lastKey, error) == false) {
+        return false;
+    }
+
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return false;
+    }
+
+    if(checkOrderBy(orderBy, error) == false) {
+        return false;
+    }
+
+    SqlDatabase::ResultBudget budget;
+    budget.limit = getResultLimit();
+    budget.truncate = true;
+    budget.numberOfKeyColumns = static_cast<uint32_t>(orderBy.size() + 1);
+
+    // request one row more than allowed, so the end of the table is detected by the limit
+    uint64_t numberOfRows = static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    if(budget.limit.maxRows > 0) {
+        numberOfRows = budget.limit.maxRows + 1;
+    }
+
+    if(arenaResult != nullptr) {
+        initResultColumns(*arenaResult, showHiddenValues);
+    }
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createContinuationQuery(command, orderBy, lastKey, numberOfRows);
+    SqlDatabase* db = getReadDatabase();
+    const bool success = arenaResult != nullptr
+                         ? db->execSqlCommand(*arenaResult, command, error, &budget)
+                         : db->execSqlCommand(tableResult, command, error, &budget);
+    if(success == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(tableResult != nullptr) {
+        finishTableResult(*tableResult, showHiddenValues);
+    }
+
+    continuationToken = "";
+    if(budget.isTruncated) {
+        continuationToken = createContinuationToken(budget.lastKey);
+    }
+
+    return true;
+}
+
+/**
+ * @brief add the default-header to a table-item, if the result was empty, and remove the hidden
+ *        columns
+ *
+ * @param resultTable reference to the result of a select-query
+ * @param showHiddenValues include values in output, which should normally be hidden
+ */
+void
+SqlTable::finishTableResult(TableItem &resultTable,
+                            const bool showHiddenValues)
+{
+    // if header is missing in result, because there are no entries to list, add a default-header
+    if(resultTable.getNumberOfColums() == 0)
+    {
+        for(const DbHeaderEntry &entry : m_tableHeader) {
+            resultTable.addColumn(entry.name);
+        }
+    }
+
+    // remove all values, which should be hide
+    if(showHiddenValues == false)
+    {
+        for(const DbHeaderEntry &entry : m_tableHeader)
+        {
+            if(entry.hide) {
+                resultTable.deleteColumn(entry.name);
+            }
+        }
+    }
+}
+
+/**
+ * @brief get rows from the table with a limit for the result
+ *
+ * @param resultTable reference for the result of the query
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ * @param showHiddenValues include values in output, which should normally be hidden
+ * @param positionOffset offset of the rows to return
+ * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param orderBy columns to sort the result
+ * @param budget limit for the size of the result, or nullptr for no limit
+ *
+ * @return true, if successful, else false
+ */
+bool
+SqlTable::readFromDb(SqlResult &resultTable,
+                     const std::vector<RequestCondition> &conditions,
+                     ErrorContainer &error,
+                     const bool showHiddenValues,
+                     const uint64_t positionOffset,
+                     const uint64_t numberOfRows,
+                     const std::vector<OrderBy> &orderBy,
+                     SqlDatabase::ResultBudget* budget)
+{
+    // changes of the write-back mode have to be in the database before reading it
+    if(flushWriteBack(error) == false) {
+        return false;
+    }
+
+    if(checkConditions(conditions, error) == false
+            || checkOrderBy(orderBy, error) == false)
+    {
+        return false;
+    }
+
+    // prepare columns, so the values are typed like defined in the table-header
+    initResultColumns(resultTable, showHiddenValues);
+
+    QueryBuffer queryBuffer;
+    std::string &command = queryBuffer.get();
+    createSelectQuery(command, conditions, positionOffset, numberOfRows, orderBy);
+    if(getReadDatabase()->execSqlCommand(resultTable, command, error, budget) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get the limit for results of the table
+ *
+ * @return limit of the table, or default-limit of the database, if the table has no own limit
+ */
+const SqlDatabase::ResultLimit
+SqlTable::getResultLimit()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_resultLimitLock);
+        if(m_resultLimit.maxRows > 0
+                || m_resultLimit.maxBytes > 0)
+        {
+            return m_resultLimit;
         }
     }
 
-    command.append(");");
-
-    return command;
+    return m_db->getResultLimit();
 }
 
 /**
- * @brief create a sql-query to get a line from the table
+ * @brief create the token to continue a result behind its last row
  *
- * @param conditions conditions to filter table
- * @param positionOffset offset of the rows to return
- * @param numberOfRows maximum number of results. if 0 then this value and the offset are ignored
+ * @param lastKey sort-key and rowid of the last row as sql-literals
  *
- * @return created sql-query
+ * @return token with the hex-encoded literals, separated by dots
  */
 const std::string
-SqlTable::createSelectQuery(const std::vector<RequestCondition> &conditions,
-                            const uint64_t positionOffset,
-                            const uint64_t numberOfRows)
+SqlTable::createContinuationToken(const std::vector<std::string> &lastKey)
 {
-    std::string command = "SELECT * from " + m_tableName;
+    const char hexDigits[] = "0123456789abcdef";
 
-    // filter
-    if(conditions.size() > 0)
+    std::string token = "";
+    for(uint64_t i = 0; i < lastKey.size(); i++)
     {
-        command.append(" WHERE ");
-
-        for(uint32_t i = 0; i < conditions.size(); i++)
+        if(i > 0) {
+            token.push_back('.');
+        }
+        for(const char c : lastKey.at(i))
         {
-            if(i > 0) {
-                command.append(" AND ");
-            }
-            const RequestCondition* condition = &conditions.at(i);
-            command.append(condition->colName);
-            command.append("='");
-            command.append(condition->value);
-            command.append("' ");
+            const uint8_t byte = static_cast<uint8_t>(c);
+            token.push_back(hexDigits[byte >> 4]);
+            token.push_back(hexDigits[byte & 0x0F]);
         }
     }
 
-    // limit number of results
-    if(numberOfRows > 0)
+    return token;
+}
+
+/**
+ * @brief convert a continuation-token back into the sort-key and rowid of the last row of the
+ *        previous part. The token comes from the caller, so each literal is checked, before it
+ *        is used within a query.
+ *
+ * @param continuationToken token of the previous part, or empty string
+ * @param numberOfKeyColumns number of expected literals: one for each sorted column and one for
+ *                           the rowid
+ * @param lastKey reference for the sql-literals of the key. Empty for an empty token.
+ * @param error reference for error-output
+ *
+ * @return false, if the token is invalid, else true
+ */
+bool
+SqlTable::parseContinuationToken(const std::string &continuationToken,
+                                 const uint64_t numberOfKeyColumns,
+                                 std::vector<std::string> &lastKey,
+                                 ErrorContainer &error)
+{
+    lastKey.clear();
+    if(continuationToken.empty()) {
+        return true;
+    }
+
+    bool valid = true;
+    std::string literal = "";
+    uint64_t pos = 0;
+    while(valid
+          && pos <= continuationToken.size())
     {
-        command.append(" LIMIT ");
-        command.append(std::to_string(numberOfRows));
-        command.append(" OFFSET ");
-        command.append(std::to_string(positionOffset));
+        // end of one literal
+        if(pos == continuationToken.size()
+                || continuationToken.at(pos) == '.')
+        {
+            lastKey.push_back(literal);
+            literal.clear();
+            pos++;
+            continue;
+        }
+
+        const int high = getHexValue(continuationToken.at(pos));
+        const int low = pos + 1 < continuationToken.size()
+                        ? getHexValue(continuationToken.at(pos + 1))
+                        : -1;
+        valid = high != -1 && low != -1;
+        literal.push_back(static_cast<char>((high << 4) | low));
+        pos += 2;
     }
 
-    command.append(" ;");
+    // the rowid is always the last part of the key
+    valid = valid
+            && lastKey.size() == numberOfKeyColumns
+            && isNumberLiteral(lastKey.back(), false);
+    for(uint64_t i = 0; valid && i + 1 < lastKey.size(); i++) {
+        valid = isSqlLiteral(lastKey.at(i));
+    }
 
-    return command;
+    if(valid == false)
+    {
+        lastKey.clear();
+        error.addMeesage("invalid continuation-token '" + continuationToken + "'");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
 }
 
 /**
- * @brief create a sql-query to update values within the table
+ * @brief get index of the column with time-to-live within the table-header
  *
- * @param conditions conditions to filter table
- * @param updates json-map with key-value pairs to update
- *
- * @return created sql-query
+ * @return -1 if the table has no expiry-column, else index of the column
  */
-const std::string
-SqlTable::createUpdateQuery(const std::vector<RequestCondition> &conditions,
-                            const JsonItem &updates)
+long
+SqlTable::getExpiryColumnId()
 {
-    std::string command  = "UPDATE ";
-    command.append(m_tableName);
+    for(uint64_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        if(m_tableHeader.at(i).timeToLive > 0) {
+            return static_cast<long>(i);
+        }
+    }
 
-    // add set-section
-    command.append(" SET ");
-    const std::vector<std::string> keys = updates.getKeys();
-    for(uint32_t i = 0; i < keys.size(); i++)
+    return -1;
+}
+
+/**
+ * @brief get index of the version-column within the table-header
+ *
+ * @return -1 if the table has no version-column, else index of the column
+ */
+long
+SqlTable::getVersionColumnId()
+{
+    for(uint64_t i = 0; i < m_tableHeader.size(); i++)
     {
-        if(i > 0) {
-            command.append(" , ");
+        if(m_tableHeader.at(i).isVersion) {
+            return static_cast<long>(i);
         }
-        command.append(keys.at(i));
-        JsonItem val = updates.get(keys.at(i));
-        command.append("='" + val.toString() + "' ");
     }
 
-    // add where-section
-    if(conditions.size() > 0)
+    return -1;
+}
+
+/**
+ * @brief loop of the expiry-sweeper
+ *
+ * @param sweepInterval time in milliseconds between two runs of the sweeper
+ * @param batchSize maximum number of rows to delete with one request
+ * @param pauseBetweenBatches time in milliseconds to wait between two batches
+ */
+void
+SqlTable::runExpirySweeper(const uint32_t sweepInterval,
+                           const uint64_t batchSize,
+                           const uint32_t pauseBetweenBatches)
+{
+    std::unique_lock<std::mutex> guard(m_sweeperLock);
+
+    while(m_sweeperAbort == false)
     {
-        command.append(" WHERE ");
+        guard.unlock();
 
-        for(uint32_t i = 0; i < conditions.size(); i++)
+        // delete expired rows until there are no more full batches
+        ErrorContainer error;
+        long numberOfDeletedRows = 0;
+        do
         {
-            if(i > 0) {
-                command.append(" AND ");
+            numberOfDeletedRows = deleteExpiredRows(error, batchSize);
+            if(numberOfDeletedRows == static_cast<long>(batchSize))
+            {
+                guard.lock();
+                m_sweeperWakeup.wait_for(guard,
+                                         std::chrono::milliseconds(pauseBetweenBatches),
+                                         [this] { return m_sweeperAbort; });
+                const bool abort = m_sweeperAbort;
+                guard.unlock();
+                if(abort) {
+                    break;
+                }
             }
-            const RequestCondition* condition = &conditions.at(i);
-            command.append(condition->colName);
-            command.append("='");
-            command.append(condition->value);
-            command.append("' ");
         }
-    }
-    command.append(" ;");
+        while(numberOfDeletedRows == static_cast<long>(batchSize));
 
-    return command;
+        guard.lock();
+        m_sweeperWakeup.wait_for(guard,
+                                 std::chrono::milliseconds(sweepInterval),
+                                 [this] { return m_sweeperAbort; });
+    }
 }
 
 /**
- * @brief create a sql-query to insert values into the table
+ * @brief get index of a column within the table-header
  *
- * @param values list of values to insert
+ * @param columnName name of the column
  *
- * @return created sql-query
+ * @return -1 if not found, else index of the column
  */
-const std::string
-SqlTable::createInsertQuery(const std::vector<std::string> &values)
+long
+SqlTable::getColumnId(const std::string &columnName)
 {
-    std::string command  = "INSERT INTO ";
-    command.append(m_tableName);
-    command.append("(");
+    for(uint64_t i = 0; i < m_tableHeader.size(); i++)
+    {
+        if(m_tableHeader.at(i).name == columnName) {
+            return static_cast<long>(i);
+        }
+    }
 
-    // create fields
-    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+    return -1;
+}
+
+/**
+ * @brief start the background-thread of the write-back mode
+ */
+void
+SqlTable::startWriteBackFlusher()
+{
+    std::lock_guard<std::mutex> guard(m_flusherLock);
+
+    m_flusherAbort = false;
+    m_flushRequested = false;
+    m_flusher = std::thread(&SqlTable::runWriteBackFlusher, this);
+}
+
+/**
+ * @brief stop the background-thread of the write-back mode
+ */
+void
+SqlTable::stopWriteBackFlusher()
+{
     {
-        const DbHeaderEntry* entry = &m_tableHeader[i];
-        if(i != 0) {
-            command.append(" , ");
+        std::lock_guard<std::mutex> guard(m_flusherLock);
+        if(m_flusher.joinable() == false) {
+            return;
         }
-        command.append(entry->name);
+        m_flusherAbort = true;
     }
+    m_flusherWakeup.notify_all();
 
-    // create values
-    command.append(") VALUES (");
+    m_flusher.join();
+}
 
-    for(uint32_t i = 0; i < m_tableHeader.size(); i++)
+/**
+ * @brief loop of the background-thread of the write-back mode
+ */
+void
+SqlTable::runWriteBackFlusher()
+{
+    std::unique_lock<std::mutex> guard(m_flusherLock);
+
+    while(m_flusherAbort == false)
     {
-        if(i != 0) {
-            command.append(" , ");
+        m_flusherWakeup.wait_for(guard,
+                                 std::chrono::milliseconds(m_flushInterval),
+                                 [this] { return m_flusherAbort || m_flushRequested; });
+        m_flushRequested = false;
+        if(m_flusherAbort) {
+            break;
         }
-        command.append("'");
-        command.append(values.at(i));
-        command.append("'");
+
+        // errors are already logged by the flush
+        guard.unlock();
+        ErrorContainer error;
+        flushWriteBack(error);
+        guard.lock();
     }
+}
 
-    command.append(" );");
+/**
+ * @brief wake up the background-thread of the write-back mode, if too many rows are changed
+ */
+void
+SqlTable::requestFlushIfNeeded()
+{
+    if(m_writeBackCache->getNumberOfDirtyRows() < m_maxDirtyRows) {
+        return;
+    }
 
-    return command;
+    {
+        std::lock_guard<std::mutex> guard(m_flusherLock);
+        m_flushRequested = true;
+    }
+    m_flusherWakeup.notify_all();
 }
 
 /**
- * @brief create query to delete rows from table
+ * @brief convert the conditions of a request into conditions for the write-back cache
  *
- * @param conditions conditions to filter table
+ * @param conditions conditions of the request
+ * @param cacheConditions reference for the output
+ * @param error reference for error-output
  *
- * @return created sql-query
+ * @return false, if a column of the conditions doesn't exist, else true
  */
-const std::string
-SqlTable::createDeleteQuery(const std::vector<RequestCondition> &conditions)
+bool
+SqlTable::convertConditions(const std::vector<RequestCondition> &conditions,
+                            std::vector<std::pair<uint64_t, std::string>> &cacheConditions,
+                            ErrorContainer &error)
 {
-    std::string command  = "DELETE FROM ";
-    command.append(m_tableName);
-
-    if(conditions.size() > 0)
+    for(const RequestCondition &condition : conditions)
     {
-        command.append(" WHERE ");
-
-        for(uint32_t i = 0; i < conditions.size(); i++)
+        const long columnId = getColumnId(condition.colName);
+        if(columnId == -1)
         {
-            if(i > 0) {
-                command.append(" AND ");
-            }
-            const RequestCondition* condition = &conditions.at(i);
-            command.append(condition->colName);
-            command.append("='");
-            command.append(condition->value);
-            command.append("' ");
+            error.addMeesage("column '" + condition.colName + "' doesn't exist in table '"
+                             + m_tableName + "'");
+            LOG_ERROR(error);
+            return false;
         }
+        cacheConditions.emplace_back(columnId, condition.value);
     }
-    command.append(" ;");
 
-    return command;
+    return true;
 }
 
 /**
- * @brief create a sql-query to request number of rows of the table
+ * @brief get a row from the write-back cache in the same format like a select-request
  *
- * @return created sql-query
+ * @param resultTable reference for the output. Stays empty, if no row was found.
+ * @param conditions conditions to filter table
+ * @param error reference for error-output
+ *
+ * @return false, if the conditions are invalid, else true
  */
-const std::string
-SqlTable::createCountQuery()
+bool
+SqlTable::getFromCache(TableItem &resultTable,
+                       const std::vector<RequestCondition> &conditions,
+                       ErrorContainer &error)
 {
-    std::string command  = "SELECT COUNT(*) as number_of_rows FROM ";
-    command.append(m_tableName);
-    command.append(";");
+    std::vector<std::pair<uint64_t, std::string>> cacheConditions;
+    if(convertConditions(conditions, cacheConditions, error) == false) {
+        return false;
+    }
 
-    return command;
+    WriteBackCache::CachedRow row;
+    if(m_writeBackCache->getRow(cacheConditions, row) == false) {
+        return true;
+    }
+
+    SqlResult result;
+    initResultColumns(result, true);
+    for(uint64_t i = 0; i < m_tableHeader.size(); i++) {
+        appendCachedValue(result, m_tableHeader.at(i), row.values.at(i), row.isNull.at(i));
+    }
+
+    return result.toTableItem(resultTable);
 }
 
 /**
- * @brief convert first row together with header into json
+ * @brief convert a value of the write-back cache into the type of its column and append it
  *
- * @param result reference for json-formated output
- * @param tableContent table-input with at least one row
+ * @param result reference to the result, where the value should be added
+ * @param entry column of the value
+ * @param value value as string
+ * @param isNull true, if the value is null
+ */
+void
+SqlTable::appendCachedValue(SqlResult &result,
+                            const DbHeaderEntry &entry,
+                            const std::string &value,
+                            const bool isNull)
+{
+    if(isNull)
+    {
+        result.appendNull();
+        return;
+    }
+
+    switch(entry.type)
+    {
+        case STRING_TYPE:
+            result.appendString(value.c_str(), value.size());
+            break;
+        case INT_TYPE:
+            result.appendInt(strtoll(value.c_str(), nullptr, 10));
+            break;
+        case BOOL_TYPE:
+            result.appendBool(value == "true" || value == "1");
+            break;
+        case FLOAT_TYPE:
+            result.appendFloat(strtod(value.c_str(), nullptr));
+            break;
+        case BLOB_TYPE:
+            result.appendNull();
+            break;
+    }
+}
+
+/**
+ * @brief run a task with the executor of the database and count it as pending request of the
+ *        table, so the table is not destroyed while the task is running
  *
- * @return false, if table is empty, else true
+ * @param type type of the task
+ * @param task task to execute
+ *
+ * @return false, if the executor of the database is not running, else true
  */
 bool
-SqlTable::processGetResult(JsonItem &result,
-                           TableItem &tableContent)
+SqlTable::runAsync(const DatabaseExecutor::TaskType type,
+                   DatabaseExecutor::Task task)
 {
-    if(tableContent.getNumberOfRows() == 0) {
+    {
+        std::lock_guard<std::mutex> guard(m_asyncLock);
+        m_numberOfAsyncRequests++;
+    }
+
+    const bool posted = m_db->postTask(type, [this, task]() {
+        task();
+
+        std::lock_guard<std::mutex> guard(m_asyncLock);
+        m_numberOfAsyncRequests--;
+        m_asyncFinished.notify_all();
+    });
+
+    if(posted == false)
+    {
+        std::lock_guard<std::mutex> guard(m_asyncLock);
+        m_numberOfAsyncRequests--;
+        m_asyncFinished.notify_all();
+    }
+
+    return posted;
+}
+
+/**
+ * @brief search the row of a blob
+ *
+ * @param conditions conditions to filter table. They must match exactly one row.
+ * @param columnName name of the blob-column
+ * @param rowId reference for the rowid of the row
+ * @param primaryKey reference for the primary key of the row, or the rowid if there is none
+ * @param error reference for error-output
+ *
+ * @return false, if the column is not a blob-column or not exactly one row was found, else true
+ */
+bool
+SqlTable::getBlobRow(const std::vector<RequestCondition> &conditions,
+                     const std::string &columnName,
+                     int64_t &rowId,
+                     std::string &primaryKey,
+                     ErrorContainer &error)
+{
+    // precheck
+    if(conditions.size() == 0)
+    {
+        error.addMeesage("no conditions given for table-access.");
+        LOG_ERROR(error);
+        return false;
+    }
+    if(checkConditions(conditions, error) == false) {
         return false;
     }
 
-    // prepare result
-    const Kitsunemimi::DataItem* firstRow = tableContent.getBody()->get(0);
+    bool isBlob = false;
+    for(const DbHeaderEntry &entry : m_tableHeader) {
+        isBlob |= entry.name == columnName && entry.type == BLOB_TYPE;
+    }
+    if(isBlob == false)
+    {
+        error.addMeesage("'" + columnName + "' is not a blob-column of table '"
+                         + m_tableName + "'");
+        LOG_ERROR(error);
+        return false;
+    }
 
-    for(uint32_t i = 0; i < m_tableHeader.size(); i++) {
-        result.insert(m_tableHeader.at(i).name, firstRow->get(i));
+    TableItem resultItem;
+    if(m_db->execSqlCommand(&resultItem, createRowIdQuery(conditions), error) == false)
+    {
+        LOG_ERROR(error);
+        return false;
+    }
+
+    if(resultItem.getNumberOfRows() != 1)
+    {
+        error.addMeesage("conditions for blob-access must match exactly one row");
+        LOG_ERROR(error);
+        return false;
     }
 
+    rowId = std::stoll(resultItem.getCell(0, 0));
+    primaryKey = resultItem.getCell(1, 0);
+
     return true;
 }
 
@@ -5,11 +5,6 @@ TEMPLATE = lib
 CONFIG += c++17
 VERSION = 0.5.0
 
-LIBS += -L../../libKitsunemimiSqlite/src -lKitsunemimiSqlite
-LIBS += -L../../libKitsunemimiSqlite/src/debug -lKitsunemimiSqlite
-LIBS += -L../../libKitsunemimiSqlite/src/release -lKitsunemimiSqlite
-INCLUDEPATH += ../../libKitsunemimiSqlite/include
-
 LIBS += -L../../libKitsunemimiJson/src -lKitsunemimiJson
 LIBS += -L../../libKitsunemimiJson/src/debug -lKitsunemimiJson
 LIBS += -L../../libKitsunemimiJson/src/release -lKitsunemimiJson
@@ -21,15 +16,35 @@ LIBS += -L../../libKitsunemimiCommon/src/release -lKitsunemimiCommon
 INCLUDEPATH += ../../libKitsunemimiCommon/include
 
 LIBS += -lsqlite3
+LIBS += -lz
 
 INCLUDEPATH += $$PWD \
                $$PWD/../include
 
 HEADERS += \
+    ../include/libKitsunemimiSakuraDatabase/change_feed.h \
+    ../include/libKitsunemimiSakuraDatabase/database_executor.h \
     ../include/libKitsunemimiSakuraDatabase/sql_table.h \
-    ../include/libKitsunemimiSakuraDatabase/sql_database.h
+    ../include/libKitsunemimiSakuraDatabase/sql_database.h \
+    ../include/libKitsunemimiSakuraDatabase/sql_result.h \
+    ../include/libKitsunemimiSakuraDatabase/table_snapshot.h \
+    ../include/libKitsunemimiSakuraDatabase/trace_hook.h \
+    ../include/libKitsunemimiSakuraDatabase/typed_table.h \
+    row_parser.h \
+    trace_scope.h \
+    value_compression.h \
+    write_back_cache.h
 
 SOURCES += \
+    change_feed.cpp \
+    database_executor.cpp \
+    row_parser.cpp \
     sql_database.cpp \
-    sql_table.cpp
+    sql_result.cpp \
+    sql_table.cpp \
+    table_snapshot.cpp \
+    trace_hook.cpp \
+    trace_scope.cpp \
+    value_compression.cpp \
+    write_back_cache.cpp
 
@@ -0,0 +1,672 @@
+/**
+ * @file       table_snapshot.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiSakuraDatabase/table_snapshot.h>
+
+#include <fstream>
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+const char SNAPSHOT_MAGIC[8] = {'K', 'S', 'D', 'B', 'S', 'N', 'A', 'P'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+/**
+ * @brief round up a file-position to the next multiple of 8 bytes
+ */
+inline uint64_t
+alignPos(const uint64_t pos)
+{
+    return (pos + 7) & ~static_cast<uint64_t>(7);
+}
+
+/**
+ * @brief get the size of a single value of a column within the snapshot
+ */
+inline uint64_t
+getValueSize(const SqlResult::ValueType type)
+{
+    switch(type)
+    {
+        case SqlResult::INT_VALUE:
+        case SqlResult::FLOAT_VALUE:
+            return 8;
+        case SqlResult::BOOL_VALUE:
+            return 1;
+        default:
+            break;
+    }
+
+    return 4;
+}
+
+/**
+ * @brief write a buffer into the file and fill up with zeros to the next aligned position
+ */
+inline void
+writeAligned(std::ofstream &out,
+             const void* data,
+             const uint64_t size)
+{
+    const char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    out.write(static_cast<const char*>(data), size);
+    out.write(zeros, alignPos(size) - size);
+}
+
+/**
+ * @brief constructor
+ */
+TableSnapshot::TableSnapshot() {}
+
+/**
+ * @brief destructor
+ */
+TableSnapshot::~TableSnapshot()
+{
+    closeSnapshot();
+}
+
+/**
+ * @brief write content of a result as columnar snapshot into a file. Hidden columns of the
+ *        result are not written.
+ *
+ * @param filePath path of the new snapshot-file. Existing files will be overwritten.
+ * @param content result with the content to write
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableSnapshot::writeSnapshot(const std::string &filePath,
+                             const SqlResult &content,
+                             ErrorContainer &error)
+{
+    const uint64_t numberOfRows = content.getNumberOfRows();
+
+    // collect visible columns
+    std::vector<uint64_t> columnIds;
+    for(uint64_t i = 0; i < content.getNumberOfColumns(); i++)
+    {
+        if(content.isHidden(i)) {
+            continue;
+        }
+
+        if(content.getColumnName(i).size() >= sizeof(SnapshotColumn::name))
+        {
+            error.addMeesage("column-name '" + content.getColumnName(i)
+                             + "' is too long for a snapshot");
+            return false;
+        }
+        columnIds.push_back(i);
+    }
+
+    // build string-dictionary. Columns without known type are stored as strings.
+    std::unordered_map<std::string, uint32_t> dictIds;
+    std::vector<const std::string*> dictEntries;
+    std::vector<std::vector<uint32_t>> stringColumns(columnIds.size());
+    uint64_t dictDataSize = 0;
+    for(uint64_t c = 0; c < columnIds.size(); c++)
+    {
+        const uint64_t col = columnIds.at(c);
+        SqlResult::ValueType type = content.getColumnType(col);
+        if(type != SqlResult::STRING_VALUE
+                && type != SqlResult::NULL_VALUE)
+        {
+            continue;
+        }
+
+        std::vector<uint32_t> &ids = stringColumns[c];
+        ids.resize(numberOfRows, 0);
+        for(uint64_t row = 0; row < numberOfRows; row++)
+        {
+            if(content.isNull(row, col)) {
+                continue;
+            }
+
+            std::string value;
+            if(content.getType(row, col) == SqlResult::STRING_VALUE)
+            {
+                value = std::string(content.getString(row, col));
+            }
+            else
+            {
+                DataItem* item = content.toDataItem(row, col);
+                value = item->toString();
+                delete item;
+            }
+
+            auto it = dictIds.find(value);
+            if(it == dictIds.end())
+            {
+                it = dictIds.emplace(value, static_cast<uint32_t>(dictEntries.size())).first;
+                dictEntries.push_back(&it->first);
+                dictDataSize += value.size();
+            }
+            ids[row] = it->second;
+        }
+    }
+
+    // calculate layout of the file
+    SnapshotHeader header;
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    memset(header.padding, 0, sizeof(header.padding));
+    header.version = SNAPSHOT_VERSION;
+    header.numberOfColumns = static_cast<uint32_t>(columnIds.size());
+    header.numberOfRows = numberOfRows;
+    header.numberOfStrings = dictEntries.size();
+
+    std::vector<SnapshotColumn> columns(columnIds.size());
+    uint64_t pos = sizeof(SnapshotHeader) + columns.size() * sizeof(SnapshotColumn);
+    for(uint64_t c = 0; c < columnIds.size(); c++)
+    {
+        SnapshotColumn &column = columns[c];
+        memset(column.name, 0, sizeof(column.name));
+        const std::string name = content.getColumnName(columnIds.at(c));
+        memcpy(column.name, name.c_str(), name.size());
+
+        SqlResult::ValueType type = content.getColumnType(columnIds.at(c));
+        if(type == SqlResult::NULL_VALUE) {
+            type = SqlResult::STRING_VALUE;
+        }
+        column.type = type;
+
+        column.dataPos = pos;
+        pos = alignPos(pos + numberOfRows * getValueSize(type));
+        column.nullPos = pos;
+        pos = alignPos(pos + numberOfRows);
+    }
+    header.dictOffsetsPos = pos;
+    pos += (dictEntries.size() + 1) * sizeof(uint64_t);
+    header.dictDataPos = pos;
+    header.dictDataSize = dictDataSize;
+
+    // write file
+    std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+    if(out.is_open() == false)
+    {
+        error.addMeesage("can not open file '" + filePath + "' to write snapshot");
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(SnapshotHeader));
+    out.write(reinterpret_cast<const char*>(columns.data()),
+              columns.size() * sizeof(SnapshotColumn));
+
+    std::vector<uint8_t> nullMarker(numberOfRows, 0);
+    for(uint64_t c = 0; c < columnIds.size(); c++)
+    {
+        const uint64_t col = columnIds.at(c);
+        for(uint64_t row = 0; row < numberOfRows; row++) {
+            nullMarker[row] = content.isNull(row, col);
+        }
+
+        switch(columns.at(c).type)
+        {
+            case SqlResult::INT_VALUE:
+            {
+                std::vector<int64_t> values(numberOfRows);
+                for(uint64_t row = 0; row < numberOfRows; row++) {
+                    values[row] = content.getInt(row, col);
+                }
+                writeAligned(out, values.data(), numberOfRows * sizeof(int64_t));
+                break;
+            }
+            case SqlResult::FLOAT_VALUE:
+            {
+                std::vector<double> values(numberOfRows);
+                for(uint64_t row = 0; row < numberOfRows; row++) {
+                    values[row] = content.getFloat(row, col);
+                }
+                writeAligned(out, values.data(), numberOfRows * sizeof(double));
+                break;
+            }
+            case SqlResult::BOOL_VALUE:
+            {
+                std::vector<uint8_t> values(numberOfRows);
+                for(uint64_t row = 0; row < numberOfRows; row++) {
+                    values[row] = content.getBool(row, col);
+                }
+                writeAligned(out, values.data(), numberOfRows);
+                break;
+            }
+            default:
+                writeAligned(out, stringColumns[c].data(), numberOfRows * sizeof(uint32_t));
+                break;
+        }
+
+        writeAligned(out, nullMarker.data(), numberOfRows);
+    }
+
+    // write dictionary
+    uint64_t offset = 0;
+    out.write(reinterpret_cast<const char*>(&offset), sizeof(uint64_t));
+    for(const std::string* entry : dictEntries)
+    {
+        offset += entry->size();
+        out.write(reinterpret_cast<const char*>(&offset), sizeof(uint64_t));
+    }
+    for(const std::string* entry : dictEntries) {
+        out.write(entry->c_str(), entry->size());
+    }
+
+    out.close();
+    if(out.fail())
+    {
+        error.addMeesage("failed to write snapshot into file '" + filePath + "'");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief map a snapshot-file into memory
+ *
+ * @param filePath path of the snapshot-file
+ * @param error reference for error-output
+ *
+ * @return true, if successful, else false
+ */
+bool
+TableSnapshot::openSnapshot(const std::string &filePath,
+                            ErrorContainer &error)
+{
+    closeSnapshot();
+
+    const int fd = open(filePath.c_str(), O_RDONLY);
+    if(fd < 0)
+    {
+        error.addMeesage("can not open snapshot-file '" + filePath + "'");
+        return false;
+    }
+
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0
+            || static_cast<uint64_t>(fileStat.st_size) < sizeof(SnapshotHeader))
+    {
+        error.addMeesage("snapshot-file '" + filePath + "' is invalid");
+        close(fd);
+        return false;
+    }
+
+    void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+    {
+        error.addMeesage("can not map snapshot-file '" + filePath + "' into memory");
+        return false;
+    }
+
+    m_data = static_cast<uint8_t*>(data);
+    m_size = static_cast<uint64_t>(fileStat.st_size);
+    m_header = reinterpret_cast<const SnapshotHeader*>(m_data);
+    m_columns = reinterpret_cast<const SnapshotColumn*>(m_data + sizeof(SnapshotHeader));
+
+    if(checkSnapshot(error) == false)
+    {
+        error.addMeesage("snapshot-file '" + filePath + "' is invalid");
+        closeSnapshot();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief unmap the snapshot-file. All spans of the snapshot become invalid.
+ */
+void
+TableSnapshot::closeSnapshot()
+{
+    if(m_data != nullptr) {
+        munmap(m_data, m_size);
+    }
+
+    m_data = nullptr;
+    m_size = 0;
+    m_header = nullptr;
+    m_columns = nullptr;
+}
+
+/**
+ * @brief get number of rows of the snapshot
+ */
+uint64_t
+TableSnapshot::getNumberOfRows() const
+{
+    if(m_header == nullptr) {
+        return 0;
+    }
+
+    return m_header->numberOfRows;
+}
+
+/**
+ * @brief get number of columns of the snapshot
+ */
+uint64_t
+TableSnapshot::getNumberOfColumns() const
+{
+    if(m_header == nullptr) {
+        return 0;
+    }
+
+    return m_header->numberOfColumns;
+}
+
+/**
+ * @brief get name of a column
+ *
+ * @param column index of the column
+ *
+ * @return name of the column, or empty string if index is invalid
+ */
+const std::string
+TableSnapshot::getColumnName(const uint64_t column) const
+{
+    if(column >= getNumberOfColumns()) {
+        return "";
+    }
+
+    return std::string(m_columns[column].name);
+}
+
+/**
+ * @brief get type of a column
+ *
+ * @param column index of the column
+ *
+ * @return type of the column, or NULL_VALUE if index is invalid
+ */
+SqlResult::ValueType
+TableSnapshot::getColumnType(const uint64_t column) const
+{
+    if(column >= getNumberOfColumns()) {
+        return SqlResult::NULL_VALUE;
+    }
+
+    return static_cast<SqlResult::ValueType>(m_columns[column].type);
+}
+
+/**
+ * @brief get index of a column by its name
+ *
+ * @param name name of the column
+ *
+ * @return -1 if not found, else index of the column
+ */
+long
+TableSnapshot::getColumnId(const std::string &name) const
+{
+    for(uint64_t i = 0; i < getNumberOfColumns(); i++)
+    {
+        if(name == m_columns[i].name) {
+            return static_cast<long>(i);
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief get values of an int-column
+ *
+ * @param column index of the column
+ *
+ * @return span over the values, which is empty if the column doesn't exist or has another type
+ */
+ColumnSpan<int64_t>
+TableSnapshot::getIntColumn(const uint64_t column) const
+{
+    ColumnSpan<int64_t> span;
+    const SnapshotColumn* col = getColumn(column, SqlResult::INT_VALUE);
+    if(col != nullptr)
+    {
+        span.data = reinterpret_cast<const int64_t*>(m_data + col->dataPos);
+        span.size = m_header->numberOfRows;
+    }
+
+    return span;
+}
+
+/**
+ * @brief get values of a float-column
+ *
+ * @param column index of the column
+ *
+ * @return span over the values, which is empty if the column doesn't exist or has another type
+ */
+ColumnSpan<double>
+TableSnapshot::getFloatColumn(const uint64_t column) const
+{
+    ColumnSpan<double> span;
+    const SnapshotColumn* col = getColumn(column, SqlResult::FLOAT_VALUE);
+    if(col != nullptr)
+    {
+        span.data = reinterpret_cast<const double*>(m_data + col->dataPos);
+        span.size = m_header->numberOfRows;
+    }
+
+    return span;
+}
+
+/**
+ * @brief get values of a bool-column
+ *
+ * @param column index of the column
+ *
+ * @return span over the values, which is empty if the column doesn't exist or has another type
+ */
+ColumnSpan<uint8_t>
+TableSnapshot::getBoolColumn(const uint64_t column) const
+{
+    ColumnSpan<uint8_t> span;
+    const SnapshotColumn* col = getColumn(column, SqlResult::BOOL_VALUE);
+    if(col != nullptr)
+    {
+        span.data = m_data + col->dataPos;
+        span.size = m_header->numberOfRows;
+    }
+
+    return span;
+}
+
+/**
+ * @brief get dictionary-ids of a string-column
+ *
+ * @param column index of the column
+ *
+ * @return span over the ids, which is empty if the column doesn't exist or has another type
+ */
+ColumnSpan<uint32_t>
+TableSnapshot::getStringColumn(const uint64_t column) const
+{
+    ColumnSpan<uint32_t> span;
+    const SnapshotColumn* col = getColumn(column, SqlResult::STRING_VALUE);
+    if(col != nullptr)
+    {
+        span.data = reinterpret_cast<const uint32_t*>(m_data + col->dataPos);
+        span.size = m_header->numberOfRows;
+    }
+
+    return span;
+}
+
+/**
+ * @brief get null-markers of a column
+ *
+ * @param column index of the column
+ *
+ * @return span over the markers (1 for null, else 0), which is empty if the column doesn't exist
+ */
+ColumnSpan<uint8_t>
+TableSnapshot::getNullColumn(const uint64_t column) const
+{
+    ColumnSpan<uint8_t> span;
+    if(column < getNumberOfColumns())
+    {
+        span.data = m_data + m_columns[column].nullPos;
+        span.size = m_header->numberOfRows;
+    }
+
+    return span;
+}
+
+/**
+ * @brief get number of entries within the string-dictionary
+ */
+uint64_t
+TableSnapshot::getNumberOfDictionaryEntries() const
+{
+    if(m_header == nullptr) {
+        return 0;
+    }
+
+    return m_header->numberOfStrings;
+}
+
+/**
+ * @brief get string from the dictionary
+ *
+ * @param id id of the string
+ *
+ * @return view on the string, or empty view if the id is invalid
+ */
+std::string_view
+TableSnapshot::getDictionaryEntry(const uint64_t id) const
+{
+    if(id >= getNumberOfDictionaryEntries()) {
+        return std::string_view();
+    }
+
+    const uint64_t* offsets = reinterpret_cast<const uint64_t*>(m_data + m_header->dictOffsetsPos);
+    const char* strings = reinterpret_cast<const char*>(m_data + m_header->dictDataPos);
+
+    return std::string_view(strings + offsets[id], offsets[id + 1] - offsets[id]);
+}
+
+/**
+ * @brief get value of a cell of a string-column
+ *
+ * @param row row of the cell
+ * @param column column of the cell
+ *
+ * @return view on the string, or empty view if the cell is null or invalid
+ */
+std::string_view
+TableSnapshot::getString(const uint64_t row,
+                         const uint64_t column) const
+{
+    const ColumnSpan<uint32_t> ids = getStringColumn(column);
+    if(row >= ids.size
+            || getNullColumn(column)[row] != 0)
+    {
+        return std::string_view();
+    }
+
+    return getDictionaryEntry(ids[row]);
+}
+
+/**
+ * @brief get header-entry of a column and check its type
+ *
+ * @param column index of the column
+ * @param type expected type of the column
+ *
+ * @return nullptr, if column doesn't exist or has another type, else pointer to the entry
+ */
+const TableSnapshot::SnapshotColumn*
+TableSnapshot::getColumn(const uint64_t column,
+                         const SqlResult::ValueType type) const
+{
+    if(column >= getNumberOfColumns()
+            || m_columns[column].type != static_cast<uint32_t>(type))
+    {
+        return nullptr;
+    }
+
+    return &m_columns[column];
+}
+
+/**
+ * @brief check that the mapped file is a valid snapshot and all sections are within the file
+ *
+ * @param error reference for error-output
+ *
+ * @return true, if valid, else false
+ */
+bool
+TableSnapshot::checkSnapshot(ErrorContainer &error) const
+{
+    if(memcmp(m_header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0
+            || m_header->version != SNAPSHOT_VERSION)
+    {
+        error.addMeesage("unknown snapshot-format");
+        return false;
+    }
+
+    const uint64_t numberOfRows = m_header->numberOfRows;
+    const uint64_t columnsEnd = sizeof(SnapshotHeader)
+                                + m_header->numberOfColumns * sizeof(SnapshotColumn);
+    if(columnsEnd > m_size)
+    {
+        error.addMeesage("snapshot is truncated");
+        return false;
+    }
+
+    for(uint64_t i = 0; i < m_header->numberOfColumns; i++)
+    {
+        const SnapshotColumn &col = m_columns[i];
+        const SqlResult::ValueType type = static_cast<SqlResult::ValueType>(col.type);
+        if(col.name[sizeof(col.name) - 1] != '\0'
+                || col.dataPos + numberOfRows * getValueSize(type) > m_size
+                || col.nullPos + numberOfRows > m_size)
+        {
+            error.addMeesage("column " + std::to_string(i) + " of snapshot is invalid");
+            return false;
+        }
+    }
+
+    const uint64_t offsetsEnd = m_header->dictOffsetsPos
+                                + (m_header->numberOfStrings + 1) * sizeof(uint64_t);
+    if(offsetsEnd > m_size
+            || m_header->dictDataPos + m_header->dictDataSize > m_size)
+    {
+        error.addMeesage("dictionary of snapshot is invalid");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
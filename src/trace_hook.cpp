@@ -0,0 +1,237 @@
+/**
+ * @file       trace_hook.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <libKitsunemimiSakuraDatabase/trace_hook.h>
+
+#include <stdio.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * @brief escape a string for a json-output
+ *
+ * @param output reference to the output, where the escaped string is appended
+ * @param input string to escape
+ */
+inline void
+appendJsonString(std::string &output,
+                 const std::string &input)
+{
+    output.push_back('"');
+    for(const char c : input)
+    {
+        switch(c)
+        {
+            case '"':
+                output.append("\\\"");
+                break;
+            case '\\':
+                output.append("\\\\");
+                break;
+            case '\n':
+                output.append("\\n");
+                break;
+            case '\t':
+                output.append("\\t");
+                break;
+            default:
+                if(static_cast<unsigned char>(c) < 0x20)
+                {
+                    char hex[8];
+                    snprintf(hex, sizeof(hex), "\\u%04x", c);
+                    output.append(hex);
+                }
+                else
+                {
+                    output.push_back(c);
+                }
+                break;
+        }
+    }
+    output.push_back('"');
+}
+
+/**
+ * @brief called at the start of a span. Does nothing by default.
+ *
+ * @param span span with name, statement, thread and start-time
+ */
+void
+TraceHook::spanStarted(const TraceSpan &span)
+{
+    (void)span;
+}
+
+/**
+ * @brief constructor
+ */
+ChromeTraceWriter::ChromeTraceWriter() {}
+
+/**
+ * @brief destructor, which closes the file, if still open
+ */
+ChromeTraceWriter::~ChromeTraceWriter()
+{
+    ErrorContainer error;
+    closeFile(error);
+}
+
+/**
+ * @brief open a new file for the trace. An existing file is overwritten.
+ *
+ * @param filePath path of the new file
+ * @param error reference for error-output
+ *
+ * @return false, if a file is already open or the file can not be created, else true
+ */
+bool
+ChromeTraceWriter::openFile(const std::string &filePath,
+                            ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_file.is_open())
+    {
+        error.addMeesage("trace-writer has already an open file");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    m_file.open(filePath, std::ios::trunc);
+    if(m_file.is_open() == false)
+    {
+        error.addMeesage("failed to create trace-file '" + filePath + "'");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    m_buffer = "[\n";
+    m_numberOfEvents = 0;
+
+    return true;
+}
+
+/**
+ * @brief write all remaining events and close the file
+ *
+ * @param error reference for error-output
+ *
+ * @return false, if writing the file failed, else true
+ */
+bool
+ChromeTraceWriter::closeFile(ErrorContainer &error)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_file.is_open() == false) {
+        return true;
+    }
+
+    m_buffer.append("\n]\n");
+    flushBuffer();
+    const bool success = m_file.good();
+    m_file.close();
+
+    if(success == false)
+    {
+        error.addMeesage("failed to write trace-file");
+        LOG_ERROR(error);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief get number of events, which were written into the current file
+ *
+ * @return number of events
+ */
+uint64_t
+ChromeTraceWriter::getNumberOfEvents()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_numberOfEvents;
+}
+
+/**
+ * @brief convert a finished span into a complete-event and add it to the file. Events are
+ *        buffered and written in blocks, so the file is not written for each span.
+ *
+ * @param span finished span
+ */
+void
+ChromeTraceWriter::spanFinished(const TraceSpan &span)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    if(m_file.is_open() == false) {
+        return;
+    }
+
+    if(m_numberOfEvents > 0) {
+        m_buffer.append(",\n");
+    }
+    m_numberOfEvents++;
+
+    std::string name = span.operation;
+    if(span.type == TraceSpan::OPERATION_SPAN) {
+        name = span.tableName + "." + span.operation;
+    }
+
+    m_buffer.append("{\"name\":");
+    appendJsonString(m_buffer, name);
+    m_buffer.append(span.type == TraceSpan::OPERATION_SPAN ? ",\"cat\":\"operation\""
+                                                           : ",\"cat\":\"query\"");
+    m_buffer.append(",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(span.threadId));
+    m_buffer.append(",\"ts\":" + std::to_string(span.startTime));
+    m_buffer.append(",\"dur\":" + std::to_string(span.duration));
+    m_buffer.append(",\"args\":{\"table\":");
+    appendJsonString(m_buffer, span.tableName);
+    m_buffer.append(",\"statement\":");
+    appendJsonString(m_buffer, span.statement);
+    m_buffer.append(",\"rows_affected\":" + std::to_string(span.rowsAffected));
+    m_buffer.append(",\"rows_returned\":" + std::to_string(span.rowsReturned));
+    m_buffer.append(",\"lock_wait_us\":" + std::to_string(span.lockWaitDuration));
+    m_buffer.append(",\"execute_us\":" + std::to_string(span.executeDuration));
+    m_buffer.append(span.success ? ",\"success\":true}}" : ",\"success\":false}}");
+
+    if(m_buffer.size() > 65536) {
+        flushBuffer();
+    }
+}
+
+/**
+ * @brief write the buffered events into the file. Must be called while m_lock is held.
+ */
+void
+ChromeTraceWriter::flushBuffer()
+{
+    m_file.write(m_buffer.c_str(), static_cast<std::streamsize>(m_buffer.size()));
+    m_buffer.clear();
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
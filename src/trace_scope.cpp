@@ -0,0 +1,211 @@
+/**
+ * @file       trace_scope.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <trace_scope.h>
+
+#include <chrono>
+#include <atomic>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+// operation-span, which is currently running within the thread
+thread_local TraceScope* t_currentOperation = nullptr;
+
+/**
+ * @brief get current time of the monotonic clock
+ *
+ * @return time in microseconds
+ */
+inline int64_t
+getTraceTime()
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+/**
+ * @brief get a small id of the current thread, which is better readable within traces than the
+ *        native thread-id
+ *
+ * @return id of the thread
+ */
+inline uint64_t
+getTraceThreadId()
+{
+    static std::atomic<uint64_t> nextThreadId(1);
+    thread_local const uint64_t threadId = nextThreadId.fetch_add(1);
+    return threadId;
+}
+
+/**
+ * @brief constructor, which starts the span, if a hook is given
+ *
+ * @param hook hook of the database, or nullptr if tracing is disabled
+ * @param type type of the span
+ * @param operation name of the operation
+ * @param tableName name of the table, only used for operation-spans
+ * @param statement shape of the statement, only used for query-spans
+ */
+TraceScope::TraceScope(TraceHook* hook,
+                       const TraceSpan::SpanType type,
+                       const char* operation,
+                       const std::string &tableName,
+                       const std::string &statement)
+{
+    if(hook == nullptr) {
+        return;
+    }
+
+    if(type == TraceSpan::OPERATION_SPAN)
+    {
+        // only the outermost operation is traced
+        if(t_currentOperation != nullptr) {
+            return;
+        }
+        m_span.tableName = tableName;
+        t_currentOperation = this;
+    }
+    else
+    {
+        // queries are failed, until they report the success at their end
+        m_span.success = false;
+        m_span.statement = statement;
+        if(t_currentOperation != nullptr)
+        {
+            m_parent = t_currentOperation;
+            m_span.tableName = m_parent->m_span.tableName;
+        }
+    }
+
+    m_hook = hook;
+    m_span.type = type;
+    m_span.operation = operation;
+    m_span.threadId = getTraceThreadId();
+    m_span.startTime = getTraceTime();
+
+    m_hook->spanStarted(m_span);
+}
+
+/**
+ * @brief destructor, which finishes the span and calls the hook
+ */
+TraceScope::~TraceScope()
+{
+    if(m_hook == nullptr) {
+        return;
+    }
+
+    m_span.duration = static_cast<uint64_t>(getTraceTime() - m_span.startTime);
+    if(m_span.lockWaitDuration < m_span.duration) {
+        m_span.executeDuration = m_span.duration - m_span.lockWaitDuration;
+    }
+
+    if(m_parent != nullptr)
+    {
+        TraceSpan* parentSpan = &m_parent->m_span;
+        parentSpan->rowsAffected += m_span.rowsAffected;
+        parentSpan->rowsReturned += m_span.rowsReturned;
+        parentSpan->lockWaitDuration += m_span.lockWaitDuration;
+        parentSpan->success &= m_span.success;
+    }
+    if(t_currentOperation == this) {
+        t_currentOperation = nullptr;
+    }
+
+    m_hook->spanFinished(m_span);
+}
+
+/**
+ * @brief check if the span is traced
+ *
+ * @return true, if a hook is set, else false
+ */
+bool
+TraceScope::isActive() const
+{
+    return m_hook != nullptr;
+}
+
+/**
+ * @brief start measuring the time to wait for a lock or a connection
+ */
+void
+TraceScope::startLockWait()
+{
+    if(m_hook == nullptr) {
+        return;
+    }
+
+    m_lockWaitStart = getTraceTime();
+}
+
+/**
+ * @brief stop measuring the time to wait for a lock or a connection
+ */
+void
+TraceScope::stopLockWait()
+{
+    if(m_hook == nullptr) {
+        return;
+    }
+
+    m_span.lockWaitDuration += static_cast<uint64_t>(getTraceTime() - m_lockWaitStart);
+}
+
+/**
+ * @brief add rows to the span
+ *
+ * @param rowsAffected number of rows, which were changed
+ * @param rowsReturned number of rows, which were returned
+ */
+void
+TraceScope::addRows(const uint64_t rowsAffected,
+                    const uint64_t rowsReturned)
+{
+    if(m_hook == nullptr) {
+        return;
+    }
+
+    m_span.rowsAffected += rowsAffected;
+    m_span.rowsReturned += rowsReturned;
+}
+
+/**
+ * @brief set the result of the span
+ *
+ * @param success false, if the request failed
+ */
+void
+TraceScope::setSuccess(const bool success)
+{
+    if(m_hook == nullptr) {
+        return;
+    }
+
+    m_span.success = success;
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
@@ -0,0 +1,70 @@
+/**
+ * @file       trace_scope.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_TRACE_SCOPE_H
+#define KITSUNEMIMI_SAKURA_DATABASE_TRACE_SCOPE_H
+
+#include <string>
+#include <stdint.h>
+
+#include <libKitsunemimiSakuraDatabase/trace_hook.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * Span, which is started by the constructor and finished by the destructor. Without hook, the
+ * scope is inactive and all methods return without reading the clock. Query-spans within an
+ * operation-span of the same thread take the table-name of the operation and add their rows and
+ * durations to the operation, so the database-time is attributed to the operation. Operations
+ * within another operation are not traced separately.
+ */
+class TraceScope
+{
+public:
+    TraceScope(TraceHook* hook,
+               const TraceSpan::SpanType type,
+               const char* operation,
+               const std::string &tableName = "",
+               const std::string &statement = "");
+    ~TraceScope();
+
+    bool isActive() const;
+    void startLockWait();
+    void stopLockWait();
+    void addRows(const uint64_t rowsAffected,
+                 const uint64_t rowsReturned);
+    void setSuccess(const bool success);
+
+private:
+    TraceHook* m_hook = nullptr;
+    TraceScope* m_parent = nullptr;
+    TraceSpan m_span;
+    int64_t m_lockWaitStart = 0;
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_TRACE_SCOPE_H
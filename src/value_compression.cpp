@@ -0,0 +1,180 @@
+/**
+ * @file       value_compression.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#include <value_compression.h>
+
+#include <sqlite3.h>
+#include <zlib.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+// shorter values are not compressed, because the header and the zlib-overhead would make them
+// bigger instead of smaller
+const uint64_t MIN_COMPRESSION_SIZE = 64;
+const uint64_t SIZE_HEADER_LENGTH = 4;
+
+/**
+ * @brief sql-function to compress a text. The result is a blob with the size of the original
+ *        text as 4 byte little-endian header, followed by the zlib-compressed text. Null-values,
+ *        short texts and texts, which can not be compressed, are returned unchanged. The result
+ *        is the same for the same input, so it can also be compared with already stored values.
+ *
+ * @param context sqlite-context for the result
+ * @param argc number of arguments, always 1
+ * @param argv arguments
+ */
+static void
+compressValue(sqlite3_context* context,
+              int argc,
+              sqlite3_value** argv)
+{
+    (void)argc;
+
+    const uint64_t size = static_cast<uint64_t>(sqlite3_value_bytes(argv[0]));
+    if(sqlite3_value_type(argv[0]) != SQLITE_TEXT
+            || size < MIN_COMPRESSION_SIZE
+            || size > UINT32_MAX)
+    {
+        sqlite3_result_value(context, argv[0]);
+        return;
+    }
+
+    const Bytef* input = sqlite3_value_text(argv[0]);
+    uLongf compressedSize = compressBound(size);
+    uint8_t* output = static_cast<uint8_t*>(sqlite3_malloc64(compressedSize
+                                                             + SIZE_HEADER_LENGTH));
+    if(output == nullptr)
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    if(compress2(output + SIZE_HEADER_LENGTH,
+                 &compressedSize,
+                 input,
+                 size,
+                 Z_DEFAULT_COMPRESSION) != Z_OK
+            || compressedSize + SIZE_HEADER_LENGTH >= size)
+    {
+        sqlite3_free(output);
+        sqlite3_result_value(context, argv[0]);
+        return;
+    }
+
+    for(uint64_t i = 0; i < SIZE_HEADER_LENGTH; i++) {
+        output[i] = static_cast<uint8_t>(size >> (8 * i));
+    }
+    sqlite3_result_blob64(context, output, compressedSize + SIZE_HEADER_LENGTH, sqlite3_free);
+}
+
+/**
+ * @brief sql-function to decompress a value, which was compressed with compressValue. Values,
+ *        which are not a blob, were not compressed and are returned unchanged.
+ *
+ * @param context sqlite-context for the result
+ * @param argc number of arguments, always 1
+ * @param argv arguments
+ */
+static void
+decompressValue(sqlite3_context* context,
+                int argc,
+                sqlite3_value** argv)
+{
+    (void)argc;
+
+    if(sqlite3_value_type(argv[0]) != SQLITE_BLOB)
+    {
+        sqlite3_result_value(context, argv[0]);
+        return;
+    }
+
+    const uint8_t* input = static_cast<const uint8_t*>(sqlite3_value_blob(argv[0]));
+    const uint64_t inputSize = static_cast<uint64_t>(sqlite3_value_bytes(argv[0]));
+    if(inputSize < SIZE_HEADER_LENGTH)
+    {
+        sqlite3_result_error(context, "invalid compressed value", -1);
+        return;
+    }
+
+    uLongf size = 0;
+    for(uint64_t i = 0; i < SIZE_HEADER_LENGTH; i++) {
+        size |= static_cast<uLongf>(input[i]) << (8 * i);
+    }
+
+    char* output = static_cast<char*>(sqlite3_malloc64(size + 1));
+    if(output == nullptr)
+    {
+        sqlite3_result_error_nomem(context);
+        return;
+    }
+
+    const uLongf expectedSize = size;
+    if(uncompress(reinterpret_cast<Bytef*>(output),
+                  &size,
+                  input + SIZE_HEADER_LENGTH,
+                  inputSize - SIZE_HEADER_LENGTH) != Z_OK
+            || size != expectedSize)
+    {
+        sqlite3_free(output);
+        sqlite3_result_error(context, "invalid compressed value", -1);
+        return;
+    }
+
+    sqlite3_result_text64(context, output, size, sqlite3_free, SQLITE_UTF8);
+}
+
+/**
+ * @brief register the sql-functions for compressed columns on a database-connection
+ *
+ * @param db database-connection
+ *
+ * @return true, if successful, else false
+ */
+bool
+registerCompressionFunctions(sqlite3* db)
+{
+    const int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC | SQLITE_INNOCUOUS;
+
+    return sqlite3_create_function(db,
+                                   COMPRESS_FUNCTION.c_str(),
+                                   1,
+                                   flags,
+                                   nullptr,
+                                   compressValue,
+                                   nullptr,
+                                   nullptr) == SQLITE_OK
+           && sqlite3_create_function(db,
+                                      DECOMPRESS_FUNCTION.c_str(),
+                                      1,
+                                      flags,
+                                      nullptr,
+                                      decompressValue,
+                                      nullptr,
+                                      nullptr) == SQLITE_OK;
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
@@ -0,0 +1,45 @@
+/**
+ * @file       value_compression.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_VALUE_COMPRESSION_H
+#define KITSUNEMIMI_SAKURA_DATABASE_VALUE_COMPRESSION_H
+
+#include <string>
+
+struct sqlite3;
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+// sql-functions to compress and decompress the values of compressed columns
+const std::string COMPRESS_FUNCTION = "sakura_compress";
+const std::string DECOMPRESS_FUNCTION = "sakura_decompress";
+
+bool registerCompressionFunctions(sqlite3* db);
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_VALUE_COMPRESSION_H
@@ -0,0 +1,328 @@
+/**
+ * @file       write_back_cache.cpp
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#include <write_back_cache.h>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * @brief constructor
+ *
+ * @param primaryKeyId index of the primary-key column
+ */
+WriteBackCache::WriteBackCache(const uint64_t primaryKeyId)
+{
+    m_primaryKeyId = primaryKeyId;
+}
+
+/**
+ * @brief add a row, which was loaded from the database, so it is not dirty
+ *
+ * @param row row to add
+ */
+void
+WriteBackCache::loadRow(const CachedRow &row)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    CachedRow newRow = row;
+    newRow.isDirty = false;
+    newRow.isDeleted = false;
+    m_rows[newRow.values.at(m_primaryKeyId)] = newRow;
+}
+
+/**
+ * @brief insert a new row
+ *
+ * @param row row to insert
+ *
+ * @return false, if a row with the same primary key already exist, else true
+ */
+bool
+WriteBackCache::insertRow(const CachedRow &row)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    const std::string &key = row.values.at(m_primaryKeyId);
+    std::unordered_map<std::string, CachedRow>::iterator it = m_rows.find(key);
+    if(it != m_rows.end()
+            && it->second.isDeleted == false)
+    {
+        return false;
+    }
+
+    // a tombstone is replaced by the new row and so the dirty-counter is not changed
+    CachedRow newRow = row;
+    newRow.isDeleted = false;
+    newRow.isDirty = it != m_rows.end() && it->second.isDirty;
+    markDirty(newRow);
+    m_rows[key] = newRow;
+
+    return true;
+}
+
+/**
+ * @brief update all rows, which match the conditions
+ *
+ * @param conditions conditions to filter the rows
+ * @param updates new values
+ *
+ * @return primary keys of all updated rows
+ */
+const std::vector<std::string>
+WriteBackCache::updateRows(const ColumnValues &conditions,
+                           const ColumnValues &updates)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::vector<std::string> keys;
+    for(CachedRow* row : findRows(conditions))
+    {
+        for(const auto &update : updates)
+        {
+            row->values[update.first] = update.second;
+            row->isNull[update.first] = false;
+        }
+        markDirty(*row);
+        keys.push_back(row->values.at(m_primaryKeyId));
+    }
+
+    return keys;
+}
+
+/**
+ * @brief delete all rows, which match the conditions
+ *
+ * @param conditions conditions to filter the rows. If empty, all rows are deleted.
+ *
+ * @return primary keys of all deleted rows
+ */
+const std::vector<std::string>
+WriteBackCache::deleteRows(const ColumnValues &conditions)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::vector<std::string> keys;
+    for(CachedRow* row : findRows(conditions))
+    {
+        row->isDeleted = true;
+        markDirty(*row);
+        keys.push_back(row->values.at(m_primaryKeyId));
+    }
+
+    return keys;
+}
+
+/**
+ * @brief get the first row, which matches the conditions
+ *
+ * @param conditions conditions to filter the rows
+ * @param row reference for the output
+ *
+ * @return false, if no row was found, else true
+ */
+bool
+WriteBackCache::getRow(const ColumnValues &conditions,
+                       CachedRow &row)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    const std::vector<CachedRow*> rows = findRows(conditions);
+    if(rows.size() == 0) {
+        return false;
+    }
+
+    row = *rows.at(0);
+
+    return true;
+}
+
+/**
+ * @brief get number of rows, which are not written into the database
+ */
+uint64_t
+WriteBackCache::getNumberOfDirtyRows()
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_numberOfDirtyRows;
+}
+
+/**
+ * @brief take all dirty rows out of the cache to write them into the database. The rows are
+ *        marked as clean and tombstones are removed.
+ *
+ * @param changedRows reference for all inserted or updated rows
+ * @param deletedKeys reference for the primary keys of all deleted rows
+ */
+void
+WriteBackCache::takeDirtyRows(std::vector<CachedRow> &changedRows,
+                              std::vector<std::string> &deletedKeys)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    std::unordered_map<std::string, CachedRow>::iterator it = m_rows.begin();
+    while(it != m_rows.end())
+    {
+        if(it->second.isDirty == false)
+        {
+            it++;
+            continue;
+        }
+
+        if(it->second.isDeleted)
+        {
+            deletedKeys.push_back(it->first);
+            it = m_rows.erase(it);
+            continue;
+        }
+
+        it->second.isDirty = false;
+        changedRows.push_back(it->second);
+        it++;
+    }
+
+    m_numberOfDirtyRows = 0;
+}
+
+/**
+ * @brief mark rows as dirty again, after writing them into the database has failed. Rows, which
+ *        were changed in the meantime, keep their newer state.
+ *
+ * @param changedRows inserted or updated rows, which were not written
+ * @param deletedKeys primary keys of deleted rows, which were not written
+ */
+void
+WriteBackCache::restoreDirtyRows(const std::vector<CachedRow> &changedRows,
+                                 const std::vector<std::string> &deletedKeys)
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+
+    for(const CachedRow &row : changedRows)
+    {
+        std::unordered_map<std::string, CachedRow>::iterator it =
+                m_rows.find(row.values.at(m_primaryKeyId));
+        if(it != m_rows.end()) {
+            markDirty(it->second);
+        }
+    }
+
+    for(const std::string &key : deletedKeys)
+    {
+        if(m_rows.find(key) != m_rows.end()) {
+            continue;
+        }
+
+        CachedRow tombstone;
+        tombstone.values.resize(m_primaryKeyId + 1);
+        tombstone.isNull.resize(m_primaryKeyId + 1, true);
+        tombstone.values[m_primaryKeyId] = key;
+        tombstone.isDeleted = true;
+        markDirty(tombstone);
+        m_rows.emplace(key, tombstone);
+    }
+}
+
+/**
+ * @brief mark a row as dirty and count it, if it was not already dirty
+ *
+ * @param row row to mark
+ */
+void
+WriteBackCache::markDirty(CachedRow &row)
+{
+    if(row.isDirty == false)
+    {
+        row.isDirty = true;
+        m_numberOfDirtyRows++;
+    }
+}
+
+/**
+ * @brief check if a row matches all conditions
+ *
+ * @param row row to check
+ * @param conditions conditions to check
+ *
+ * @return true, if all conditions match, else false
+ */
+bool
+WriteBackCache::matchConditions(const CachedRow &row,
+                                const ColumnValues &conditions) const
+{
+    for(const auto &condition : conditions)
+    {
+        if(row.isNull.at(condition.first)
+                || row.values.at(condition.first) != condition.second)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief find all rows, which match the conditions. If there is a condition for the primary key,
+ *        the row is searched by the key, else all rows are checked.
+ *
+ * @param conditions conditions to filter the rows
+ *
+ * @return list with pointers to the found rows
+ */
+const std::vector<WriteBackCache::CachedRow*>
+WriteBackCache::findRows(const ColumnValues &conditions)
+{
+    std::vector<CachedRow*> result;
+
+    for(const auto &condition : conditions)
+    {
+        if(condition.first != m_primaryKeyId) {
+            continue;
+        }
+
+        std::unordered_map<std::string, CachedRow>::iterator it = m_rows.find(condition.second);
+        if(it != m_rows.end()
+                && it->second.isDeleted == false
+                && matchConditions(it->second, conditions))
+        {
+            result.push_back(&it->second);
+        }
+        return result;
+    }
+
+    for(auto &entry : m_rows)
+    {
+        if(entry.second.isDeleted == false
+                && matchConditions(entry.second, conditions))
+        {
+            result.push_back(&entry.second);
+        }
+    }
+
+    return result;
+}
+
+} // namespace Sakura
+} // namespace Kitsunemimi
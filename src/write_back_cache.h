@@ -0,0 +1,88 @@
+/**
+ * @file       write_back_cache.h
+ *
+ * @author     Tobias Anker <tobias.anker@kitsunemimi.moe>
+ *
+ * @copyright  Apache License Version 2.0
+ *
+ *      Copyright 2021 Tobias Anker
+ *
+ *      Licensed under the Apache License, Version 2.0 (the "License");
+ *      you may not use this file except in compliance with the License.
+ *      You may obtain a copy of the License at
+ *
+ *          http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *      Unless required by applicable law or agreed to in writing, software
+ *      distributed under the License is distributed on an "AS IS" BASIS,
+ *      WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *      See the License for the specific language governing permissions and
+ *      limitations under the License.
+ */
+
+#ifndef KITSUNEMIMI_SAKURA_DATABASE_WRITE_BACK_CACHE_H
+#define KITSUNEMIMI_SAKURA_DATABASE_WRITE_BACK_CACHE_H
+
+#include <vector>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+namespace Kitsunemimi
+{
+namespace Sakura
+{
+
+/**
+ * In-memory state of a table in write-back mode. The rows are stored by their primary key as
+ * strings, like they are used in the sql-requests. Changed rows are marked as dirty and can be
+ * taken out of the cache to write them into the database. Deleted rows stay in the cache as
+ * tombstones until they are written into the database.
+ */
+class WriteBackCache
+{
+public:
+    struct CachedRow
+    {
+        std::vector<std::string> values;
+        std::vector<bool> isNull;
+        bool isDirty = false;
+        bool isDeleted = false;
+    };
+
+    // pairs of column-index and value
+    typedef std::vector<std::pair<uint64_t, std::string>> ColumnValues;
+
+    WriteBackCache(const uint64_t primaryKeyId);
+
+    void loadRow(const CachedRow &row);
+    bool insertRow(const CachedRow &row);
+    const std::vector<std::string> updateRows(const ColumnValues &conditions,
+                                              const ColumnValues &updates);
+    const std::vector<std::string> deleteRows(const ColumnValues &conditions);
+    bool getRow(const ColumnValues &conditions,
+                CachedRow &row);
+
+    uint64_t getNumberOfDirtyRows();
+    void takeDirtyRows(std::vector<CachedRow> &changedRows,
+                       std::vector<std::string> &deletedKeys);
+    void restoreDirtyRows(const std::vector<CachedRow> &changedRows,
+                          const std::vector<std::string> &deletedKeys);
+
+private:
+    std::mutex m_lock;
+    uint64_t m_primaryKeyId = 0;
+    uint64_t m_numberOfDirtyRows = 0;
+    std::unordered_map<std::string, CachedRow> m_rows;
+
+    void markDirty(CachedRow &row);
+    bool matchConditions(const CachedRow &row,
+                         const ColumnValues &conditions) const;
+    const std::vector<CachedRow*> findRows(const ColumnValues &conditions);
+};
+
+} // namespace Sakura
+} // namespace Kitsunemimi
+
+#endif // KITSUNEMIMI_SAKURA_DATABASE_WRITE_BACK_CACHE_H
@@ -7,11 +7,6 @@ CONFIG += c++17 console
 
 LIBS += -L../../src -lKitsunemimiSakuraDatabase
 
-LIBS += -L../../../libKitsunemimiSqlite/src -lKitsunemimiSqlite
-LIBS += -L../../../libKitsunemimiSqlite/src/debug -lKitsunemimiSqlite
-LIBS += -L../../../libKitsunemimiSqlite/src/release -lKitsunemimiSqlite
-INCLUDEPATH += ../../../libKitsunemimiSqlite/include
-
 LIBS += -L../../../libKitsunemimiJson/src -lKitsunemimiJson
 LIBS += -L../../../libKitsunemimiJson/src/debug -lKitsunemimiJson
 LIBS += -L../../../libKitsunemimiJson/src/release -lKitsunemimiJson
@@ -23,6 +18,7 @@ LIBS += -L../../../libKitsunemimiCommon/src/release -lKitsunemimiCommon
 INCLUDEPATH += ../../../libKitsunemimiCommon/include
 
 LIBS += -lsqlite3
+LIBS += -lz
 
 INCLUDEPATH += $$PWD
 
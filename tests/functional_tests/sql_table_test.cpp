@@ -2,11 +2,24 @@
 
 #include <libKitsunemimiSakuraDatabase/sql_database.h>
 #include <libKitsunemimiSakuraDatabase/sql_table.h>
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
+#include <libKitsunemimiSakuraDatabase/table_snapshot.h>
+#include <libKitsunemimiSakuraDatabase/trace_hook.h>
 
 #include <libKitsunemimiJson/json_item.h>
 
 #include <test_table.h>
 
+#include <atomic>
+#include <future>
+#include <fstream>
+#include <set>
+#include <limits>
+#include <thread>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace Kitsunemimi
 {
 namespace Sakura
@@ -23,9 +36,33 @@ SqlTable_Test::SqlTable_Test()
     create_test();
     get_test();
     getAll_test();
+    getAllResult_test();
+    exportSnapshot_test();
     update_test();
     delete_test();
     getNumberOfRows_test();
+    importFromFile_test();
+    backupDatabase_test();
+    changeFeed_test();
+    typedTable_test();
+    blob_test();
+    queryPlan_test();
+    asyncRequests_test();
+    timeToLive_test();
+    writeBack_test();
+    memoryDatabase_test();
+    aggregate_test();
+    search_test();
+    orderBy_test();
+    parallelReads_test();
+    getMany_test();
+    join_test();
+    maintenance_test();
+    readReplica_test();
+    compression_test();
+    versionColumn_test();
+    tracing_test();
+    resultLimit_test();
 }
 
 /**
@@ -46,7 +83,7 @@ SqlTable_Test::initDatabase_test()
 {
     Kitsunemimi::ErrorContainer error;
     m_db = new SqlDatabase();
-    TEST_EQUAL(m_db->initDatabase(m_filePath, error), true);
+    TEST_EQUAL(m_db->initDatabase(m_filePath, error, 4), true);
 }
 
 /**
@@ -132,6 +169,71 @@ SqlTable_Test::getAll_test()
     TEST_EQUAL(result.getCell(0, 0), m_name2);
 }
 
+/**
+ * @brief getAllResult_test
+ */
+void
+SqlTable_Test::getAllResult_test()
+{
+    SqlResult result;
+    ErrorContainer error;
+
+    TEST_EQUAL(m_table->getAllUser(result, error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 2);
+    TEST_EQUAL(result.getNumberOfColumns(), 3);
+    TEST_EQUAL(result.getString(0, 0), std::string_view(m_name1));
+    TEST_EQUAL(result.getBool(0, 2), true);
+    TEST_EQUAL(result.getBool(1, 2), false);
+
+    // hidden values are skipped while converting
+    TableItem table;
+    TEST_EQUAL(result.toTableItem(table), true);
+    TEST_EQUAL(table.getNumberOfRows(), 2);
+    TEST_EQUAL(table.getNumberOfColums(), 2);
+
+    JsonItem json;
+    TEST_EQUAL(result.toJsonItem(json, 0), true);
+    TEST_EQUAL(json.toString(), std::string("{\"is_admin\":true,\"name\":\"user0815\"}"));
+
+    // test with limitation
+    TEST_EQUAL(m_table->getAllUser(result, error, true, 1, 10), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(result.getString(0, 0), std::string_view(m_name2));
+    TEST_EQUAL(result.getString(0, 1), std::string_view("secret2"));
+}
+
+/**
+ * @brief exportSnapshot_test
+ */
+void
+SqlTable_Test::exportSnapshot_test()
+{
+    ErrorContainer error;
+    const std::string snapshotPath = "/tmp/testdb.snapshot";
+
+    // use small steps to read the table with multiple requests
+    TEST_EQUAL(m_table->exportUsers(snapshotPath, error, 1), true);
+
+    TableSnapshot snapshot;
+    TEST_EQUAL(snapshot.openSnapshot(snapshotPath, error), true);
+    TEST_EQUAL(snapshot.getNumberOfRows(), 2);
+    TEST_EQUAL(snapshot.getNumberOfColumns(), 2);
+    TEST_EQUAL(snapshot.getColumnName(0), "name");
+    TEST_EQUAL(snapshot.getColumnId("pw_hash"), -1);
+    TEST_EQUAL(snapshot.getString(0, 0), std::string_view(m_name1));
+    TEST_EQUAL(snapshot.getString(1, 0), std::string_view(m_name2));
+    TEST_EQUAL(snapshot.getNumberOfDictionaryEntries(), 2);
+
+    const ColumnSpan<uint8_t> isAdmin = snapshot.getBoolColumn(1);
+    TEST_EQUAL(isAdmin.size, 2);
+    TEST_EQUAL(isAdmin[0], 1);
+    TEST_EQUAL(isAdmin[1], 0);
+    TEST_EQUAL(snapshot.getIntColumn(1).size, 0);
+
+    snapshot.closeSnapshot();
+    std::filesystem::remove(snapshotPath);
+}
+
 /**
  * @brief update_test
  */
@@ -206,6 +308,1461 @@ SqlTable_Test::getNumberOfRows_test()
     TEST_EQUAL(m_table->getNumberOfUsers(error), 2);
 }
 
+/**
+ * @brief importFromFile_test
+ */
+void
+SqlTable_Test::importFromFile_test()
+{
+    ErrorContainer error;
+
+    // csv with quoted values and a line-break within a quoted value
+    const std::string csvInput = "is_admin,name,pw_hash\n"
+                                 "true,csv1,\"sec,ret\"\n"
+                                 "false,\"csv\"\"2\",secret\r\n"
+                                 "0,\"csv\n3\",secret\n";
+    TEST_EQUAL(importString(csvInput, true), 3);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 5);
+
+    JsonItem resultItem;
+    TEST_EQUAL(m_table->getUser(resultItem, "csv\"2", error, true), true);
+    TEST_EQUAL(resultItem.get("pw_hash").getString(), "secret");
+
+    // json-lines
+    const std::string jsonInput = "{\"name\": \"json1\", \"pw_hash\": \"x\", \"is_admin\": true}\n"
+                                  "\n"
+                                  "{\"name\":\"json\\u00e42\",\"pw_hash\":\"y\","
+                                  "\"is_admin\":false}";
+    TEST_EQUAL(importString(jsonInput, false), 2);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 7);
+    TEST_EQUAL(m_table->getUser(resultItem, "json\u00e42", error), true);
+
+    // invalid input
+    TEST_EQUAL(importString("name,pw_hash\nfail,secret\n", true), -1);
+    TEST_EQUAL(importString("{\"name\":\"a\",\"is_admin\":\"maybe\",\"pw_hash\":\"x\"}", false), -1);
+    TEST_EQUAL(importString("{\"unknown\":1}\n", false), -1);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 7);
+
+    // import within an open transaction of the caller, which is not ended by the import
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "BEGIN;", error), true);
+    TEST_EQUAL(importString("{\"name\":\"tx1\",\"pw_hash\":\"x\",\"is_admin\":true}", false), 1);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 8);
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "ROLLBACK;", error), true);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 7);
+}
+
+/**
+ * @brief backupDatabase_test
+ */
+void
+SqlTable_Test::backupDatabase_test()
+{
+    ErrorContainer error;
+    const std::string backupPath = "/tmp/testdb_backup.db";
+    std::filesystem::remove(backupPath);
+
+    // backup into file with one page per step
+    int numberOfSteps = 0;
+    TEST_EQUAL(m_db->backupDatabase(backupPath,
+                                    error,
+                                    1,
+                                    0,
+                                    [&](const int, const int) { numberOfSteps++; }), true);
+    TEST_NOT_EQUAL(numberOfSteps, 0);
+
+    SqlDatabase backupDb;
+    TEST_EQUAL(backupDb.initDatabase(backupPath, error), true);
+    TestTable backupTable(&backupDb);
+    TEST_EQUAL(backupTable.getNumberOfUsers(error), 7);
+    backupDb.closeDatabase();
+    std::filesystem::remove(backupPath);
+
+    // backup into another open database
+    SqlDatabase snapshotDb;
+    TEST_EQUAL(snapshotDb.initDatabase(":memory:", error), true);
+    TEST_EQUAL(m_db->backupDatabase(snapshotDb, error), true);
+    TestTable snapshotTable(&snapshotDb);
+    TEST_EQUAL(snapshotTable.getNumberOfUsers(error), 7);
+    TEST_EQUAL(m_db->backupDatabase(*m_db, error), false);
+}
+
+/**
+ * @brief changeFeed_test
+ */
+void
+SqlTable_Test::changeFeed_test()
+{
+    ErrorContainer error;
+    std::vector<ChangeEvent> events;
+
+    const uint64_t id = m_table->subscribeChanges([&](const std::vector<ChangeEvent> &batch) {
+        events.insert(events.end(), batch.begin(), batch.end());
+    });
+
+    JsonItem testData;
+    testData.insert("name", "feed");
+    testData.insert("pw_hash", "secret");
+    testData.insert("is_admin", true);
+    TEST_EQUAL(m_table->addUser(testData, error), true);
+
+    JsonItem updateData;
+    updateData.insert("is_admin", false);
+    TEST_EQUAL(m_table->updateUser("feed", updateData, error), true);
+    TEST_EQUAL(m_table->deleteUser("feed", error), true);
+
+    m_table->flushChanges();
+    TEST_EQUAL(events.size(), 3);
+    if(events.size() == 3)
+    {
+        TEST_EQUAL(events.at(0).type, ChangeEvent::INSERT_CHANGE);
+        TEST_EQUAL(events.at(1).type, ChangeEvent::UPDATE_CHANGE);
+        TEST_EQUAL(events.at(2).type, ChangeEvent::DELETE_CHANGE);
+        TEST_EQUAL(events.at(0).primaryKey, events.at(2).primaryKey);
+    }
+
+    // no events after unsubscribe
+    TEST_EQUAL(m_table->unsubscribeChanges(id), true);
+    TEST_EQUAL(m_table->deleteUser("csv1", error), true);
+    m_table->flushChanges();
+    TEST_EQUAL(events.size(), 3);
+}
+
+/**
+ * @brief typedTable_test
+ */
+void
+SqlTable_Test::typedTable_test()
+{
+    ErrorContainer error;
+    TypedTable<TypedUserSchema> typedTable(m_db);
+    TEST_EQUAL(typedTable.initTable(error), true);
+
+    TypedUser user;
+    user.name = "typed0";
+    user.pwHash = "secret";
+    user.isAdmin = true;
+    user.loginCount = 42;
+    TEST_EQUAL(typedTable.insertToDb(user, error), true);
+    user.name = "typed1";
+    user.isAdmin = false;
+    TEST_EQUAL(typedTable.insertToDb(user, error), true);
+    TEST_EQUAL(typedTable.insertToDb(user, error), false);
+
+    TypedUser result;
+    TEST_EQUAL(typedTable.getFromDb(result, "typed0", error), true);
+    TEST_EQUAL(result.name, "typed0");
+    TEST_EQUAL(result.pwHash, "secret");
+    TEST_EQUAL(result.isAdmin, true);
+    TEST_EQUAL(result.loginCount, 42);
+    TEST_EQUAL(typedTable.getFromDb(result, "fail", error), false);
+
+    result.loginCount = 43;
+    TEST_EQUAL(typedTable.updateInDb(result, error), true);
+    TEST_EQUAL(typedTable.getFromDb(result, "typed0", error), true);
+    TEST_EQUAL(result.loginCount, 43);
+
+    std::vector<TypedUser> rows;
+    TEST_EQUAL(typedTable.getAllFromDb(rows, error), true);
+    TEST_EQUAL(rows.size(), 2);
+    rows.clear();
+    TEST_EQUAL(typedTable.getAllFromDb(rows, error, 1, 1), true);
+    TEST_EQUAL(rows.size(), 1);
+    if(rows.size() == 1)
+    {
+        TEST_EQUAL(rows.at(0).name, "typed1");
+        TEST_EQUAL(rows.at(0).isAdmin, false);
+    }
+
+    TEST_EQUAL(typedTable.deleteFromDb("typed1", error), true);
+    rows.clear();
+    TEST_EQUAL(typedTable.getAllFromDb(rows, error), true);
+    TEST_EQUAL(rows.size(), 1);
+}
+
+/**
+ * @brief blob_test
+ */
+void
+SqlTable_Test::blob_test()
+{
+    ErrorContainer error;
+    FileTable fileTable(m_db);
+    TEST_EQUAL(fileTable.initTable(error), true);
+    TEST_EQUAL(fileTable.addFile("file0", error), true);
+    TEST_EQUAL(fileTable.getContentSize("file0", error), 0);
+    TEST_EQUAL(fileTable.getContentSize("fail", error), -1);
+
+    // write blob in chunks
+    const uint64_t blobSize = 1000000;
+    uint64_t writePos = 0;
+    bool success = fileTable.writeContent("file0", blobSize, [&](uint8_t* buffer, uint64_t size) {
+        for(uint64_t i = 0; i < size; i++) {
+            buffer[i] = static_cast<uint8_t>((writePos + i) % 251);
+        }
+        writePos += size;
+        return static_cast<long>(size);
+    }, error, 65536);
+    TEST_EQUAL(success, true);
+    TEST_EQUAL(fileTable.getContentSize("file0", error), blobSize);
+
+    // select-requests only contain the size of the blob
+    JsonItem result;
+    TEST_EQUAL(fileTable.getFile(result, "file0", error), true);
+    TEST_EQUAL(result.get("content").getLong(), blobSize);
+
+    // read blob in chunks
+    uint64_t readPos = 0;
+    uint64_t numberOfChunks = 0;
+    bool contentMatch = true;
+    success = fileTable.readContent("file0", [&](const uint8_t* data, uint64_t size) {
+        for(uint64_t i = 0; i < size; i++) {
+            contentMatch &= data[i] == static_cast<uint8_t>((readPos + i) % 251);
+        }
+        readPos += size;
+        numberOfChunks++;
+        return true;
+    }, error, 100000);
+    TEST_EQUAL(success, true);
+    TEST_EQUAL(contentMatch, true);
+    TEST_EQUAL(readPos, blobSize);
+    TEST_EQUAL(numberOfChunks, 10);
+
+    // failing callback rolls back the write
+    success = fileTable.writeContent("file0", 10, [&](uint8_t*, uint64_t) {
+        return -1l;
+    }, error, 4);
+    TEST_EQUAL(success, false);
+    TEST_EQUAL(fileTable.getContentSize("file0", error), blobSize);
+
+    // write within an open transaction of the caller, which is not ended by the write
+    auto fillCallback = [&](uint8_t* buffer, uint64_t size) {
+        std::fill(buffer, buffer + size, 0);
+        return static_cast<long>(size);
+    };
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "BEGIN;", error), true);
+    TEST_EQUAL(fileTable.writeContent("file0", 10, fillCallback, error, 4), true);
+    TEST_EQUAL(fileTable.getContentSize("file0", error), 10);
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "ROLLBACK;", error), true);
+    TEST_EQUAL(fileTable.getContentSize("file0", error), blobSize);
+}
+
+/**
+ * @brief queryPlan_test
+ */
+void
+SqlTable_Test::queryPlan_test()
+{
+    ErrorContainer error;
+
+    // name is not indexed in the user-table, but it is the primary key of the file-table
+    SqlDatabase::QueryPlan plan;
+    TEST_EQUAL(m_table->explainGetUser(plan, error), true);
+    TEST_EQUAL(plan.hasFullScan, true);
+    TEST_EQUAL(plan.statement, "SELECT * FROM USERS WHERE NAME=?");
+    TEST_EQUAL(m_db->explainQuery("SELECT * FROM files WHERE name='file0';", plan, error), true);
+    TEST_EQUAL(plan.hasFullScan, false);
+    TEST_EQUAL(m_db->explainQuery("SELECT * FROM users ORDER BY is_admin;", plan, error), true);
+    TEST_EQUAL(plan.hasTempBTree, true);
+    TEST_EQUAL(m_db->explainQuery("SELECT * FROM fail;", plan, error), false);
+
+    // statements with different values share the same plan
+    m_db->setPlanCheck(SqlDatabase::FAIL_ON_SCAN, 2);
+    JsonItem result;
+    TEST_EQUAL(m_table->getUser(result, m_name1, error), true);
+    TEST_EQUAL(m_db->getQueryPlans().size(), 1);
+#ifdef NDEBUG
+    TEST_EQUAL(m_table->getUser(result, m_name2, error), true);
+#else
+    TEST_EQUAL(m_table->getUser(result, m_name2, error), false);
+#endif
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 6);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 6);
+
+    const std::vector<SqlDatabase::QueryPlan> plans = m_db->getQueryPlans();
+    TEST_EQUAL(plans.size(), 2);
+    if(plans.size() == 2)
+    {
+        TEST_EQUAL(plans.at(0).numberOfCalls, 2);
+        TEST_EQUAL(plans.at(1).numberOfCalls, 2);
+    }
+
+    m_db->setPlanCheck(SqlDatabase::NO_PLAN_CHECK);
+    m_db->clearQueryPlans();
+    TEST_EQUAL(m_db->getQueryPlans().size(), 0);
+}
+
+/**
+ * @brief asyncRequests_test
+ */
+void
+SqlTable_Test::asyncRequests_test()
+{
+    ErrorContainer error;
+    std::atomic<uint64_t> numberOfSuccess(0);
+    auto countSuccess = [&](const bool success, ErrorContainer &) {
+        numberOfSuccess += success;
+    };
+
+    JsonItem testData;
+    testData.insert("name", "async");
+    testData.insert("pw_hash", "secret");
+    testData.insert("is_admin", true);
+
+    // executor is not running
+    TEST_EQUAL(m_table->addUserAsync(testData, countSuccess), false);
+
+    TEST_EQUAL(m_db->startExecutor(2), true);
+    TEST_EQUAL(m_db->startExecutor(2), false);
+    for(uint32_t i = 0; i < 20; i++)
+    {
+        testData.insert("name", "async" + std::to_string(i), true);
+        TEST_EQUAL(m_table->addUserAsync(testData, countSuccess), true);
+    }
+
+    // stopping the executor finishes all queued requests
+    m_db->stopExecutor();
+    TEST_EQUAL(numberOfSuccess, 20);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 26);
+
+    // readers and writer run in parallel, so wait for the read before deleting
+    TEST_EQUAL(m_db->startExecutor(), true);
+    std::promise<std::string> resultName;
+    TEST_EQUAL(m_table->getUserAsync("async5", [&](const bool success,
+                                                   JsonItem &result,
+                                                   ErrorContainer &) {
+        resultName.set_value(success ? result.get("name").getString() : "");
+    }), true);
+    TEST_EQUAL(resultName.get_future().get(), "async5");
+
+    for(uint32_t i = 0; i < 20; i++) {
+        TEST_EQUAL(m_table->deleteUserAsync("async" + std::to_string(i), countSuccess), true);
+    }
+    m_db->stopExecutor();
+
+    TEST_EQUAL(numberOfSuccess, 40);
+    TEST_EQUAL(m_table->getNumberOfUsers(error), 6);
+}
+
+/**
+ * @brief timeToLive_test
+ */
+void
+SqlTable_Test::timeToLive_test()
+{
+    ErrorContainer error;
+    SessionTable sessionTable(m_db);
+    TEST_EQUAL(sessionTable.initTable(error), true);
+
+    // expired rows are hidden from reads before they are deleted
+    const long now = static_cast<long>(time(nullptr));
+    TEST_EQUAL(sessionTable.addSession("valid", error), true);
+    TEST_EQUAL(sessionTable.addSession("expired0", error, now - 10), true);
+    TEST_EQUAL(sessionTable.addSession("expired1", error, now - 10), true);
+    TEST_EQUAL(sessionTable.addSession("expired2", error, now - 10), true);
+    TEST_EQUAL(sessionTable.getNumberOfSessions(error), 1);
+
+    JsonItem result;
+    TEST_EQUAL(sessionTable.getSession(result, "valid", error), true);
+    TEST_EQUAL(result.get("expires_at").getLong() >= now + 3600, true);
+    TEST_EQUAL(sessionTable.getSession(result, "expired0", error), false);
+
+    // delete in batches
+    TEST_EQUAL(sessionTable.deleteExpiredRows(error, 2), 2);
+    TEST_EQUAL(m_table->deleteExpiredRows(error), -1);
+
+    // sweeper deletes the remaining expired rows in the background
+    TEST_EQUAL(sessionTable.startExpirySweeper(10, 2, 1), true);
+    TEST_EQUAL(sessionTable.startExpirySweeper(10, 2, 1), false);
+    TEST_EQUAL(m_table->startExpirySweeper(), false);
+
+    TableItem countResult;
+    for(uint32_t i = 0; i < 100; i++)
+    {
+        countResult.clearTable();
+        m_db->execSqlCommand(&countResult, "SELECT COUNT(*) FROM sessions;", error);
+        if(countResult.getCell(0, 0) == "1") {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    TEST_EQUAL(countResult.getCell(0, 0), "1");
+    sessionTable.stopExpirySweeper();
+}
+
+/**
+ * @brief writeBack_test
+ */
+void
+SqlTable_Test::writeBack_test()
+{
+    ErrorContainer error;
+    TableItem rawResult;
+
+    {
+        CounterTable counterTable(m_db);
+        TEST_EQUAL(counterTable.initTable(error), true);
+        TEST_EQUAL(counterTable.addCounter("loaded", 1, error), true);
+
+        TEST_EQUAL(counterTable.enableWriteBack(error, 60000, 100), true);
+        TEST_EQUAL(counterTable.enableWriteBack(error), false);
+        TEST_EQUAL(m_table->enableWriteBack(error), false);
+
+        // changes are only visible in memory until the flush
+        TEST_EQUAL(counterTable.addCounter("hits", 0, error), true);
+        TEST_EQUAL(counterTable.addCounter("hits", 0, error), false);
+        for(long i = 1; i <= 10; i++) {
+            TEST_EQUAL(counterTable.setCounter("hits", i, error), true);
+        }
+        TEST_EQUAL(counterTable.setCounter("loaded", 2, error), true);
+
+        JsonItem result;
+        TEST_EQUAL(counterTable.getCounter(result, "hits", error), true);
+        TEST_EQUAL(result.get("value").getLong(), 10);
+        TEST_EQUAL(counterTable.getCounter(result, "unknown", error), false);
+
+        m_db->execSqlCommand(&rawResult, "SELECT COUNT(*) FROM counters;", error);
+        TEST_EQUAL(rawResult.getCell(0, 0), "1");
+
+        // all changes are written with one transaction
+        TEST_EQUAL(counterTable.flushWriteBack(error), true);
+        rawResult.clearTable();
+        m_db->execSqlCommand(&rawResult, "SELECT value FROM counters WHERE name='hits';", error);
+        TEST_EQUAL(rawResult.getCell(0, 0), "10");
+
+        // reading all rows flushes before the request
+        TEST_EQUAL(counterTable.deleteCounter("loaded", error), true);
+        TEST_EQUAL(counterTable.getCounter(result, "loaded", error), false);
+        TEST_EQUAL(counterTable.getNumberOfCounters(error), 1);
+
+        // exceeding the number of changed rows triggers the flush in the background
+        for(long i = 0; i < 100; i++) {
+            TEST_EQUAL(counterTable.addCounter("counter" + std::to_string(i), i, error), true);
+        }
+        for(uint32_t i = 0; i < 100; i++)
+        {
+            rawResult.clearTable();
+            m_db->execSqlCommand(&rawResult, "SELECT COUNT(*) FROM counters;", error);
+            if(rawResult.getCell(0, 0) == "101") {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        TEST_EQUAL(rawResult.getCell(0, 0), "101");
+
+        // remaining changes are written, when the table is destroyed
+        TEST_EQUAL(counterTable.setCounter("hits", 42, error), true);
+    }
+
+    // state is loaded again from the database
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    TEST_EQUAL(counterTable.enableWriteBack(error), true);
+
+    JsonItem result;
+    TEST_EQUAL(counterTable.getCounter(result, "hits", error), true);
+    TEST_EQUAL(result.get("value").getLong(), 42);
+    TEST_EQUAL(counterTable.getCounter(result, "counter99", error), true);
+    TEST_EQUAL(result.get("value").getLong(), 99);
+
+    // flush within an open transaction of the caller
+    TEST_EQUAL(counterTable.setCounter("hits", 43, error), true);
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "BEGIN;", error), true);
+    TEST_EQUAL(counterTable.flushWriteBack(error), true);
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "COMMIT;", error), true);
+    rawResult.clearTable();
+    m_db->execSqlCommand(&rawResult, "SELECT value FROM counters WHERE name='hits';", error);
+    TEST_EQUAL(rawResult.getCell(0, 0), "43");
+    TEST_EQUAL(counterTable.setCounter("hits", 42, error), true);
+    TEST_EQUAL(counterTable.disableWriteBack(error), true);
+
+    // changes while the mode is disabled are not lost
+    TEST_EQUAL(counterTable.enableWriteBack(error, 60000), true);
+    std::thread writer([&counterTable] {
+        ErrorContainer writerError;
+        for(long i = 1; i <= 200; i++) {
+            counterTable.setCounter("hits", i, writerError);
+        }
+    });
+    TEST_EQUAL(counterTable.disableWriteBack(error), true);
+    writer.join();
+    rawResult.clearTable();
+    m_db->execSqlCommand(&rawResult, "SELECT value FROM counters WHERE name='hits';", error);
+    TEST_EQUAL(rawResult.getCell(0, 0), "200");
+    TEST_EQUAL(counterTable.setCounter("hits", 42, error), true);
+}
+
+/**
+ * @brief memoryDatabase_test
+ */
+void
+SqlTable_Test::memoryDatabase_test()
+{
+    ErrorContainer error;
+    JsonItem result;
+
+    // private in-memory databases don't share their content
+    SqlDatabase memoryDb;
+    SqlDatabase otherMemoryDb;
+    TEST_EQUAL(memoryDb.initMemoryDatabase(error), true);
+    TEST_EQUAL(otherMemoryDb.initMemoryDatabase(error), true);
+    CounterTable memoryTable(&memoryDb);
+    CounterTable otherMemoryTable(&otherMemoryDb);
+    TEST_EQUAL(memoryTable.initTable(error), true);
+    TEST_EQUAL(otherMemoryTable.initTable(error), true);
+    TEST_EQUAL(memoryTable.addCounter("hits", 1, error), true);
+    TEST_EQUAL(memoryTable.getNumberOfCounters(error), 1);
+    TEST_EQUAL(otherMemoryTable.getNumberOfCounters(error), 0);
+
+    // shared in-memory databases with the same name have the same content
+    SqlDatabase sharedDb;
+    SqlDatabase otherSharedDb;
+    TEST_EQUAL(sharedDb.initMemoryDatabase(error, "sakura_test"), true);
+    TEST_EQUAL(otherSharedDb.initMemoryDatabase(error, "sakura_test"), true);
+    CounterTable sharedTable(&sharedDb);
+    CounterTable otherSharedTable(&otherSharedDb);
+    TEST_EQUAL(sharedTable.initTable(error), true);
+    TEST_EQUAL(sharedTable.addCounter("hits", 1, error), true);
+    TEST_EQUAL(otherSharedTable.getCounter(result, "hits", error), true);
+
+    // temporary database
+    SqlDatabase temporaryDb;
+    TEST_EQUAL(temporaryDb.initTemporaryDatabase(error), true);
+    CounterTable temporaryTable(&temporaryDb);
+    TEST_EQUAL(temporaryTable.initTable(error), true);
+    TEST_EQUAL(temporaryTable.addCounter("hits", 1, error), true);
+    TEST_EQUAL(temporaryTable.getNumberOfCounters(error), 1);
+
+    // load file into memory and write changes back with checkpoints
+    const std::string filePath = "/tmp/testdb_memory.db";
+    std::filesystem::remove(filePath);
+    {
+        SqlDatabase fileDb;
+        TEST_EQUAL(fileDb.initDatabase(filePath, error), true);
+        CounterTable fileTable(&fileDb);
+        TEST_EQUAL(fileTable.initTable(error), true);
+        TEST_EQUAL(fileTable.addCounter("loaded", 1, error), true);
+    }
+
+    SqlDatabase loadedDb;
+    TEST_EQUAL(memoryDb.checkpointToFile(error), false);
+    TEST_EQUAL(loadedDb.loadDatabaseIntoMemory(filePath, error), true);
+    CounterTable loadedTable(&loadedDb);
+    TEST_EQUAL(loadedTable.initTable(error), true);
+    TEST_EQUAL(loadedTable.getCounter(result, "loaded", error), true);
+    TEST_EQUAL(loadedTable.addCounter("memory0", 1, error), true);
+
+    SqlDatabase checkDb;
+    TEST_EQUAL(checkDb.initDatabase(filePath, error), true);
+    CounterTable checkTable(&checkDb);
+    TEST_EQUAL(checkTable.getNumberOfCounters(error), 1);
+    TEST_EQUAL(loadedDb.checkpointToFile(error), true);
+    TEST_EQUAL(checkTable.getNumberOfCounters(error), 2);
+
+    TEST_EQUAL(loadedTable.addCounter("memory1", 1, error), true);
+    TEST_EQUAL(loadedDb.closeDatabase(), true);
+    TEST_EQUAL(checkTable.getNumberOfCounters(error), 3);
+
+    checkDb.closeDatabase();
+    std::filesystem::remove(filePath);
+}
+
+/**
+ * @brief aggregate_test
+ */
+void
+SqlTable_Test::aggregate_test()
+{
+    ErrorContainer error;
+    SqlResult result;
+
+    // group by column
+    TEST_EQUAL(m_table->countUsersByAdmin(result, error), true);
+    TEST_EQUAL(result.getNumberOfColumns(), 3);
+    TEST_EQUAL(result.getColumnName(1), "number_of_users");
+    TEST_EQUAL(result.getColumnName(2), "max_name");
+    TEST_EQUAL(result.getNumberOfRows(), 2);
+    TEST_EQUAL(result.getBool(0, 0), false);
+    TEST_EQUAL(result.getBool(1, 0), true);
+    TEST_EQUAL(result.getInt(0, 1) + result.getInt(1, 1), m_table->getNumberOfUsers(error));
+
+    // aggregates have to fit the type of the column
+    TEST_EQUAL(m_table->aggregateUsers(result, "sum", "name", error), false);
+    TEST_EQUAL(m_table->aggregateUsers(result, "sum", "", error), false);
+    TEST_EQUAL(m_table->aggregateUsers(result, "count", "unknown", error), false);
+    TEST_EQUAL(m_table->aggregateUsers(result, "count", "pw_hash", error), true);
+    TEST_EQUAL(result.getColumnName(0), "count_pw_hash");
+
+    // typed results with conditions
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    TEST_EQUAL(counterTable.getCounterStatistics(result, "", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(result.getColumnName(4), "highest");
+    TEST_EQUAL(result.getInt(0, 0), 101);
+    TEST_EQUAL(result.getType(0, 1), SqlResult::INT_VALUE);
+    TEST_EQUAL(result.getInt(0, 1), 42 + 4950);
+    TEST_EQUAL(result.getType(0, 2), SqlResult::FLOAT_VALUE);
+    TEST_EQUAL(result.getInt(0, 3), 0);
+    TEST_EQUAL(result.getInt(0, 4), 99);
+
+    TEST_EQUAL(counterTable.getCounterStatistics(result, "unknown", error), true);
+    TEST_EQUAL(result.getInt(0, 0), 0);
+    TEST_EQUAL(result.isNull(0, 1), true);
+}
+
+/**
+ * @brief search_test
+ */
+void
+SqlTable_Test::search_test()
+{
+    ErrorContainer error;
+    SqlResult result;
+
+    CounterTable plainTable(m_db);
+    TEST_EQUAL(plainTable.searchCounters(result, "counter", error), false);
+
+    // index is filled with the already existing rows
+    CounterTable counterTable(m_db, true);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    TEST_EQUAL(counterTable.searchCounters(result, "counter9", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 11);
+    TEST_EQUAL(counterTable.searchCounters(result, "COUNTER42", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(result.getString(0, 0), "counter42");
+    TEST_EQUAL(result.getInt(0, 1), 42);
+
+    // pagination
+    TEST_EQUAL(counterTable.searchCounters(result, "counter9", error, 10, 5), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+
+    // short texts and special characters
+    TEST_EQUAL(counterTable.searchCounters(result, "99", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(counterTable.searchCounters(result, "%", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 0);
+    TEST_EQUAL(counterTable.searchCounters(result, "it's \"quoted\"", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 0);
+
+    // index is updated together with the table
+    TEST_EQUAL(counterTable.addCounter("searched", 1, error), true);
+    TEST_EQUAL(counterTable.searchCounters(result, "arch", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(counterTable.setCounter("searched", 2, error), true);
+    TEST_EQUAL(counterTable.searchCounters(result, "arch", error), true);
+    TEST_EQUAL(result.getInt(0, 1), 2);
+    TEST_EQUAL(counterTable.deleteCounter("searched", error), true);
+    TEST_EQUAL(counterTable.searchCounters(result, "arch", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 0);
+
+    // write-back mode updates existing rows without removing them from the index
+    TEST_EQUAL(counterTable.enableWriteBack(error), true);
+    TEST_EQUAL(counterTable.setCounter("counter42", 4242, error), true);
+    TEST_EQUAL(counterTable.searchCounters(result, "counter42", error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(result.getInt(0, 1), 4242);
+    TEST_EQUAL(counterTable.disableWriteBack(error), true);
+}
+
+/**
+ * @brief orderBy_test
+ */
+void
+SqlTable_Test::orderBy_test()
+{
+    ErrorContainer error;
+    SqlResult result;
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+
+    // top-n with descending order
+    TEST_EQUAL(counterTable.listCounters(result, "value", true, error, 0, 3), true);
+    TEST_EQUAL(result.getNumberOfRows(), 3);
+    TEST_EQUAL(result.getString(0, 0), "counter42");
+    TEST_EQUAL(result.getInt(0, 1), 4242);
+    TEST_EQUAL(result.getString(1, 0), "counter99");
+    TEST_EQUAL(result.getString(2, 0), "counter98");
+
+    // pagination with ascending order
+    TEST_EQUAL(counterTable.listCounters(result, "value", false, error, 1, 2), true);
+    TEST_EQUAL(result.getNumberOfRows(), 2);
+    TEST_EQUAL(result.getInt(0, 1), 1);
+    TEST_EQUAL(result.getInt(1, 1), 2);
+    TEST_EQUAL(counterTable.listCounters(result, "name", false, error, 0, 1), true);
+    TEST_EQUAL(result.getString(0, 0), "counter0");
+
+    // sorting uses the index of the column
+    SqlDatabase::QueryPlan plan;
+    TEST_EQUAL(counterTable.explainListCounters(plan, "value", error), true);
+    TEST_EQUAL(plan.hasTempBTree, false);
+
+    // columns to sort have to exist
+    TEST_EQUAL(counterTable.listCounters(result, "unknown", false, error), false);
+    TEST_EQUAL(counterTable.explainListCounters(plan, "unknown", error), false);
+}
+
+/**
+ * @brief parallelReads_test
+ */
+void
+SqlTable_Test::parallelReads_test()
+{
+    ErrorContainer error;
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    const long numberOfCounters = counterTable.getNumberOfCounters(error);
+
+    // reads of the same database see the rows of its open transaction, while reads of other
+    // databases are not blocked by the transaction and only see committed rows
+    SqlDatabase otherDb;
+    TEST_EQUAL(otherDb.initDatabase(m_filePath, error, 2), true);
+    CounterTable otherTable(&otherDb);
+    TEST_EQUAL(m_db->execSqlCommand(nullptr,
+                                    "BEGIN; INSERT INTO counters(name, value) "
+                                    "VALUES ('uncommitted', 1);",
+                                    error), true);
+    SqlResult ownRows;
+    TEST_EQUAL(m_db->execSqlCommand(ownRows,
+                                    "SELECT name FROM counters WHERE name = 'uncommitted';",
+                                    error), true);
+    TEST_EQUAL(ownRows.getNumberOfRows(), 1);
+    TEST_EQUAL(counterTable.getNumberOfCounters(error), numberOfCounters + 1);
+    TEST_EQUAL(otherTable.getNumberOfCounters(error), numberOfCounters);
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "COMMIT;", error), true);
+    TEST_EQUAL(counterTable.getNumberOfCounters(error), numberOfCounters + 1);
+    TEST_EQUAL(otherTable.getNumberOfCounters(error), numberOfCounters + 1);
+
+    // parallel reads from multiple threads
+    std::atomic<uint32_t> numberOfCorrectReads(0);
+    std::vector<std::thread> threads;
+    for(uint32_t i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&] {
+            ErrorContainer threadError;
+            for(uint32_t j = 0; j < 20; j++)
+            {
+                if(counterTable.getNumberOfCounters(threadError) == numberOfCounters + 1) {
+                    numberOfCorrectReads++;
+                }
+            }
+        });
+    }
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+    TEST_EQUAL(numberOfCorrectReads.load(), 160);
+
+    // without readers the single connection sees its own open transaction
+    SqlDatabase singleDb;
+    TEST_EQUAL(singleDb.initDatabase(m_filePath, error, 0), true);
+    CounterTable singleTable(&singleDb);
+    TEST_EQUAL(singleDb.execSqlCommand(nullptr, "BEGIN; DELETE FROM counters;", error), true);
+    TEST_EQUAL(singleTable.getNumberOfCounters(error), 0);
+    TEST_EQUAL(counterTable.getNumberOfCounters(error), numberOfCounters + 1);
+    TEST_EQUAL(singleDb.execSqlCommand(nullptr, "ROLLBACK;", error), true);
+    TEST_EQUAL(counterTable.deleteCounter("uncommitted", error), true);
+}
+
+/**
+ * @brief getMany_test
+ */
+void
+SqlTable_Test::getMany_test()
+{
+    ErrorContainer error;
+    SqlResult result;
+    std::vector<std::string> missingNames;
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+
+    // rows are returned in the order of the keys, also over multiple chunks
+    const std::vector<std::string> names = {"counter42", "counter7", "unknown", "counter0",
+                                            "counter'1", "counter99"};
+    TEST_EQUAL(counterTable.getCounters(result, names, missingNames, error, 2), true);
+    TEST_EQUAL(result.getNumberOfRows(), 4);
+    TEST_EQUAL(result.getString(0, 0), "counter42");
+    TEST_EQUAL(result.getInt(0, 1), 4242);
+    TEST_EQUAL(result.getString(1, 0), "counter7");
+    TEST_EQUAL(result.getInt(1, 1), 7);
+    TEST_EQUAL(result.getString(2, 0), "counter0");
+    TEST_EQUAL(result.getString(3, 0), "counter99");
+    TEST_EQUAL(missingNames.size(), 2);
+    TEST_EQUAL(missingNames.at(0), "unknown");
+    TEST_EQUAL(missingNames.at(1), "counter'1");
+
+    // all keys within one statement. The list of missing keys is cleared before each request.
+    TEST_EQUAL(counterTable.getCounters(result, names, missingNames, error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 4);
+    TEST_EQUAL(result.getString(3, 0), "counter99");
+    TEST_EQUAL(missingNames.size(), 2);
+
+    // chunks larger than allowed by sqlite are split
+    std::vector<std::string> manyNames;
+    const uint64_t numberOfNames = m_db->getMaxNumberOfParameters() + 1;
+    for(uint64_t i = 0; i < numberOfNames; i++) {
+        manyNames.push_back("many" + std::to_string(i));
+    }
+    TEST_EQUAL(counterTable.getCounters(result, manyNames, missingNames, error, 0xFFFFFFFF), true);
+    TEST_EQUAL(result.getNumberOfRows(), 0);
+    TEST_EQUAL(missingNames.size(), numberOfNames);
+
+    // empty key-list
+    TEST_EQUAL(counterTable.getCounters(result, {}, missingNames, error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 0);
+    TEST_EQUAL(missingNames.size(), 0);
+}
+
+/**
+ * @brief join_test
+ */
+void
+SqlTable_Test::join_test()
+{
+    ErrorContainer error;
+    SqlResult result;
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    TEST_EQUAL(counterTable.addCounter("joined", 11, error), true);
+    TEST_EQUAL(counterTable.addCounter("unjoined", 22, error), true);
+
+    JsonItem user;
+    user.insert("name", "joined");
+    user.insert("pw_hash", "secret");
+    user.insert("is_admin", true);
+    TEST_EQUAL(m_table->addUser(user, error), true);
+
+    // only rows with matching row in the other table. Hidden columns are not in the result.
+    TEST_EQUAL(counterTable.getCountersWithUsers(result, m_table, "", false, error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(result.getNumberOfColumns(), 4);
+    TEST_EQUAL(result.getString(0, 0), "joined");
+    TEST_EQUAL(result.getInt(0, 1), 11);
+    TEST_EQUAL(result.getColumnName(2), "users_name");
+    TEST_EQUAL(result.getString(0, 2), "joined");
+    TEST_EQUAL(result.getColumnName(3), "users_is_admin");
+    TEST_EQUAL(result.getBool(0, 3), true);
+
+    // keep rows without matching row
+    TEST_EQUAL(counterTable.getCountersWithUsers(result, m_table, "unjoined", true, error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 1);
+    TEST_EQUAL(result.getInt(0, 1), 22);
+    TEST_EQUAL(result.isNull(0, 2), true);
+    TEST_EQUAL(counterTable.getCountersWithUsers(result, m_table, "unjoined", false, error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 0);
+
+    // selected columns
+    const std::vector<std::string> userColumns = {"pw_hash"};
+    TEST_EQUAL(counterTable.getCountersWithUsers(result,
+                                                 m_table,
+                                                 "joined",
+                                                 false,
+                                                 error,
+                                                 userColumns), true);
+    TEST_EQUAL(result.getNumberOfColumns(), 3);
+    TEST_EQUAL(result.getString(0, 2), "secret");
+
+    // invalid joins
+    const std::vector<std::string> unknownColumns = {"unknown"};
+    TEST_EQUAL(counterTable.getCountersWithUsers(result,
+                                                 m_table,
+                                                 "",
+                                                 false,
+                                                 error,
+                                                 unknownColumns), false);
+    TEST_EQUAL(counterTable.getCountersWithUsers(result, &counterTable, "", false, error), false);
+    SqlDatabase otherDb;
+    TEST_EQUAL(otherDb.initMemoryDatabase(error), true);
+    TestTable otherTable(&otherDb);
+    TEST_EQUAL(counterTable.getCountersWithUsers(result, &otherTable, "", false, error), false);
+
+    TEST_EQUAL(m_table->deleteUser("joined", error), true);
+    TEST_EQUAL(counterTable.deleteCounter("joined", error), true);
+    TEST_EQUAL(counterTable.deleteCounter("unjoined", error), true);
+}
+
+/**
+ * @brief maintenance_test
+ */
+void
+SqlTable_Test::maintenance_test()
+{
+    ErrorContainer error;
+    const std::string filePath = "/tmp/testdb_maintenance.db";
+    std::filesystem::remove(filePath);
+
+    // the incremental vacuum is only enabled, when requested
+    SqlDatabase::MaintenanceStats stats;
+    SqlDatabase defaultDb;
+    TEST_EQUAL(defaultDb.initDatabase(filePath, error), true);
+    TEST_EQUAL(defaultDb.getMaintenanceStats(stats, error), true);
+    TEST_EQUAL(stats.incrementalVacuum, false);
+    defaultDb.closeDatabase();
+    std::filesystem::remove(filePath);
+
+    SqlDatabase db;
+    TEST_EQUAL(db.initDatabase(filePath, error, 4, true), true);
+    CounterTable counterTable(&db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    for(uint32_t i = 0; i < 2000; i++) {
+        counterTable.addCounter("counter" + std::to_string(i) + std::string(200, 'x'), i, error);
+    }
+    for(uint32_t i = 0; i < 2000; i++) {
+        counterTable.deleteCounter("counter" + std::to_string(i) + std::string(200, 'x'), error);
+    }
+
+    // deleted rows leave free pages within the file
+    TEST_EQUAL(db.getMaintenanceStats(stats, error), true);
+    TEST_EQUAL(stats.incrementalVacuum, true);
+    TEST_EQUAL(stats.freelistCount > 0, true);
+    TEST_EQUAL(stats.fragmentation > 0.5, true);
+    TEST_EQUAL(stats.numberOfRuns, 0);
+
+    // one maintenance-run gives the free pages back
+    TEST_EQUAL(db.runMaintenance(error, 10000), true);
+    TEST_EQUAL(db.getMaintenanceStats(stats, error), true);
+    TEST_EQUAL(stats.freelistCount, 0);
+    TEST_EQUAL(stats.fragmentation, 0.0);
+    TEST_EQUAL(stats.vacuumedPages > 0, true);
+    TEST_EQUAL(stats.numberOfRuns, 1);
+    TEST_EQUAL(stats.walPages >= 0, true);
+
+    // background-maintenance
+    TEST_EQUAL(db.startMaintenance(10, 10), true);
+    TEST_EQUAL(db.startMaintenance(10, 10), false);
+    for(uint32_t i = 0; i < 200 && stats.numberOfRuns < 3; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        db.getMaintenanceStats(stats, error);
+    }
+    TEST_EQUAL(stats.numberOfRuns >= 3, true);
+    db.stopMaintenance();
+
+    TEST_EQUAL(db.closeDatabase(), true);
+    TEST_EQUAL(db.runMaintenance(error), false);
+    std::filesystem::remove(filePath);
+    std::filesystem::remove(filePath + "-wal");
+    std::filesystem::remove(filePath + "-shm");
+}
+
+/**
+ * @brief readReplica_test
+ */
+void
+SqlTable_Test::readReplica_test()
+{
+    ErrorContainer error;
+    JsonItem result;
+    const std::string snapshotDir = "/tmp/testdb_snapshots";
+    const std::string replicaPath = "/tmp/testdb_replica.db";
+    std::filesystem::remove_all(snapshotDir);
+    std::filesystem::remove(replicaPath);
+
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    TEST_EQUAL(m_db->publishSnapshot(snapshotDir, error), true);
+
+    SqlDatabase replica;
+    TEST_EQUAL(replica.initReplica(snapshotDir, replicaPath, error, 0), true);
+    TEST_EQUAL(replica.getReplicaStaleness() >= 0, true);
+    TEST_EQUAL(m_db->getReplicaStaleness(), -1);
+    TEST_EQUAL(m_db->refreshReplica(error), false);
+
+    // reads are served by the replica, which doesn't know the new row yet
+    counterTable.setReadReplica(&replica, 60000);
+    TEST_EQUAL(counterTable.addCounter("replicated", 1, error), true);
+    TEST_EQUAL(counterTable.getCounter(result, "replicated", error), false);
+
+    // new snapshot makes the row visible
+    TEST_EQUAL(m_db->publishSnapshot(snapshotDir, error), true);
+    TEST_EQUAL(replica.refreshReplica(error), true);
+    TEST_EQUAL(counterTable.getCounter(result, "replicated", error), true);
+
+    // changes of the schema and changes of other connections are also published
+    SqlResult tables;
+    const std::string tableRequest = "SELECT name FROM sqlite_master "
+                                     "WHERE name = 'replicated_schema';";
+    TEST_EQUAL(m_db->execSqlCommand(nullptr, "CREATE TABLE replicated_schema (id int);", error),
+               true);
+    TEST_EQUAL(m_db->publishSnapshot(snapshotDir, error), true);
+    TEST_EQUAL(replica.refreshReplica(error), true);
+    TEST_EQUAL(replica.execSqlCommand(tables, tableRequest, error), true);
+    TEST_EQUAL(tables.getNumberOfRows(), 1);
+    SqlDatabase otherDb;
+    TEST_EQUAL(otherDb.initDatabase(m_filePath, error), true);
+    TEST_EQUAL(otherDb.execSqlCommand(nullptr, "DROP TABLE replicated_schema;", error), true);
+    TEST_EQUAL(m_db->publishSnapshot(snapshotDir, error), true);
+    TEST_EQUAL(replica.refreshReplica(error), true);
+    tables.clear();
+    TEST_EQUAL(replica.execSqlCommand(tables, tableRequest, error), true);
+    TEST_EQUAL(tables.getNumberOfRows(), 0);
+
+    // only one database can publish into a directory
+    TEST_EQUAL(otherDb.publishSnapshot(snapshotDir, error), false);
+    TEST_EQUAL(otherDb.closeDatabase(), true);
+
+    // old snapshots are sorted by the numbers within their names
+    const std::string laterSnapshot = snapshotDir + "/snapshot-99999999999999-1-";
+    std::ofstream(laterSnapshot + "9.db").close();
+    std::ofstream(laterSnapshot + "10.db").close();
+    TEST_EQUAL(counterTable.addCounter("sorted", 4, error), true);
+    TEST_EQUAL(m_db->publishSnapshot(snapshotDir, error), true);
+    TEST_EQUAL(std::filesystem::exists(laterSnapshot + "9.db"), false);
+    TEST_EQUAL(std::filesystem::exists(laterSnapshot + "10.db"), true);
+    std::filesystem::remove(laterSnapshot + "10.db");
+
+    // replica, which is too old, is not used
+    TEST_EQUAL(counterTable.addCounter("fresh", 2, error), true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    counterTable.setReadReplica(&replica, 10);
+    TEST_EQUAL(counterTable.getCounter(result, "fresh", error), true);
+
+    // background-publishing and -refreshing
+    counterTable.setReadReplica(&replica, 60000);
+    TEST_EQUAL(m_db->startPublishing(snapshotDir, 10), true);
+    SqlDatabase backgroundReplica;
+    TEST_EQUAL(backgroundReplica.initReplica(snapshotDir, replicaPath + "2", error, 10), true);
+    CounterTable backgroundTable(m_db);
+    backgroundTable.setReadReplica(&backgroundReplica, 60000);
+    TEST_EQUAL(counterTable.addCounter("background", 3, error), true);
+    bool found = false;
+    for(uint32_t i = 0; i < 200 && found == false; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        found = backgroundTable.getCounter(result, "background", error);
+    }
+    TEST_EQUAL(found, true);
+    m_db->stopReplication();
+    backgroundReplica.stopReplication();
+
+    // only the current and the previous snapshot are kept
+    uint32_t numberOfSnapshots = 0;
+    for(const auto &entry : std::filesystem::directory_iterator(snapshotDir)) {
+        numberOfSnapshots += entry.path().extension() == ".db";
+    }
+    TEST_EQUAL(numberOfSnapshots <= 2, true);
+
+    counterTable.setReadReplica(nullptr);
+    TEST_EQUAL(counterTable.deleteCounter("replicated", error), true);
+    TEST_EQUAL(counterTable.deleteCounter("fresh", error), true);
+    TEST_EQUAL(counterTable.deleteCounter("background", error), true);
+    TEST_EQUAL(replica.closeDatabase(), true);
+    TEST_EQUAL(backgroundReplica.closeDatabase(), true);
+    std::filesystem::remove_all(snapshotDir);
+    for(const std::string &path : {replicaPath, replicaPath + "2"})
+    {
+        std::filesystem::remove(path);
+        std::filesystem::remove(path + "-wal");
+        std::filesystem::remove(path + "-shm");
+    }
+}
+
+/**
+ * @brief compression_test
+ */
+void
+SqlTable_Test::compression_test()
+{
+    ErrorContainer error;
+    JsonItem result;
+    TableItem rawResult;
+
+    DocumentTable invalidTable(m_db, true);
+    TEST_EQUAL(invalidTable.initTable(error), false);
+
+    DocumentTable documentTable(m_db);
+    TEST_EQUAL(documentTable.initTable(error), true);
+
+    std::string content = "";
+    for(uint32_t i = 0; i < 200; i++) {
+        content.append("the quick brown fox jumps over the lazy dog. ");
+    }
+
+    // long values are stored compressed and decompressed while reading
+    TEST_EQUAL(documentTable.addDocument("long", content, error), true);
+    TEST_EQUAL(documentTable.getDocument(result, "long", error), true);
+    TEST_EQUAL(result.get("content").getString(), content);
+    m_db->execSqlCommand(&rawResult,
+                         "SELECT typeof(content), length(content) FROM documents "
+                         "WHERE name='long';",
+                         error);
+    TEST_EQUAL(rawResult.getCell(0, 0), "blob");
+    TEST_EQUAL(std::stoul(rawResult.getCell(1, 0)) < content.size(), true);
+
+    // short values are stored as they are
+    TEST_EQUAL(documentTable.addDocument("short", "hello", error), true);
+    TEST_EQUAL(documentTable.getDocument(result, "short", error), true);
+    TEST_EQUAL(result.get("content").getString(), "hello");
+    rawResult.clearTable();
+    m_db->execSqlCommand(&rawResult,
+                         "SELECT typeof(content) FROM documents WHERE name='short';",
+                         error);
+    TEST_EQUAL(rawResult.getCell(0, 0), "text");
+
+    // updates are compressed too
+    content.append("end");
+    TEST_EQUAL(documentTable.setDocument("short", content, error), true);
+    TEST_EQUAL(documentTable.getDocument(result, "short", error), true);
+    TEST_EQUAL(result.get("content").getString(), content);
+
+    // compressed values can not be compared, sorted or aggregated
+    SqlResult documents;
+    TEST_EQUAL(documentTable.findDocuments(documents, content, error), false);
+    TEST_EQUAL(documentTable.listDocuments(documents, "content", error), false);
+    TEST_EQUAL(documentTable.listDocuments(documents, "name", error), true);
+    TEST_EQUAL(documents.getNumberOfRows(), 2);
+    TEST_EQUAL(documentTable.getMaxContent(documents, error), false);
+}
+
+/**
+ * @brief versionColumn_test
+ */
+void
+SqlTable_Test::versionColumn_test()
+{
+    ErrorContainer error;
+    JsonItem result;
+
+    AccountTable invalidTable(m_db, true);
+    TEST_EQUAL(invalidTable.initTable(error), false);
+
+    AccountTable accountTable(m_db);
+    TEST_EQUAL(accountTable.initTable(error), true);
+    TEST_EQUAL(accountTable.enableWriteBack(error), false);
+
+    // new rows start with version 1 and each update increments the version
+    TEST_EQUAL(accountTable.addAccount("alice", 10, error), true);
+    TEST_EQUAL(accountTable.getAccount(result, "alice", error), true);
+    TEST_EQUAL(result.get("version").getLong(), 1);
+    TEST_EQUAL(accountTable.setBalance("alice", 20, error), true);
+    TEST_EQUAL(accountTable.getAccount(result, "alice", error), true);
+    TEST_EQUAL(result.get("version").getLong(), 2);
+
+    // conditional update only with the current version
+    TEST_EQUAL(accountTable.setBalanceIfVersion("alice", 30, 2, error), 3);
+    TEST_EQUAL(accountTable.setBalanceIfVersion("alice", 40, 2, error), 0);
+    TEST_EQUAL(accountTable.setBalanceIfVersion("unknown", 40, 1, error), 0);
+    TEST_EQUAL(accountTable.getAccount(result, "alice", error), true);
+    TEST_EQUAL(result.get("balance").getLong(), 30);
+    TEST_EQUAL(result.get("version").getLong(), 3);
+
+    // parallel read-modify-write without lock doesn't lose updates
+    const uint32_t numberOfThreads = 4;
+    const uint32_t numberOfIncrements = 25;
+    TEST_EQUAL(accountTable.addAccount("shared", 0, error), true);
+    std::vector<std::thread> threads;
+    for(uint32_t t = 0; t < numberOfThreads; t++)
+    {
+        threads.emplace_back([&accountTable, numberOfIncrements]() {
+            ErrorContainer threadError;
+            for(uint32_t i = 0; i < numberOfIncrements; i++)
+            {
+                while(true)
+                {
+                    JsonItem account;
+                    if(accountTable.getAccount(account, "shared", threadError) == false) {
+                        return;
+                    }
+                    const long balance = account.get("balance").getLong();
+                    const long version = account.get("version").getLong();
+                    const long newVersion = accountTable.setBalanceIfVersion("shared",
+                                                                             balance + 1,
+                                                                             version,
+                                                                             threadError);
+                    if(newVersion != 0) {
+                        break;
+                    }
+                }
+            }
+        });
+    }
+    for(std::thread &thread : threads) {
+        thread.join();
+    }
+
+    TEST_EQUAL(accountTable.getAccount(result, "shared", error), true);
+    TEST_EQUAL(result.get("balance").getLong(), numberOfThreads * numberOfIncrements);
+    TEST_EQUAL(result.get("version").getLong(), numberOfThreads * numberOfIncrements + 1);
+}
+
+/**
+ * @brief trace-hook, which collects all finished spans
+ */
+class SpanCollector
+        : public TraceHook
+{
+public:
+    std::mutex lock;
+    uint64_t numberOfStarts = 0;
+    std::vector<TraceSpan> spans;
+
+    void spanStarted(const TraceSpan &)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        numberOfStarts++;
+    }
+
+    void spanFinished(const TraceSpan &span)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        spans.push_back(span);
+    }
+};
+
+/**
+ * @brief tracing_test
+ */
+void
+SqlTable_Test::tracing_test()
+{
+    ErrorContainer error;
+    JsonItem result;
+
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+
+    SpanCollector collector;
+    m_db->setTraceHook(&collector);
+    TEST_EQUAL(counterTable.addCounter("traced", 42, error), true);
+    TEST_EQUAL(counterTable.getCounter(result, "traced", error), true);
+    m_db->setTraceHook(nullptr);
+    TEST_EQUAL(counterTable.deleteCounter("traced", error), true);
+
+    // query-spans are finished before their operation-span
+    TEST_EQUAL(collector.numberOfStarts, collector.spans.size());
+    TEST_EQUAL(collector.spans.size(), 4);
+    if(collector.spans.size() == 4)
+    {
+        const TraceSpan &insertQuery = collector.spans.at(0);
+        TEST_EQUAL(insertQuery.type, TraceSpan::QUERY_SPAN);
+        TEST_EQUAL(insertQuery.tableName, "counters");
+        TEST_EQUAL(insertQuery.operation, "execSqlCommand");
+        TEST_EQUAL(insertQuery.statement.find("traced"), std::string::npos);
+        TEST_EQUAL(insertQuery.statement.find("INSERT INTO COUNTERS"), 0);
+        TEST_EQUAL(insertQuery.rowsAffected, 1);
+        TEST_EQUAL(insertQuery.success, true);
+
+        const TraceSpan &insertOperation = collector.spans.at(1);
+        TEST_EQUAL(insertOperation.type, TraceSpan::OPERATION_SPAN);
+        TEST_EQUAL(insertOperation.operation, "insertToDb");
+        TEST_EQUAL(insertOperation.rowsAffected, 1);
+        TEST_EQUAL(insertOperation.duration >= insertQuery.duration, true);
+        TEST_EQUAL(insertOperation.threadId, insertQuery.threadId);
+
+        const TraceSpan &getOperation = collector.spans.at(3);
+        TEST_EQUAL(getOperation.operation, "getFromDb");
+        TEST_EQUAL(getOperation.tableName, "counters");
+        TEST_EQUAL(getOperation.rowsReturned, 1);
+        TEST_EQUAL(getOperation.rowsAffected, 0);
+        TEST_EQUAL(getOperation.executeDuration + getOperation.lockWaitDuration,
+                   getOperation.duration);
+    }
+
+    // write a trace-file for chrome
+    const std::string tracePath = "/tmp/testdb_trace.json";
+    ChromeTraceWriter writer;
+    TEST_EQUAL(writer.openFile(tracePath, error), true);
+    TEST_EQUAL(writer.openFile(tracePath, error), false);
+    m_db->setTraceHook(&writer);
+    TEST_EQUAL(counterTable.addCounter("traced", 42, error), true);
+    TEST_EQUAL(counterTable.getCounter(result, "traced", error), true);
+    TEST_EQUAL(counterTable.deleteCounter("traced", error), true);
+    m_db->setTraceHook(nullptr);
+    TEST_EQUAL(writer.getNumberOfEvents(), 6);
+    TEST_EQUAL(writer.closeFile(error), true);
+
+    std::ifstream traceFile(tracePath);
+    const std::string content((std::istreambuf_iterator<char>(traceFile)),
+                              std::istreambuf_iterator<char>());
+    TEST_EQUAL(content.substr(0, 2), "[\n");
+    TEST_EQUAL(content.substr(content.size() - 3), "\n]\n");
+    TEST_EQUAL(content.find("\"name\":\"counters.getFromDb\",\"cat\":\"operation\",\"ph\":\"X\"")
+               != std::string::npos,
+               true);
+    std::filesystem::remove(tracePath);
+}
+
+/**
+ * @brief resultLimit_test
+ */
+void
+SqlTable_Test::resultLimit_test()
+{
+    ErrorContainer error;
+    SqlResult result;
+
+    CounterTable counterTable(m_db);
+    TEST_EQUAL(counterTable.initTable(error), true);
+    for(long i = 0; i < 10; i++) {
+        TEST_EQUAL(counterTable.addCounter("limited" + std::to_string(i), i, error), true);
+    }
+    const long numberOfCounters = counterTable.getNumberOfCounters(error);
+
+    // results, which exceed the limit of the table, let requests without token fail
+    SqlDatabase::ResultLimit limit;
+    limit.maxRows = 3;
+    counterTable.setResultLimit(limit);
+    TEST_EQUAL(counterTable.listCounters(result, "name", false, error), false);
+    TEST_EQUAL(counterTable.listCounters(result, "name", false, error, 0, 3), true);
+    TEST_EQUAL(result.getNumberOfRows(), 3);
+
+    // with token the result is returned in multiple parts
+    std::string token = "";
+    long numberOfRows = 0;
+    uint32_t numberOfParts = 0;
+    std::string lastName = "";
+    bool isSorted = true;
+    do
+    {
+        TEST_EQUAL(counterTable.listCounterPart(result, token, error), true);
+        TEST_EQUAL(result.getNumberOfRows() <= 3, true);
+        for(uint64_t row = 0; row < result.getNumberOfRows(); row++)
+        {
+            const std::string name(result.getString(row, 0));
+            isSorted &= lastName < name;
+            lastName = name;
+        }
+        numberOfRows += static_cast<long>(result.getNumberOfRows());
+        numberOfParts++;
+    }
+    while(token != "" && numberOfParts < 100);
+    TEST_EQUAL(numberOfRows, numberOfCounters);
+    TEST_EQUAL(isSorted, true);
+    TEST_EQUAL(numberOfParts, (numberOfCounters + 2) / 3);
+
+    // rows, which are deleted or added before the position of the next part, don't let the
+    // following parts skip or repeat rows
+    token = "";
+    TEST_EQUAL(counterTable.listCounterPart(result, token, error), true);
+    const std::string firstName(result.getString(0, 0));
+    TEST_EQUAL(counterTable.deleteCounter(firstName, error), true);
+    TEST_EQUAL(counterTable.addCounter(" before", 1, error), true);
+    std::set<std::string> names;
+    numberOfRows = static_cast<long>(result.getNumberOfRows());
+    for(uint64_t row = 0; row < result.getNumberOfRows(); row++) {
+        names.insert(std::string(result.getString(row, 0)));
+    }
+    while(token != "")
+    {
+        TEST_EQUAL(counterTable.listCounterPart(result, token, error), true);
+        for(uint64_t row = 0; row < result.getNumberOfRows(); row++) {
+            names.insert(std::string(result.getString(row, 0)));
+        }
+        numberOfRows += static_cast<long>(result.getNumberOfRows());
+    }
+    TEST_EQUAL(numberOfRows, numberOfCounters);
+    TEST_EQUAL(static_cast<long>(names.size()), numberOfCounters);
+    TEST_EQUAL(counterTable.deleteCounter(" before", error), true);
+    TEST_EQUAL(counterTable.addCounter(firstName, 0, error), true);
+
+    // rows with the same value in a descending order are continued by their rowid
+    for(long i = 0; i < 5; i++) {
+        TEST_EQUAL(counterTable.addCounter("limitedSame" + std::to_string(i), 5, error), true);
+    }
+    token = "";
+    names.clear();
+    numberOfRows = 0;
+    int64_t lastValue = std::numeric_limits<int64_t>::max();
+    isSorted = true;
+    do
+    {
+        TEST_EQUAL(counterTable.listCounterPart(result, token, error, "value", true), true);
+        for(uint64_t row = 0; row < result.getNumberOfRows(); row++)
+        {
+            names.insert(std::string(result.getString(row, 0)));
+            isSorted &= result.getInt(row, 1) <= lastValue;
+            lastValue = result.getInt(row, 1);
+        }
+        numberOfRows += static_cast<long>(result.getNumberOfRows());
+    }
+    while(token != "");
+    TEST_EQUAL(numberOfRows, numberOfCounters + 5);
+    TEST_EQUAL(static_cast<long>(names.size()), numberOfCounters + 5);
+    TEST_EQUAL(isSorted, true);
+    for(long i = 0; i < 5; i++) {
+        TEST_EQUAL(counterTable.deleteCounter("limitedSame" + std::to_string(i), error), true);
+    }
+
+    // limit of bytes with table-item
+    limit.maxRows = 0;
+    limit.maxBytes = 64;
+    counterTable.setResultLimit(limit);
+    TableItem tableResult;
+    token = "";
+    numberOfRows = 0;
+    numberOfParts = 0;
+    do
+    {
+        tableResult.clearTable();
+        TEST_EQUAL(counterTable.listCounterPart(tableResult, token, error), true);
+        numberOfRows += static_cast<long>(tableResult.getNumberOfRows());
+        numberOfParts++;
+    }
+    while(token != "" && numberOfParts < 100);
+    TEST_EQUAL(numberOfRows, numberOfCounters);
+    TEST_EQUAL(numberOfParts > 1, true);
+
+    // tokens are checked, so they can not inject anything into the query
+    token = "invalid";
+    TEST_EQUAL(counterTable.listCounterPart(result, token, error), false);
+    token = "31";
+    TEST_EQUAL(counterTable.listCounterPart(result, token, error), false);
+    token = "2731273b2044524f50205441424c4520636f756e746572733b.31";
+    TEST_EQUAL(counterTable.listCounterPart(result, token, error), false);
+    token = "276127204f5220276227.31";
+    TEST_EQUAL(counterTable.listCounterPart(result, token, error), false);
+
+    // default-limit of the database is used by tables without own limit
+    counterTable.setResultLimit(SqlDatabase::ResultLimit());
+    limit.maxRows = 2;
+    limit.maxBytes = 0;
+    m_db->setResultLimit(limit);
+    TEST_EQUAL(counterTable.listCounters(result, "name", false, error), false);
+    token = "";
+    TEST_EQUAL(counterTable.listCounterPart(result, token, error), true);
+    TEST_EQUAL(result.getNumberOfRows(), 2);
+    TEST_EQUAL(token.empty(), false);
+    m_db->setResultLimit(SqlDatabase::ResultLimit());
+
+    token = "";
+    TEST_EQUAL(counterTable.listCounterPart(result, token, error), true);
+    TEST_EQUAL(static_cast<long>(result.getNumberOfRows()), numberOfCounters);
+    TEST_EQUAL(token, "");
+
+    for(long i = 0; i < 10; i++) {
+        TEST_EQUAL(counterTable.deleteCounter("limited" + std::to_string(i), error), true);
+    }
+}
+
+/**
+ * @brief write input into a file and import it into the test-table
+ *
+ * @param input input to import
+ * @param isCsv true, if csv-input, else json-lines
+ *
+ * @return result of the import
+ */
+long
+SqlTable_Test::importString(const std::string &input,
+                            const bool isCsv)
+{
+    ErrorContainer error;
+    const std::string importPath = "/tmp/testdb.import";
+
+    int fd = open(importPath.c_str(), O_CREAT | O_TRUNC | O_WRONLY, 0600);
+    if(write(fd, input.c_str(), input.size()) != static_cast<ssize_t>(input.size())) {
+        return -2;
+    }
+    close(fd);
+
+    fd = open(importPath.c_str(), O_RDONLY);
+    const long result = m_table->importUsers(fd, isCsv, error);
+    close(fd);
+    std::filesystem::remove(importPath);
+
+    return result;
+}
+
 /**
  * common usage to delete test-file
  */
@@ -31,9 +31,35 @@ private:
     void create_test();
     void get_test();
     void getAll_test();
+    void getAllResult_test();
+    void exportSnapshot_test();
     void update_test();
     void delete_test();
     void getNumberOfRows_test();
+    void importFromFile_test();
+    void backupDatabase_test();
+    void changeFeed_test();
+    void typedTable_test();
+    void blob_test();
+    void queryPlan_test();
+    void asyncRequests_test();
+    void timeToLive_test();
+    void writeBack_test();
+    void memoryDatabase_test();
+    void aggregate_test();
+    void search_test();
+    void orderBy_test();
+    void parallelReads_test();
+    void getMany_test();
+    void join_test();
+    void maintenance_test();
+    void readReplica_test();
+    void compression_test();
+    void versionColumn_test();
+    void tracing_test();
+    void resultLimit_test();
+
+    long importString(const std::string &input, const bool isCsv);
 };
 
 }
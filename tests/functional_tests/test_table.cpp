@@ -2,6 +2,9 @@
 
 #include <libKitsunemimiSakuraDatabase/sql_table.h>
 #include <libKitsunemimiSakuraDatabase/sql_database.h>
+#include <libKitsunemimiSakuraDatabase/sql_result.h>
+
+#include <libKitsunemimiJson/json_item.h>
 
 namespace Kitsunemimi
 {
@@ -91,6 +94,85 @@ long TestTable::getNumberOfUsers(ErrorContainer &error)
     return getNumberOfRows(error);
 }
 
+/**
+ * @brief explainGetUser
+ */
+bool
+TestTable::explainGetUser(SqlDatabase::QueryPlan &plan,
+                          ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", "user");
+    return explainGetFromDb(conditions, plan, error);
+}
+
+/**
+ * @brief countUsersByAdmin
+ */
+bool
+TestTable::countUsersByAdmin(SqlResult &result,
+                             ErrorContainer &error)
+{
+    const std::vector<RequestCondition> conditions;
+    std::vector<Aggregate> aggregates;
+    aggregates.emplace_back(COUNT_AGGREGATE, "", "number_of_users");
+    aggregates.emplace_back(MAX_AGGREGATE, "name");
+    return aggregateFromDb(result, conditions, {"is_admin"}, aggregates, error);
+}
+
+/**
+ * @brief aggregateUsers
+ */
+bool
+TestTable::aggregateUsers(SqlResult &result,
+                          const std::string &function,
+                          const std::string &colName,
+                          ErrorContainer &error)
+{
+    const std::vector<RequestCondition> conditions;
+    std::vector<Aggregate> aggregates;
+    if(function == "sum") {
+        aggregates.emplace_back(SUM_AGGREGATE, colName);
+    } else {
+        aggregates.emplace_back(COUNT_AGGREGATE, colName);
+    }
+    return aggregateFromDb(result, conditions, {}, aggregates, error);
+}
+
+/**
+ * @brief addUserAsync
+ */
+bool
+TestTable::addUserAsync(const JsonItem &data,
+                        AsyncCallback callback)
+{
+    return insertToDbAsync(data, callback);
+}
+
+/**
+ * @brief getUserAsync
+ */
+bool
+TestTable::getUserAsync(const std::string &userID,
+                        AsyncJsonCallback callback)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", userID);
+    return getFromDbAsync(conditions, callback);
+}
+
+/**
+ * @brief deleteUserAsync
+ */
+bool
+TestTable::deleteUserAsync(const std::string &userID,
+                           AsyncCallback callback)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", userID);
+    return deleteFromDbAsync(conditions, callback);
+}
+
 /**
  * @brief getAllUser
  */
@@ -104,6 +186,19 @@ TestTable::getAllUser(TableItem &resultItem,
     return getAllFromDb(resultItem, error, showHiddenValues, positionOffset, numberOfRows);
 }
 
+/**
+ * @brief getAllUser
+ */
+bool
+TestTable::getAllUser(SqlResult &resultItem,
+                      ErrorContainer &error,
+                      const bool showHiddenValues,
+                      const uint64_t positionOffset,
+                      const uint64_t numberOfRows)
+{
+    return getAllFromDb(resultItem, error, showHiddenValues, positionOffset, numberOfRows);
+}
+
 /**
  * @brief deleteUser
  */
@@ -116,5 +211,567 @@ TestTable::deleteUser(const std::string &userID,
     return deleteFromDb(conditions, error);
 }
 
+/**
+ * @brief exportUsers
+ */
+bool
+TestTable::exportUsers(const std::string &filePath,
+                       ErrorContainer &error,
+                       const uint64_t rowsPerStep)
+{
+    return exportSnapshot(filePath, error, false, rowsPerStep);
+}
+
+
+/**
+ * @brief importUsers
+ */
+long
+TestTable::importUsers(const int fd,
+                       const bool isCsv,
+                       ErrorContainer &error)
+{
+    if(isCsv) {
+        return importFromFile(fd, CSV_IMPORT, error, 2);
+    }
+    return importFromFile(fd, JSON_LINES_IMPORT, error, 2);
+}
+
+
+FileTable::FileTable(Kitsunemimi::Sakura::SqlDatabase* db)
+    : SqlTable(db)
+{
+    m_tableName = "files";
+
+    DbHeaderEntry name;
+    name.name = "name";
+    name.maxLength = 256;
+    name.isPrimary = true;
+    m_tableHeader.push_back(name);
+
+    DbHeaderEntry content;
+    content.name = "content";
+    content.type = BLOB_TYPE;
+    m_tableHeader.push_back(content);
+}
+
+FileTable::~FileTable() {}
+
+/**
+ * @brief addFile
+ */
+bool
+FileTable::addFile(const std::string &name,
+                   ErrorContainer &error)
+{
+    JsonItem data;
+    data.insert("name", name);
+    return insertToDb(data, error);
+}
+
+/**
+ * @brief getFile
+ */
+bool
+FileTable::getFile(JsonItem &resultItem,
+                   const std::string &name,
+                   ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return getFromDb(resultItem, conditions, error);
+}
+
+/**
+ * @brief getContentSize
+ */
+long
+FileTable::getContentSize(const std::string &name,
+                          ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return getBlobSize(conditions, "content", error);
+}
+
+/**
+ * @brief readContent
+ */
+bool
+FileTable::readContent(const std::string &name,
+                       SqlDatabase::BlobReadCallback readCallback,
+                       ErrorContainer &error,
+                       const uint64_t chunkSize)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return readBlob(conditions, "content", readCallback, error, chunkSize);
+}
+
+/**
+ * @brief writeContent
+ */
+bool
+FileTable::writeContent(const std::string &name,
+                        const uint64_t size,
+                        SqlDatabase::BlobWriteCallback writeCallback,
+                        ErrorContainer &error,
+                        const uint64_t chunkSize)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return writeBlob(conditions, "content", size, writeCallback, error, chunkSize);
+}
+
+SessionTable::SessionTable(Kitsunemimi::Sakura::SqlDatabase* db)
+    : SqlTable(db)
+{
+    m_tableName = "sessions";
+
+    DbHeaderEntry token;
+    token.name = "token";
+    token.maxLength = 64;
+    token.isPrimary = true;
+    m_tableHeader.push_back(token);
+
+    DbHeaderEntry expiresAt;
+    expiresAt.name = "expires_at";
+    expiresAt.type = INT_TYPE;
+    expiresAt.timeToLive = 3600;
+    m_tableHeader.push_back(expiresAt);
+}
+
+SessionTable::~SessionTable() {}
+
+/**
+ * @brief addSession
+ */
+bool
+SessionTable::addSession(const std::string &token,
+                         ErrorContainer &error,
+                         const long expiresAt)
+{
+    JsonItem data;
+    data.insert("token", token);
+    if(expiresAt != 0) {
+        data.insert("expires_at", expiresAt);
+    }
+    return insertToDb(data, error);
+}
+
+/**
+ * @brief getSession
+ */
+bool
+SessionTable::getSession(JsonItem &resultItem,
+                         const std::string &token,
+                         ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("token", token);
+    return getFromDb(resultItem, conditions, error);
+}
+
+/**
+ * @brief getNumberOfSessions
+ */
+long
+SessionTable::getNumberOfSessions(ErrorContainer &error)
+{
+    return getNumberOfRows(error);
+}
+
+DocumentTable::DocumentTable(Kitsunemimi::Sakura::SqlDatabase* db,
+                             const bool compressName)
+    : SqlTable(db)
+{
+    m_tableName = "documents";
+
+    DbHeaderEntry name;
+    name.name = "name";
+    name.maxLength = 64;
+    name.isPrimary = true;
+    name.isCompressed = compressName;
+    m_tableHeader.push_back(name);
+
+    DbHeaderEntry content;
+    content.name = "content";
+    content.isCompressed = true;
+    m_tableHeader.push_back(content);
+}
+
+DocumentTable::~DocumentTable() {}
+
+/**
+ * @brief addDocument
+ */
+bool
+DocumentTable::addDocument(const std::string &name,
+                           const std::string &content,
+                           ErrorContainer &error)
+{
+    JsonItem data;
+    data.insert("name", name);
+    data.insert("content", content);
+    return insertToDb(data, error);
+}
+
+/**
+ * @brief getDocument
+ */
+bool
+DocumentTable::getDocument(JsonItem &resultItem,
+                           const std::string &name,
+                           ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return getFromDb(resultItem, conditions, error);
+}
+
+/**
+ * @brief setDocument
+ */
+bool
+DocumentTable::setDocument(const std::string &name,
+                           const std::string &content,
+                           ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    JsonItem updates;
+    updates.insert("content", content);
+    return updateInDb(conditions, updates, error);
+}
+
+/**
+ * @brief findDocuments
+ */
+bool
+DocumentTable::findDocuments(SqlResult &result,
+                             const std::string &content,
+                             ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("content", content);
+    return getFromDb(result, conditions, error);
+}
+
+/**
+ * @brief listDocuments
+ */
+bool
+DocumentTable::listDocuments(SqlResult &result,
+                             const std::string &orderColumn,
+                             ErrorContainer &error)
+{
+    return getAllFromDb(result, error, false, 0, 0, {OrderBy(orderColumn)});
+}
+
+/**
+ * @brief getMaxContent
+ */
+bool
+DocumentTable::getMaxContent(SqlResult &result,
+                             ErrorContainer &error)
+{
+    return aggregateFromDb(result, {}, {}, {Aggregate(MAX_AGGREGATE, "content")}, error);
+}
+
+AccountTable::AccountTable(Kitsunemimi::Sakura::SqlDatabase* db,
+                           const bool stringVersion)
+    : SqlTable(db)
+{
+    m_tableName = "accounts";
+
+    DbHeaderEntry name;
+    name.name = "name";
+    name.maxLength = 64;
+    name.isPrimary = true;
+    m_tableHeader.push_back(name);
+
+    DbHeaderEntry balance;
+    balance.name = "balance";
+    balance.type = INT_TYPE;
+    m_tableHeader.push_back(balance);
+
+    DbHeaderEntry version;
+    version.name = "version";
+    version.type = stringVersion ? STRING_TYPE : INT_TYPE;
+    version.isVersion = true;
+    m_tableHeader.push_back(version);
+}
+
+AccountTable::~AccountTable() {}
+
+/**
+ * @brief addAccount
+ */
+bool
+AccountTable::addAccount(const std::string &name,
+                         const long balance,
+                         ErrorContainer &error)
+{
+    JsonItem data;
+    data.insert("name", name);
+    data.insert("balance", balance);
+    return insertToDb(data, error);
+}
+
+/**
+ * @brief getAccount
+ */
+bool
+AccountTable::getAccount(JsonItem &resultItem,
+                         const std::string &name,
+                         ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return getFromDb(resultItem, conditions, error);
+}
+
+/**
+ * @brief setBalance
+ */
+bool
+AccountTable::setBalance(const std::string &name,
+                         const long balance,
+                         ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    JsonItem updates;
+    updates.insert("balance", balance);
+    return updateInDb(conditions, updates, error);
+}
+
+/**
+ * @brief setBalanceIfVersion
+ */
+long
+AccountTable::setBalanceIfVersion(const std::string &name,
+                                  const long balance,
+                                  const long expectedVersion,
+                                  ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    JsonItem updates;
+    updates.insert("balance", balance);
+    return updateInDbIfVersion(conditions, updates, expectedVersion, error);
+}
+
+CounterTable::CounterTable(Kitsunemimi::Sakura::SqlDatabase* db,
+                           const bool searchableNames)
+    : SqlTable(db)
+{
+    m_tableName = "counters";
+
+    DbHeaderEntry name;
+    name.name = "name";
+    name.maxLength = 64;
+    name.isPrimary = true;
+    name.isSearchable = searchableNames;
+    m_tableHeader.push_back(name);
+
+    DbHeaderEntry value;
+    value.name = "value";
+    value.type = INT_TYPE;
+    value.isIndexed = true;
+    m_tableHeader.push_back(value);
+}
+
+CounterTable::~CounterTable() {}
+
+/**
+ * @brief addCounter
+ */
+bool
+CounterTable::addCounter(const std::string &name,
+                         const long value,
+                         ErrorContainer &error)
+{
+    JsonItem data;
+    data.insert("name", name);
+    data.insert("value", value);
+    return insertToDb(data, error);
+}
+
+/**
+ * @brief getCounter
+ */
+bool
+CounterTable::getCounter(JsonItem &resultItem,
+                         const std::string &name,
+                         ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return getFromDb(resultItem, conditions, error);
+}
+
+/**
+ * @brief setCounter
+ */
+bool
+CounterTable::setCounter(const std::string &name,
+                         const long value,
+                         ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    JsonItem updates;
+    updates.insert("value", value);
+    return updateInDb(conditions, updates, error);
+}
+
+/**
+ * @brief deleteCounter
+ */
+bool
+CounterTable::deleteCounter(const std::string &name,
+                            ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    conditions.emplace_back("name", name);
+    return deleteFromDb(conditions, error);
+}
+
+/**
+ * @brief getNumberOfCounters
+ */
+long
+CounterTable::getNumberOfCounters(ErrorContainer &error)
+{
+    return getNumberOfRows(error);
+}
+
+/**
+ * @brief getCounterStatistics
+ */
+bool
+CounterTable::getCounterStatistics(SqlResult &result,
+                                   const std::string &name,
+                                   ErrorContainer &error)
+{
+    std::vector<RequestCondition> conditions;
+    if(name.empty() == false) {
+        conditions.emplace_back("name", name);
+    }
+
+    std::vector<Aggregate> aggregates;
+    aggregates.emplace_back(COUNT_AGGREGATE);
+    aggregates.emplace_back(SUM_AGGREGATE, "value");
+    aggregates.emplace_back(AVG_AGGREGATE, "value");
+    aggregates.emplace_back(MIN_AGGREGATE, "value");
+    aggregates.emplace_back(MAX_AGGREGATE, "value", "highest");
+    return aggregateFromDb(result, conditions, {}, aggregates, error);
+}
+
+/**
+ * @brief listCounters
+ */
+bool
+CounterTable::listCounters(SqlResult &result,
+                           const std::string &orderColumn,
+                           const bool descending,
+                           ErrorContainer &error,
+                           const uint64_t positionOffset,
+                           const uint64_t numberOfRows)
+{
+    std::vector<OrderBy> orderBy;
+    orderBy.emplace_back(orderColumn, descending);
+    return getAllFromDb(result, error, false, positionOffset, numberOfRows, orderBy);
+}
+
+/**
+ * @brief explainListCounters
+ */
+bool
+CounterTable::explainListCounters(SqlDatabase::QueryPlan &plan,
+                                  const std::string &orderColumn,
+                                  ErrorContainer &error)
+{
+    const std::vector<RequestCondition> conditions;
+    std::vector<OrderBy> orderBy;
+    orderBy.emplace_back(orderColumn, true);
+    return explainGetFromDb(conditions, plan, error, orderBy);
+}
+
+/**
+ * @brief searchCounters
+ */
+bool
+CounterTable::searchCounters(SqlResult &result,
+                             const std::string &searchText,
+                             ErrorContainer &error,
+                             const uint64_t positionOffset,
+                             const uint64_t numberOfRows)
+{
+    return searchInDb(result, searchText, error, false, positionOffset, numberOfRows);
+}
+
+/**
+ * @brief getCounters
+ */
+bool
+CounterTable::getCounters(SqlResult &result,
+                          const std::vector<std::string> &names,
+                          std::vector<std::string> &missingNames,
+                          ErrorContainer &error,
+                          const uint32_t chunkSize)
+{
+    return getManyFromDb(result, names, missingNames, error, false, chunkSize);
+}
+
+/**
+ * @brief getCountersWithUsers
+ */
+bool
+CounterTable::getCountersWithUsers(SqlResult &result,
+                                   SqlTable* userTable,
+                                   const std::string &name,
+                                   const bool keepUnmatched,
+                                   ErrorContainer &error,
+                                   const std::vector<std::string> &userColumns)
+{
+    std::vector<RequestCondition> conditions;
+    if(name.size() > 0) {
+        conditions.emplace_back("name", name);
+    }
+
+    Join join(userTable, "name", "name");
+    join.otherColumns = userColumns;
+    join.keepUnmatched = keepUnmatched;
+
+    return joinFromDb(result, conditions, join, error);
+}
+
+/**
+ * @brief listCounterPart
+ */
+bool
+CounterTable::listCounterPart(SqlResult &result,
+                              std::string &continuationToken,
+                              ErrorContainer &error,
+                              const std::string &orderColumn,
+                              const bool descending)
+{
+    std::vector<OrderBy> orderBy;
+    orderBy.emplace_back(orderColumn, descending);
+    return getAllFromDb(result, continuationToken, error, false, orderBy);
+}
+
+/**
+ * @brief listCounterPart
+ */
+bool
+CounterTable::listCounterPart(TableItem &result,
+                              std::string &continuationToken,
+                              ErrorContainer &error)
+{
+    return getAllFromDb(result, continuationToken, error);
+}
 }
 }
@@ -2,12 +2,14 @@
 #define TESTTABLE_H
 
 #include <libKitsunemimiSakuraDatabase/sql_table.h>
+#include <libKitsunemimiSakuraDatabase/typed_table.h>
 
 namespace Kitsunemimi
 {
 namespace Sakura
 {
 class SqlDatabase;
+class SqlResult;
 
 class TestTable :
         public Kitsunemimi::Sakura::SqlTable
@@ -31,12 +33,205 @@ public:
                     const bool showHiddenValues = false,
                     const uint64_t positionOffset = 0,
                     const uint64_t numberOfRows = 0);
+    bool getAllUser(SqlResult &resultItem,
+                    ErrorContainer &error,
+                    const bool showHiddenValues = false,
+                    const uint64_t positionOffset = 0,
+                    const uint64_t numberOfRows = 0);
     bool deleteUser(const std::string &userID,
                     ErrorContainer &error);
     bool updateUser(const std::string &userID,
                     const JsonItem &values,
                     ErrorContainer &error);
     long getNumberOfUsers(ErrorContainer &error);
+    bool explainGetUser(SqlDatabase::QueryPlan &plan,
+                        ErrorContainer &error);
+    bool countUsersByAdmin(SqlResult &result,
+                           ErrorContainer &error);
+    bool aggregateUsers(SqlResult &result,
+                        const std::string &function,
+                        const std::string &colName,
+                        ErrorContainer &error);
+    bool addUserAsync(const JsonItem &data,
+                      AsyncCallback callback);
+    bool getUserAsync(const std::string &userID,
+                      AsyncJsonCallback callback);
+    bool deleteUserAsync(const std::string &userID,
+                         AsyncCallback callback);
+    bool exportUsers(const std::string &filePath,
+                     ErrorContainer &error,
+                     const uint64_t rowsPerStep);
+    long importUsers(const int fd,
+                     const bool isCsv,
+                     ErrorContainer &error);
+};
+
+class FileTable :
+        public Kitsunemimi::Sakura::SqlTable
+{
+public:
+    FileTable(Kitsunemimi::Sakura::SqlDatabase* db);
+    ~FileTable();
+
+    bool addFile(const std::string &name,
+                 ErrorContainer &error);
+    bool getFile(JsonItem &resultItem,
+                 const std::string &name,
+                 ErrorContainer &error);
+    long getContentSize(const std::string &name,
+                        ErrorContainer &error);
+    bool readContent(const std::string &name,
+                     SqlDatabase::BlobReadCallback readCallback,
+                     ErrorContainer &error,
+                     const uint64_t chunkSize);
+    bool writeContent(const std::string &name,
+                      const uint64_t size,
+                      SqlDatabase::BlobWriteCallback writeCallback,
+                      ErrorContainer &error,
+                      const uint64_t chunkSize);
+};
+
+class SessionTable :
+        public Kitsunemimi::Sakura::SqlTable
+{
+public:
+    SessionTable(Kitsunemimi::Sakura::SqlDatabase* db);
+    ~SessionTable();
+
+    bool addSession(const std::string &token,
+                    ErrorContainer &error,
+                    const long expiresAt = 0);
+    bool getSession(JsonItem &resultItem,
+                    const std::string &token,
+                    ErrorContainer &error);
+    long getNumberOfSessions(ErrorContainer &error);
+};
+
+class CounterTable :
+        public Kitsunemimi::Sakura::SqlTable
+{
+public:
+    CounterTable(Kitsunemimi::Sakura::SqlDatabase* db,
+                 const bool searchableNames = false);
+    ~CounterTable();
+
+    bool addCounter(const std::string &name,
+                    const long value,
+                    ErrorContainer &error);
+    bool getCounter(JsonItem &resultItem,
+                    const std::string &name,
+                    ErrorContainer &error);
+    bool setCounter(const std::string &name,
+                    const long value,
+                    ErrorContainer &error);
+    bool deleteCounter(const std::string &name,
+                       ErrorContainer &error);
+    long getNumberOfCounters(ErrorContainer &error);
+    bool getCounterStatistics(SqlResult &result,
+                              const std::string &name,
+                              ErrorContainer &error);
+    bool listCounters(SqlResult &result,
+                      const std::string &orderColumn,
+                      const bool descending,
+                      ErrorContainer &error,
+                      const uint64_t positionOffset = 0,
+                      const uint64_t numberOfRows = 0);
+    bool explainListCounters(SqlDatabase::QueryPlan &plan,
+                             const std::string &orderColumn,
+                             ErrorContainer &error);
+    bool searchCounters(SqlResult &result,
+                        const std::string &searchText,
+                        ErrorContainer &error,
+                        const uint64_t positionOffset = 0,
+                        const uint64_t numberOfRows = 0);
+    bool getCounters(SqlResult &result,
+                     const std::vector<std::string> &names,
+                     std::vector<std::string> &missingNames,
+                     ErrorContainer &error,
+                     const uint32_t chunkSize = 500);
+    bool getCountersWithUsers(SqlResult &result,
+                              SqlTable* userTable,
+                              const std::string &name,
+                              const bool keepUnmatched,
+                              ErrorContainer &error,
+                              const std::vector<std::string> &userColumns = {});
+    bool listCounterPart(SqlResult &result,
+                         std::string &continuationToken,
+                         ErrorContainer &error,
+                         const std::string &orderColumn = "name",
+                         const bool descending = false);
+    bool listCounterPart(TableItem &result,
+                         std::string &continuationToken,
+                         ErrorContainer &error);
+};
+
+class DocumentTable :
+        public Kitsunemimi::Sakura::SqlTable
+{
+public:
+    DocumentTable(Kitsunemimi::Sakura::SqlDatabase* db,
+                  const bool compressName = false);
+    ~DocumentTable();
+
+    bool addDocument(const std::string &name,
+                     const std::string &content,
+                     ErrorContainer &error);
+    bool getDocument(JsonItem &resultItem,
+                     const std::string &name,
+                     ErrorContainer &error);
+    bool setDocument(const std::string &name,
+                     const std::string &content,
+                     ErrorContainer &error);
+    bool findDocuments(SqlResult &result,
+                       const std::string &content,
+                       ErrorContainer &error);
+    bool listDocuments(SqlResult &result,
+                       const std::string &orderColumn,
+                       ErrorContainer &error);
+    bool getMaxContent(SqlResult &result,
+                       ErrorContainer &error);
+};
+
+class AccountTable :
+        public Kitsunemimi::Sakura::SqlTable
+{
+public:
+    AccountTable(Kitsunemimi::Sakura::SqlDatabase* db,
+                 const bool stringVersion = false);
+    ~AccountTable();
+
+    bool addAccount(const std::string &name,
+                    const long balance,
+                    ErrorContainer &error);
+    bool getAccount(JsonItem &resultItem,
+                    const std::string &name,
+                    ErrorContainer &error);
+    bool setBalance(const std::string &name,
+                    const long balance,
+                    ErrorContainer &error);
+    long setBalanceIfVersion(const std::string &name,
+                             const long balance,
+                             const long expectedVersion,
+                             ErrorContainer &error);
+};
+
+struct TypedUser
+{
+    std::string name = "";
+    std::string pwHash = "";
+    bool isAdmin = false;
+    long loginCount = 0;
+};
+
+struct TypedUserSchema
+{
+    typedef TypedUser Row;
+    static constexpr const char* tableName = "typed_users";
+    static constexpr auto columns = std::make_tuple(
+                tableColumn("name", &TypedUser::name, 256, PRIMARY_KEY),
+                tableColumn("pw_hash", &TypedUser::pwHash, 64),
+                tableColumn("is_admin", &TypedUser::isAdmin),
+                tableColumn("login_count", &TypedUser::loginCount));
 };
 
 }